@@ -44,6 +44,35 @@ inline void Copy(Map0& dst, const std::string& to,
   dst[to] = SafeFind(src, from);
 }
 
+// Finds out the categories whose signature matches the payload and the
+// categories without signature, the result is in declaration order.
+void dispatch_cates(const Application& app, Message* msg,
+                    std::vector<int>* cates) {
+  *cates = app.unsigned_cates;
+  if (app.dispatch.empty())
+    return;
+
+  // signature is declared by the request payload, the response
+  // payload is used only if the request has not been captured.
+  const std::string* payload = &Slice(msg, SliceType::BIN_REQ).str;
+  if (payload->empty())
+    payload = &Slice(msg, SliceType::BIN_RES).str;
+
+  std::string key;
+  for (size_t i = 0; i < app.dispatch.size(); ++i) {
+    const Dispatch& d = app.dispatch[i];
+    if (payload->size() < d.offset + d.mask.size())
+      continue;
+    key.assign(*payload, d.offset, d.mask.size());
+    for (size_t j = 0; j < key.size(); ++j)
+      key[j] &= d.mask[j];
+    auto iter = d.table.find(key);
+    if (iter != d.table.end())
+      cates->insert(cates->end(), iter->second.begin(), iter->second.end());
+  }
+  std::sort(cates->begin(), cates->end());
+}
+
 } // Anonymous namespace
 
 BinaryParser::BinaryParser(const RuleTree* rt)
@@ -70,10 +99,13 @@ int BinaryParser::Parse(Message* msg, RecordSet* res, Record* attrib) {
   (*attrib)["HOST"] = Slice(msg, SliceType::BIN_DOMAIN).str;
   Copy(*attrib, "PROTOCOL", app->attribute, ApplicationLayer::kProtocol);
 
+  std::vector<int> cates;
+  dispatch_cates(*app, msg, &cates);
+
   int ret = SUCCESS;
   res->clear();
-  for (size_t i = 0; i < app->cates.size(); ++i) {
-    const Category& cate = app->cates[i];
+  for (size_t i = 0; i < cates.size(); ++i) {
+    const Category& cate = app->cates[cates[i]];
     ret = ParseCate(msg, *app, cate, res);
     if (ret != SUCCESS) {
       if (ret == NOT_FOUND_RULE)
@@ -116,67 +148,83 @@ int BinaryParser::ParseCate(Message* msg, const Application& app,
     ++tmp.appear;
 
     // codec
-    std::vector<Codec::Type> codec;
-    Message::Slice* slice;
+    const CodecChain* codec = NULL;
+    size_t reach = std::string::npos;
+    SliceType type;
     switch (rule.data_src) {
     case DataSource::Type::REQ_CONTENT:
-      slice = &Slice(msg, SliceType::BIN_REQ);
-      codec = cate.req_codec;
+      type = SliceType::BIN_REQ;
+      codec = &cate.req_codec;
+      reach = cate.req_reach;
       break;
     case DataSource::Type::RES_CONTENT:
-      slice = &Slice(msg, SliceType::BIN_RES);
-      codec = cate.res_codec;
+      type = SliceType::BIN_RES;
+      codec = &cate.res_codec;
+      reach = cate.res_reach;
       break;
     default: UNREACHABLE_CODE;
     }
 
-    if (slice->str.empty())
+    const std::string& raw = Slice(msg, type).str;
+    if (raw.empty())
       continue;
 
     const std::string& cipher_key =
         SafeFind(app.attribute, BinaryAttributes::kCipherKey);
     if (!cipher_key.empty() &&
-        string_view(slice->str).find(cipher_key) == string_view::npos) {
+        string_view(raw).find(cipher_key) == string_view::npos) {
       return NOT_FOUND_RULE;
     }
 
     const std::string& plain_key =
         SafeFind(app.attribute, BinaryAttributes::kPlaintextFeature);
     if (!plain_key.empty() &&
-        string_view(slice->str).find(plain_key) == string_view::npos) {
+        string_view(raw).find(plain_key) == string_view::npos) {
       return NOT_FOUND_RULE;
     }
 
     const std::string& keyword =
         SafeFind(cate.attribute, BinaryAttributes::kKeyword);
     if (!keyword.empty() &&
-        string_view(slice->str).find(keyword) == string_view::npos) {
+        string_view(raw).find(keyword) == string_view::npos) {
       return NOT_FOUND_RULE;
     }
 
-    if (!slice->codec) {
-      int ret = Codecode(codec, &slice->str);
-      if (ret != SUCCESS)
-        return ret;
-      slice->codec = true;
-    }
+    // The rule decodes its value itself if it's extracted from the raw.
+    int ret = SUCCESS;
+    const std::string* view = rule.late_decode.empty()
+        ? Decode(msg, type, *codec, reach, &ret)
+        : &raw;
+    if (!view)
+      return ret;
 
     // Parse
     switch (rule.type) {
     case RuleLayer::Type::UNKNOWN:
-      ParseUKN(rule, slice->str, &record, &tmp);
+      ParseUKN(rule, *view,
+               rule.params ? IndexParams(msg, *view, rule.data_src) : NULL,
+               &record, &tmp);
       break;
     case RuleLayer::Type::JSON:
-      ParseJSON(rule, slice->str, res, &tmp);
+      ParseJSON(cate, rule, msg, *view, res, &tmp);
       break;
     case RuleLayer::Type::XML:
-      ParseXML(rule, slice->str, res, &tmp);
+      ParseXML(cate, rule, msg, *view, res, &tmp);
       break;
     case RuleLayer::Type::F0:
-      ParseF0(rule, slice->str, res, &tmp);
+      ParseF0(rule, *view, res, &tmp);
       break;
     case RuleLayer::Type::F1:
-      ParseF1(rule, slice->str, res, &tmp);
+      ParseF1(rule, *view, res, &tmp);
+      break;
+    case RuleLayer::Type::PB:
+      ParsePB(rule, *view, res, &tmp);
+      break;
+    case RuleLayer::Type::MSGPACK:
+      ParseMSGPACK(rule, *view, res, &tmp);
+      break;
+    case RuleLayer::Type::THRIFT:
+      ParseTHRIFT(rule, *view, res, &tmp);
       break;
     default: UNREACHABLE_CODE;
     }
@@ -0,0 +1,78 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+// Generates the city code tables of filter.cc from city_code.list, the
+// six-digit codes in order, quoted and separated by commas:
+//
+//   make city_code_gen
+//   ./city_code_gen < city_code.list > city_code.inline.h
+//   ./city_code_gen -provinces < city_code.list > city_province.inline.h
+//
+// city_code.inline.h has a row of the districts of every city and
+// city_province.inline.h the cities of every province, see
+// kCityProvinces of filter.cc.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <utility>
+
+namespace {
+typedef std::pair<uint64_t, uint64_t> BitSet;
+
+void set_bit(BitSet* set, int i) {
+  if (i < 64)
+    set->first |= static_cast<uint64_t>(1) << i;
+  else
+    set->second |= static_cast<uint64_t>(1) << (i - 64);
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+  bool provinces = argc == 2 && strcmp(argv[1], "-provinces") == 0;
+
+  // The districts of the cities by PPCC, ordered.
+  std::map<int, BitSet> cities;
+  int c, code = 0, digits = 0;
+  while ((c = getchar()) != EOF) {
+    if (c >= '0' && c <= '9') {
+      code = code * 10 + (c - '0');
+      ++digits;
+      continue;
+    }
+    if (digits == 6)
+      set_bit(&cities[code / 100], code % 100);
+    else if (digits != 0)
+      fprintf(stderr, "bad code %d\n", code);
+    code = digits = 0;
+  }
+
+  if (!provinces) {
+    for (auto iter = cities.begin(); iter != cities.end(); ++iter) {
+      printf("{ 0x%016llXULL, 0x%016llXULL }, // %04d\n",
+             static_cast<unsigned long long>(iter->second.first),
+             static_cast<unsigned long long>(iter->second.second),
+             iter->first);
+    }
+    return 0;
+  }
+
+  // The rows of a province start after the ones of the provinces before.
+  int row = 0;
+  for (int pp = 0; pp < 100; ++pp) {
+    BitSet set(0, 0);
+    int first_row = 0;
+    for (auto iter = cities.lower_bound(pp * 100);
+         iter != cities.end() && iter->first / 100 == pp; ++iter) {
+      if (set == BitSet(0, 0))
+        first_row = row;
+      set_bit(&set, iter->first % 100);
+      ++row;
+    }
+    printf("{ %3d, { 0x%016llXULL, 0x%016llXULL } }, // %02d\n", first_row,
+           static_cast<unsigned long long>(set.first),
+           static_cast<unsigned long long>(set.second), pp);
+  }
+  return 0;
+}
@@ -0,0 +1,100 @@
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 00
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 01
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 02
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 03
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 04
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 05
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 06
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 07
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 08
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 09
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 10
+{   0, { 0x0000000000000002ULL, 0x0000000000000000ULL } }, // 11
+{   1, { 0x0000000000000002ULL, 0x0000000000000000ULL } }, // 12
+{   2, { 0x0000000000000FFEULL, 0x0000000004000000ULL } }, // 13
+{  14, { 0x0000000000000FFEULL, 0x0000000000000000ULL } }, // 14
+{  25, { 0x00000000224003FEULL, 0x0000000000000000ULL } }, // 15
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 16
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 17
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 18
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 19
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 20
+{  37, { 0x0000000000007FFEULL, 0x0000000000000000ULL } }, // 21
+{  51, { 0x00000000010001FEULL, 0x0000000000000000ULL } }, // 22
+{  60, { 0x0000000008001FFEULL, 0x0000000000000000ULL } }, // 23
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 24
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 25
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 26
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 27
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 28
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 29
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 30
+{  73, { 0x0000000000000002ULL, 0x0000000000000000ULL } }, // 31
+{  74, { 0x0000000000003FFEULL, 0x0000000000000000ULL } }, // 32
+{  87, { 0x0000000000000FFEULL, 0x0000000000000000ULL } }, // 33
+{  98, { 0x000000000007BDFEULL, 0x0000000000000000ULL } }, // 34
+{ 114, { 0x00000000000003FEULL, 0x0000000000000000ULL } }, // 35
+{ 123, { 0x0000000000000FFEULL, 0x0000000000000000ULL } }, // 36
+{ 134, { 0x000000000003FFFEULL, 0x0000000000000000ULL } }, // 37
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 38
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 39
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 40
+{ 151, { 0x000000000003FFFEULL, 0x0000000004000000ULL } }, // 41
+{ 169, { 0x0000000010003FEEULL, 0x0000000004000000ULL } }, // 42
+{ 183, { 0x0000000080003FFEULL, 0x0000000000000000ULL } }, // 43
+{ 197, { 0x00380000001FF3FEULL, 0x0000000000000000ULL } }, // 44
+{ 218, { 0x0000000000007FFEULL, 0x0000000000000000ULL } }, // 45
+{ 232, { 0x000000000000001EULL, 0x0000000004000000ULL } }, // 46
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 47
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 48
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 49
+{ 237, { 0x0000000000000006ULL, 0x0000000000000000ULL } }, // 50
+{ 239, { 0x00000007001FEFFAULL, 0x0000000000000000ULL } }, // 51
+{ 260, { 0x000000000C80007EULL, 0x0000000000000000ULL } }, // 52
+{ 269, { 0x00000006B68003FAULL, 0x0000000000000000ULL } }, // 53
+{ 285, { 0x000000000300003EULL, 0x0000000000000000ULL } }, // 54
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 55
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 56
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 57
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 58
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 59
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 60
+{ 292, { 0x00000000000007FEULL, 0x0000000000000000ULL } }, // 61
+{ 302, { 0x0000000060001FFEULL, 0x0000000000000000ULL } }, // 62
+{ 316, { 0x000000001EC00006ULL, 0x0000000000000000ULL } }, // 63
+{ 324, { 0x000000000000003EULL, 0x0000000000000000ULL } }, // 64
+{ 329, { 0x00000D01F8800036ULL, 0x0000000004000000ULL } }, // 65
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 66
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 67
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 68
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 69
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 70
+{ 344, { 0x0000000000000001ULL, 0x0000000000000000ULL } }, // 71
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 72
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 73
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 74
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 75
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 76
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 77
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 78
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 79
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 80
+{ 345, { 0x0000000000000001ULL, 0x0000000000000000ULL } }, // 81
+{ 346, { 0x0000000000000001ULL, 0x0000000000000000ULL } }, // 82
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 83
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 84
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 85
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 86
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 87
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 88
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 89
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 90
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 91
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 92
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 93
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 94
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 95
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 96
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 97
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 98
+{   0, { 0x0000000000000000ULL, 0x0000000000000000ULL } }, // 99
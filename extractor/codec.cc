@@ -7,14 +7,19 @@
 #define z_const
 #endif
 #include <iconv.h>
+#include <endian.h>
 #include <cassert>
 #include <cstring>
 #include <cstdint>
 #include <stdexcept>
-#include <memory>
+#include <map>
+#include <unordered_map>
 #include <algorithm>
-#include <iterator>
 #include <system_error>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EXTRACTOR_X86 1
+#endif
 
 #include "extractor/trivial.h"
 
@@ -22,51 +27,107 @@ namespace ext {
 int Utf16Decode(const char* s, size_t n, std::string* out);
 
 namespace {
-typedef int (*CodecFunc)(const char*, size_t, std::string*);
+// Deflate can't compress better than 1032:1, an ISIZE beyond that
+// doesn't belong to the stream (multiple members or a broken trailer).
+const size_t kMaxDeflateRatio = 1032;
+const size_t kMinInflateSize = 4 << 10;
+
+// The inflate state of a thread, it's reset rather than reallocated for
+// every stream, zlib keeps the window between resets.
+struct ZStream {
+  z_stream strm;
+  bool inited;
 
-enum CompressFormat {
-  ZLIB,
-  GZIP,
+  ZStream(): inited(false) {
+    memset(&strm, 0, sizeof(strm));
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+  }
+
+  ~ZStream() {
+    if (inited)
+      inflateEnd(&strm);
+  }
 };
 
-int Inflate(CompressFormat fmt, const char* s, size_t n, std::string* out) {
-  static const size_t buf_size = 256 << 10;
-  char buf[buf_size];
-  z_stream strm;
-  memset(&strm, 0, sizeof(strm));
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
+z_stream* acquire_stream(Inflater::Format fmt) {
+  static thread_local ZStream streams[2];
+  ZStream& zs = streams[fmt];
   int wbits = MAX_WBITS;
-  if (fmt == CompressFormat::GZIP)
+  if (fmt == Inflater::GZIP)
     wbits += 16;
-  int ret = inflateInit2(&strm, wbits);
+  int ret = zs.inited ? inflateReset2(&zs.strm, wbits)
+                      : inflateInit2(&zs.strm, wbits);
   if (ret != Z_OK)
-    throw std::runtime_error(strm.msg);
-  strm.next_in = (z_const Bytef*)s;
-  strm.avail_in = n;
-
-  do {
-    strm.next_out = (Bytef*)buf;
-    strm.avail_out = buf_size;
-    ret = inflate(&strm, Z_NO_FLUSH);
-    if (ret == Z_STREAM_ERROR) {
-      throw std::logic_error("stream error");
-    } else if (ret == Z_DATA_ERROR
-        || ret == Z_MEM_ERROR
-        || ret == Z_NEED_DICT) {
-      ret = inflateEnd(&strm);
-      if (ret == Z_STREAM_ERROR)
+    throw std::runtime_error(zs.strm.msg ? zs.strm.msg : "inflate init failed");
+  zs.inited = true;
+  return &zs.strm;
+}
+
+// Guesses the inflated size, the gzip trailer has it modulo 2^32.
+size_t inflate_size_hint(Inflater::Format fmt, const char* s, size_t n) {
+  size_t hint = n * 4;
+  if (fmt == Inflater::GZIP && n >= 18) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(s + n - 4);
+    size_t isize = static_cast<size_t>(p[0])       |
+                   static_cast<size_t>(p[1]) << 8  |
+                   static_cast<size_t>(p[2]) << 16 |
+                   static_cast<size_t>(p[3]) << 24;
+    if (isize > 0 && isize / kMaxDeflateRatio <= n)
+      hint = isize;
+  }
+  return std::max(hint, kMinInflateSize);
+}
+
+class ZlibInflater : public Inflater {
+ public:
+  virtual int Inflate(Format fmt, const char* s, size_t n, size_t limit,
+                      std::string* out) {
+    if (limit == 0) {
+      out->clear();
+      return SUCCESS;
+    }
+    z_stream* strm = acquire_stream(fmt);
+    strm->next_in = (z_const Bytef*)s;
+    strm->avail_in = n;
+
+    // Inflate into out directly, it's doubled when it's exhausted.
+    out->resize(std::min(inflate_size_hint(fmt, s, n), limit));
+    size_t have = 0;
+    int ret = Z_OK;
+    do {
+      if (have == out->size()) {
+        if (have == limit)
+          break;
+        out->resize(std::min(have * 2, limit));
+      }
+      strm->next_out = (Bytef*)&(*out)[have];
+      strm->avail_out = out->size() - have;
+      ret = inflate(strm, Z_NO_FLUSH);
+      have = out->size() - strm->avail_out;
+      if (ret == Z_STREAM_ERROR) {
         throw std::logic_error("stream error");
+      } else if (ret == Z_NEED_DICT) {
+        have = 0;
+        break;
+      }
+      // Z_DATA_ERROR, Z_MEM_ERROR, Z_BUF_ERROR: the stream is corrupted
+      // or truncated, keep what has been inflated before it.
+    } while (ret == Z_OK && (strm->avail_in > 0 || strm->avail_out == 0));
+    out->resize(have);
+    if (have == 0 && ret != Z_STREAM_END)
       return UNCOMPRESS_FAILED;
-    }
-    size_t have = buf_size - strm.avail_out;
-    out->append(buf, have);
-  } while (ret != Z_STREAM_END && ret != Z_OK);
-  ret = inflateEnd(&strm);
-  if (ret == Z_STREAM_ERROR)
-    throw std::logic_error("stream error");
-  return SUCCESS;
+    return SUCCESS;
+  }
+};
+
+ZlibInflater g_zlib_inflater;
+Inflater* g_inflater = &g_zlib_inflater;
+
+// Stage adapter, UTF-16 is decoded at once.
+int UnicodeDecode(const char* s, size_t n, size_t, std::string* out) {
+  return Utf16Decode(s, n, out);
 }
 
 // This array must have signed type.
@@ -74,7 +135,7 @@ const int8_t kBase64Bytes[128] = {
      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,
      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,
      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,
-     -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,  0x3E,  -1,   -1,
+     -1,   -1,   -1,   -1,   -1,   -1,   -1,  0x3E,  -1,  0x3E,  -1,  0x3F,
     0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D,  -1,   -1,
      -1,   -1,   -1,   -1,   -1,  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
     0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12,
@@ -170,73 +231,512 @@ std::string UTF16HexStringToUTF8(const char* s) {
     buf.clear();
   return buf;
 }
+
+// Values of the hex digits, -1 for the others.
+const int8_t kHexValues[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+// Finds the first '%' or '+' in [p, end), returns end if there's none.
+typedef const char* (*UrlScanFunc)(const char* p, const char* end);
+
+const char* url_scan(const char* p, const char* end) {
+  while (p < end && *p != '%' && *p != '+')
+    ++p;
+  return p;
+}
+
+#ifdef EXTRACTOR_X86
+__attribute__((target("sse2")))
+const char* url_scan_sse2(const char* p, const char* end) {
+  const __m128i percent = _mm_set1_epi8('%');
+  const __m128i plus = _mm_set1_epi8('+');
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, percent),
+                                              _mm_cmpeq_epi8(v, plus)));
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+    p += 16;
+  }
+  return url_scan(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* url_scan_avx2(const char* p, const char* end) {
+  const __m256i percent = _mm256_set1_epi8('%');
+  const __m256i plus = _mm256_set1_epi8('+');
+  while (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    unsigned int mask = _mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, percent),
+                        _mm256_cmpeq_epi8(v, plus)));
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+    p += 32;
+  }
+  return url_scan_sse2(p, end);
+}
+#endif
+
+UrlScanFunc resolve_url_scan() {
+#ifdef EXTRACTOR_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return url_scan_avx2;
+  if (__builtin_cpu_supports("sse2"))
+    return url_scan_sse2;
+#endif
+  return url_scan;
+}
+
+// Decodes the leading 16 or 32 bytes blocks of s that consist of base64
+// characters only, at least one byte is left to the scalar decoder which
+// handles the paddings. Returns how many bytes are decoded, and 3/4 of
+// them are written to d, which may be s.
+typedef size_t (*Base64BlockFunc)(const char* s, size_t n, char* d);
+
+size_t base64_block(const char*, size_t, char*) {
+  return 0;
+}
+
+#ifdef EXTRACTOR_X86
+// Maps the characters of both alphabets to 6-bit values by ranges,
+// bit i of `valid' is set if the i-th character is a base64 one.
+__attribute__((target("ssse3")))
+inline __m128i base64_lookup_ssse3(__m128i x, int* valid) {
+#define IN_RANGE(x, lo, hi) \
+  _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(lo - 1)), \
+                _mm_cmplt_epi8(x, _mm_set1_epi8(hi + 1)))
+#define EQ(x, c) _mm_cmpeq_epi8(x, _mm_set1_epi8(c))
+  const __m128i upper = IN_RANGE(x, 'A', 'Z');
+  const __m128i lower = IN_RANGE(x, 'a', 'z');
+  const __m128i digit = IN_RANGE(x, '0', '9');
+  const __m128i plus  = EQ(x, '+');
+  const __m128i minus = EQ(x, '-');
+  const __m128i slash = EQ(x, '/');
+  const __m128i under = EQ(x, '_');
+#undef EQ
+#undef IN_RANGE
+  __m128i mask = _mm_or_si128(_mm_or_si128(upper, lower),
+                              _mm_or_si128(digit, plus));
+  mask = _mm_or_si128(mask, _mm_or_si128(minus, _mm_or_si128(slash, under)));
+  *valid = _mm_movemask_epi8(mask);
+
+  __m128i off = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+  off = _mm_or_si128(off, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+  off = _mm_or_si128(off, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+  off = _mm_or_si128(off, _mm_and_si128(plus,  _mm_set1_epi8(62 - '+')));
+  off = _mm_or_si128(off, _mm_and_si128(minus, _mm_set1_epi8(62 - '-')));
+  off = _mm_or_si128(off, _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+  off = _mm_or_si128(off, _mm_and_si128(under, _mm_set1_epi8(63 - '_')));
+  return _mm_add_epi8(x, off);
+}
+
+// Packs 16 6-bit values to 12 bytes at the low end.
+__attribute__((target("ssse3")))
+inline __m128i base64_pack_ssse3(__m128i v) {
+  // 00aaaaaa 00bbbbbb -> 0000aaaa aabbbbbb
+  v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+  // -> 00000000 aaaaaabb bbbbcccc ccdddddd
+  v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                           14, 13, 12, -1, -1, -1, -1));
+}
+
+__attribute__((target("ssse3")))
+size_t base64_block_ssse3(const char* s, size_t n, char* d) {
+  size_t i = 0;
+  while (n - i > 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+    int valid = 0;
+    __m128i v = base64_lookup_ssse3(x, &valid);
+    if (valid != 0xFFFF)
+      break;
+    // 16 bytes are stored, only the last 4 of them are past the output,
+    // and they're within the block which has been loaded.
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d), base64_pack_ssse3(v));
+    d += 12;
+    i += 16;
+  }
+  return i;
+}
+
+__attribute__((target("avx2")))
+inline __m256i base64_lookup_avx2(__m256i x, unsigned int* valid) {
+#define IN_RANGE(x, lo, hi) \
+  _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8(lo - 1)), \
+                   _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), x))
+#define EQ(x, c) _mm256_cmpeq_epi8(x, _mm256_set1_epi8(c))
+  const __m256i upper = IN_RANGE(x, 'A', 'Z');
+  const __m256i lower = IN_RANGE(x, 'a', 'z');
+  const __m256i digit = IN_RANGE(x, '0', '9');
+  const __m256i plus  = EQ(x, '+');
+  const __m256i minus = EQ(x, '-');
+  const __m256i slash = EQ(x, '/');
+  const __m256i under = EQ(x, '_');
+#undef EQ
+#undef IN_RANGE
+  __m256i mask = _mm256_or_si256(_mm256_or_si256(upper, lower),
+                                 _mm256_or_si256(digit, plus));
+  mask = _mm256_or_si256(mask,
+      _mm256_or_si256(minus, _mm256_or_si256(slash, under)));
+  *valid = _mm256_movemask_epi8(mask);
+
+  __m256i off = _mm256_and_si256(upper, _mm256_set1_epi8(-'A'));
+  off = _mm256_or_si256(off,
+      _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+  off = _mm256_or_si256(off,
+      _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+  off = _mm256_or_si256(off,
+      _mm256_and_si256(plus,  _mm256_set1_epi8(62 - '+')));
+  off = _mm256_or_si256(off,
+      _mm256_and_si256(minus, _mm256_set1_epi8(62 - '-')));
+  off = _mm256_or_si256(off,
+      _mm256_and_si256(slash, _mm256_set1_epi8(63 - '/')));
+  off = _mm256_or_si256(off,
+      _mm256_and_si256(under, _mm256_set1_epi8(63 - '_')));
+  return _mm256_add_epi8(x, off);
+}
+
+__attribute__((target("avx2")))
+size_t base64_block_avx2(const char* s, size_t n, char* d) {
+  const __m256i shuffle = _mm256_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  const __m256i permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+  size_t i = 0;
+  while (n - i > 32) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    unsigned int valid = 0;
+    __m256i v = base64_lookup_avx2(x, &valid);
+    if (valid != 0xFFFFFFFF)
+      break;
+    v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+    v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+    v = _mm256_shuffle_epi8(v, shuffle);
+    v = _mm256_permutevar8x32_epi32(v, permute);
+    // As the SSSE3 one, the 8 bytes past the output are within the block.
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d), v);
+    d += 24;
+    i += 32;
+  }
+  return i + base64_block_ssse3(s + i, n - i, d);
+}
+#endif
+
+Base64BlockFunc resolve_base64_block() {
+#ifdef EXTRACTOR_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return base64_block_avx2;
+  if (__builtin_cpu_supports("ssse3"))
+    return base64_block_ssse3;
+#endif
+  return base64_block;
+}
+
+inline bool is_base64_space(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Two-byte GB18030 sequences mapped to BMP code points, indexed by
+// (lead - 0x81) * 191 + (trail - 0x40), zero if iconv has to decide.
+// The table is generated by gb18030_gen.
+const uint16_t kGb18030Table[126 * 191] = {
+#include "extractor/gb18030.inline.h"
+};
+
+enum Charset {
+  CHARSET_OTHER,
+  CHARSET_GBK,
+  CHARSET_GB18030,
+  CHARSET_UTF16,
+  CHARSET_UTF16LE,
+  CHARSET_UTF16BE,
+};
+
+// Recognizes the charsets that are converted natively, case and
+// separators are ignored as iconv does.
+Charset charset_of(const std::string& name) {
+  char buf[16];
+  size_t n = 0;
+  for (size_t i = 0; i < name.size(); ++i) {
+    char c = name[i];
+    if (c == '-' || c == '_')
+      continue;
+    if (n == sizeof(buf))
+      return CHARSET_OTHER;
+    buf[n++] = (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+  }
+  const std::string key(buf, n);
+  if (key == "GBK")
+    return CHARSET_GBK;
+  if (key == "GB18030")
+    return CHARSET_GB18030;
+  if (key == "UTF16")
+    return CHARSET_UTF16;
+  if (key == "UTF16LE")
+    return CHARSET_UTF16LE;
+  if (key == "UTF16BE")
+    return CHARSET_UTF16BE;
+  return CHARSET_OTHER;
+}
+
+inline char* append_utf8(uint32_t cp, char* d) {
+  if (cp < 0x80) {
+    *d++ = static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    *d++ = static_cast<char>(0xC0 | (cp >> 6));
+    *d++ = static_cast<char>(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    *d++ = static_cast<char>(0xE0 | (cp >> 12));
+    *d++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    *d++ = static_cast<char>(0x80 | (cp & 0x3F));
+  } else {
+    *d++ = static_cast<char>(0xF0 | (cp >> 18));
+    *d++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    *d++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    *d++ = static_cast<char>(0x80 | (cp & 0x3F));
+  }
+  return d;
+}
+
+// Two-byte GB18030 sequences that GBK doesn't have, besides the ones
+// mapped to the private use area, see `gb18030_gen -gbk'.
+inline bool gbk_lacks(unsigned int code) {
+  return code == 0xA2E3 ||
+         (code >= 0xA6D9 && code <= 0xA6DF) ||
+         code == 0xA6EC || code == 0xA6ED || code == 0xA6F3 ||
+         code == 0xA8BC || code == 0xA8BF ||
+         (code >= 0xA989 && code <= 0xA995) ||
+         (code >= 0xFE50 && code <= 0xFEA0);
+}
+
+// Converts the ASCII and the two-byte sequences by the table, returns
+// false if there's anything else (four-byte sequences, unmapped or
+// invalid bytes), the caller falls back to iconv then.
+bool gb_to_utf8(const char* s, size_t n, bool gbk, std::string* out) {
+  out->resize(n * 3 / 2 + 1);
+  char* d = &(*out)[0];
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(s);
+  const unsigned char* end = p + n;
+  while (p < end) {
+    if (*p < 0x80) {
+      *d++ = static_cast<char>(*p++);
+      continue;
+    }
+    if (end - p < 2 || p[0] < 0x81 || p[0] > 0xFE ||
+        p[1] < 0x40 || p[1] > 0xFE) {
+      return false;
+    }
+    uint16_t cp = kGb18030Table[(p[0] - 0x81) * 191 + (p[1] - 0x40)];
+    if (cp == 0)
+      return false;
+    if (gbk && ((cp >= 0xE000 && cp <= 0xF8FF) ||
+                gbk_lacks(p[0] << 8 | p[1]))) {
+      return false;
+    }
+    d = append_utf8(cp, d);
+    p += 2;
+  }
+  out->resize(d - out->data());
+  return true;
+}
+
+// Converts UTF-16 as iconv does, a leading BOM is taken if `bom' is set,
+// otherwise it's a character. Returns false on the odd length and the
+// broken surrogates.
+bool utf16_to_utf8(const char* s, size_t n, bool big_endian, bool bom,
+                   std::string* out) {
+  if (n % 2 != 0)
+    return false;
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(s);
+  const unsigned char* end = p + n;
+  if (bom && n >= 2) {
+    if (p[0] == 0xFF && p[1] == 0xFE) {
+      big_endian = false;
+      p += 2;
+    } else if (p[0] == 0xFE && p[1] == 0xFF) {
+      big_endian = true;
+      p += 2;
+    }
+  }
+  // A unit is 3 bytes at most, a pair of surrogates is 4.
+  out->resize(n / 2 * 3);
+  char* d = &(*out)[0];
+  const int hi = big_endian ? 0 : 1;
+  while (p < end) {
+    uint32_t cp = p[hi] << 8 | p[1 - hi];
+    p += 2;
+    if (cp >= 0xD800 && cp <= 0xDFFF) {
+      if (cp >= 0xDC00 || p == end)
+        return false;
+      uint32_t lo = p[hi] << 8 | p[1 - hi];
+      if (lo < 0xDC00 || lo > 0xDFFF)
+        return false;
+      p += 2;
+      cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+    }
+    d = append_utf8(cp, d);
+  }
+  out->resize(d - out->data());
+  return true;
+}
+
+// The iconv descriptors of a thread, they're opened once for every
+// charset and reset before use.
+class IconvCache {
+ public:
+  ~IconvCache() {
+    for (auto iter = ids_.begin(); iter != ids_.end(); ++iter)
+      iconv_close(iter->second);
+  }
+
+  iconv_t Get(const std::string& from) {
+    auto iter = ids_.find(from);
+    if (iter != ids_.end()) {
+      iconv(iter->second, NULL, NULL, NULL, NULL);
+      return iter->second;
+    }
+    iconv_t id = iconv_open("UTF-8", from.c_str());
+    if (id == iconv_t(-1)) {
+      throw std::system_error(errno,
+          std::system_category(), "iconv_open failed");
+    }
+    ids_[from] = id;
+    return id;
+  }
+
+ private:
+  std::unordered_map<std::string, iconv_t> ids_;
+};
+
+int iconv_to_utf8(const std::string& from, const char* s, size_t n,
+                  std::string* out) {
+  static thread_local IconvCache cache;
+  iconv_t id = cache.Get(from);
+  out->resize(n * 4);
+  size_t olen = out->size();
+  char* ibuf = const_cast<char*>(s);
+  char* obuf = &(*out)[0];
+  if (iconv(id, &ibuf, &n, &obuf, &olen) == size_t(-1))
+    return DECODE_FAILED;
+  out->resize(out->size() - olen);
+  return SUCCESS;
+}
 } // Anonymous namespace
 
-int ZlibUncompress(const char* s, size_t n, std::string* out) {
+size_t g_inflate_limit = 64 << 20;
+
+void SetInflater(Inflater* inflater) {
+  g_inflater = inflater ? inflater : &g_zlib_inflater;
+}
+
+int ZlibUncompress(const char* s, size_t n, size_t limit, std::string* out) {
   assert(s && n > 0 && out);
-  uint16_t value = *reinterpret_cast<const uint16_t*>(s);
-  bool is_zlib = (value & 0x0F00) == 0x0800 && value % 31 == 0;
+  // CMF and FLG, the header is big-endian.
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(s);
+  bool is_zlib = n >= 2 && (p[0] & 0x0F) == 0x08 &&
+                 ((p[0] << 8) | p[1]) % 31 == 0;
   if (!is_zlib)
     return UNCOMPRESS_FAILED;
-  return Inflate(CompressFormat::ZLIB, s, n, out);;
+  return g_inflater->Inflate(Inflater::ZLIB, s, n,
+                             std::min(limit, g_inflate_limit), out);
 }
 
-int GzipUncompress(const char* s, size_t n, std::string* out) {
+int GzipUncompress(const char* s, size_t n, size_t limit, std::string* out) {
   assert(s && n > 0 && out);
-  uint16_t value = *reinterpret_cast<const uint16_t*>(s);
-  bool is_gzip = value == 0x8B1F;
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(s);
+  bool is_gzip = n >= 2 && p[0] == 0x1F && p[1] == 0x8B;
   if (!is_gzip)
     return UNCOMPRESS_FAILED;
-  return Inflate(CompressFormat::GZIP, s, n, out);
+  return g_inflater->Inflate(Inflater::GZIP, s, n,
+                             std::min(limit, g_inflate_limit), out);
 }
 
-int UrlDecode(const char* s, size_t n, std::string* out) {
-  assert(s && n > 0 && out);
-  size_t i = 0;
-  while (i < n) {
-    switch (s[i]) {
-    case '%': {
-      if (i + 2 < n) {
-        if (ascii_isxdigit(s[i + 1]) && ascii_isxdigit(s[i + 2])) {
-          ++i;
-          out->push_back(hex_digit_to_int(s[i]) << 4 |
-                         hex_digit_to_int(s[i + 1]));
-          i += 2;
-        } else {
-          out->push_back(s[i]);
-          out->push_back(s[i + 1]);
-          out->push_back(s[i + 2]);
-          i += 3;
-        }
-        break;
-      }
-    }
-    /* no break, save origin character when it has broken */
-    default:
-      out->push_back(s[i] == '+' ? ' ' : s[i]);
-      ++i;
+// The plain spans between '%' and '+' are found by the vectorized scanner
+// and moved at once, they're not moved at all before the first escape.
+int UrlDecode(char* s, size_t* n) {
+  assert(s && n && *n > 0);
+  static const UrlScanFunc url_scan_func = resolve_url_scan();
+  const char* p = s;
+  const char* end = s + *n;
+  char* d = s;
+  while (p < end) {
+    const char* q = url_scan_func(p, end);
+    if (d != p)
+      memmove(d, p, q - p);
+    d += q - p;
+    p = q;
+    if (p == end)
       break;
+
+    if (*p == '%' && end - p > 2) {
+      int hi = kHexValues[static_cast<unsigned char>(p[1])];
+      int lo = kHexValues[static_cast<unsigned char>(p[2])];
+      if ((hi | lo) >= 0) {
+        *d++ = static_cast<char>(hi << 4 | lo);
+      } else {
+        // save origin characters when it has broken
+        *d++ = p[0];
+        *d++ = p[1];
+        *d++ = p[2];
+      }
+      p += 3;
+    } else {
+      *d++ = *p == '+' ? ' ' : *p;
+      ++p;
     }
   }
+  *n = d - s;
   return SUCCESS;
 }
 
-int Base64Decode(const char* s, size_t n, std::string* out) {
-  assert(s && n > 0 && out);
-  // This decoding procedure will write 3 * ceil(data.size() / 4) bytes to be
-  // output buffer, then truncate if necessary. Therefore we must overestimate
-  // and allocate sufficient amount. Currently max_decoded_size may overestimate
-  // by up to 3 bytes.
-  const size_t max_decoded_size = 3 * (n / 4) + 3;
-  std::unique_ptr<char[]> buffer(new char[max_decoded_size]);
-  char* current = buffer.get();
-  if (!current)
-    throw std::runtime_error("No enough memory");
-
-  const char* b64 = s;
-  const char* end = s + n;
+// The output is never longer than the input and every quad is read
+// before its triple is written, so s can be decoded in place. Both the
+// standard and the URL-safe alphabet are accepted, the white spaces are
+// dropped and the paddings are optional.
+int Base64Decode(char* s, size_t* n) {
+  assert(s && n && *n > 0);
+  static const Base64BlockFunc block_func = resolve_base64_block();
+  char* current = s;
+  char* b64 = s;
+  char* end = s + *n;
   int ret = SUCCESS;
 
+  size_t used = block_func(b64, end - b64, current);
+  b64 += used;
+  current += used / 4 * 3;
+  // The blocks stop at a white space, a padding or an invalid character,
+  // the spaces of the rest are removed at once and it's tried again.
+  char* last = std::remove_if(b64, end, is_base64_space);
+  if (last != end) {
+    end = last;
+    if (b64 == end) {
+      *n = current - s;
+      return SUCCESS;
+    }
+    used = block_func(b64, end - b64, current);
+    b64 += used;
+    current += used / 4 * 3;
+  }
+
   while (end - b64 > 4) {
     ret = DecodeThreeChars(b64, current);
     if (ret != SUCCESS)
@@ -267,183 +767,270 @@ int Base64Decode(const char* s, size_t n, std::string* out) {
                   kBase64UrlSafeChars[0], kBase64UrlSafeChars[0]};
   // Copy tail of the input into the array, then decode.
   memcpy(tail, b64, remain * sizeof(*b64));
-  ret = DecodeThreeChars(tail, current);
+  char triple[3];
+  ret = DecodeThreeChars(tail, triple);
   if (ret != SUCCESS)
     return ret;
   // How many parsed characters are valid.
+  memcpy(current, triple, remain - 1);
   current += remain - 1;
 
-  out->assign(buffer.get(), current - buffer.get());
+  *n = current - s;
   return SUCCESS;
 }
 
 int Utf16Decode(const char* s, size_t n, std::string* out) {
   assert(s && n > 0 && out);
-  iconv_t id = iconv_open("UTF-8", "UTF-16");
-  if (id == iconv_t(-1)) {
-    throw std::system_error(errno,
-        std::system_category(), "iconv_open failed");
-  }
-  out->resize(n * 2);
-  size_t out_size = out->size();
-  char* in_ptr = const_cast<char*>(s);
-  char* out_ptr = const_cast<char*>(out->data());
-  if (iconv(id, &in_ptr, &n, &out_ptr, &out_size) == size_t(-1)) {
-    iconv_close(id);
+#if __BYTE_ORDER == __BIG_ENDIAN
+  const bool big_endian = true;
+#else
+  const bool big_endian = false;
+#endif
+  if (!utf16_to_utf8(s, n, big_endian, true, out))
     return DECODE_FAILED;
-  }
-  out->erase(out->size() - out_size);
-  iconv_close(id);
   return SUCCESS;
 }
 
-int ConvertDecode(const char* s, size_t n, std::string* out) {
+int CharsetToUtf8(const std::string& from, const char* s, size_t n,
+                  std::string* out) {
   assert(s && n > 0 && out);
-  out->resize(n);
-  std::reverse_copy(s - 1, s + n - 1, std::back_inserter(*out));
+  const Charset charset = charset_of(from);
+  switch (charset) {
+  case CHARSET_GBK:
+  case CHARSET_GB18030:
+    if (gb_to_utf8(s, n, charset == CHARSET_GBK, out))
+      return SUCCESS;
+    break;
+  case CHARSET_UTF16:
+    return Utf16Decode(s, n, out);
+  case CHARSET_UTF16LE:
+  case CHARSET_UTF16BE:
+    if (!utf16_to_utf8(s, n, charset == CHARSET_UTF16BE, false, out)) {
+      return DECODE_FAILED;
+    }
+    return SUCCESS;
+  default:
+    break;
+  }
+  return iconv_to_utf8(from, s, n, out);
+}
+
+int ConvertDecode(char* s, size_t* n) {
+  assert(s && n && *n > 0);
+  std::reverse(s, s + *n);
   return SUCCESS;
 }
 
-int EscapeDecode(const char* s, size_t n, std::string* out) {
-  assert(s && n > 0 && out);
-  out->resize(n);
-  char* d = const_cast<char*>(out->data());
-  const char* end = s + n;
+// Every escape sequence is longer than the UTF-8 it's decoded to, and it's
+// read before the output is written, so s can be decoded in place.
+int EscapeDecode(char* s, size_t* n) {
+  assert(s && n && *n > 0);
+  char* d = s;
+  const char* p = s;
+  const char* end = s + *n;
 
-  while (s < end) {
-    if (s[0] == '\\' && s + 1 < end) {
+  while (p < end) {
+    if (p[0] == '\\' && p + 1 < end) {
       // \\, \', \", \xXX, \uXXXX
-      switch (s[1]) {
+      switch (p[1]) {
       case '\\':
         *d++ = '\\';
-        s += 2;
+        p += 2;
         break;
       case '\'':
         *d++ = '\'';
-        s += 2;
+        p += 2;
         break;
       case '"':
         *d++ = '\"';
-        s += 2;
+        p += 2;
         break;
       case 'x': {
-        if (s + 3 < end && ascii_isxdigit_n(s + 2, 2)) {
-          unsigned int ch = (hex_digit_to_int(s[2]) << 4) | hex_digit_to_int(s[3]);
+        if (p + 3 < end && ascii_isxdigit_n(p + 2, 2)) {
+          unsigned int ch = (hex_digit_to_int(p[2]) << 4) | hex_digit_to_int(p[3]);
           ch &= 0x000000FF;
           *d++ = ch;
-          s += 4;
+          p += 4;
         } else {
-          *d++ = *s++;
+          *d++ = *p++;
         }
         break;
       }
       case 'u': {
-        if (s + 5 < end && ascii_isxdigit_n(s + 2, 4)) {
-          std::string buf = UTF16HexStringToUTF8(s + 2);
+        if (p + 5 < end && ascii_isxdigit_n(p + 2, 4)) {
+          std::string buf = UTF16HexStringToUTF8(p + 2);
           if (!buf.empty()) {
             memcpy(d, buf.data(), buf.size());
             d += buf.size();
-            s += 6;
+            p += 6;
           } else {
-            *d++ = *s++;
+            *d++ = *p++;
           }
         } else {
-          *d++ = *s++;
+          *d++ = *p++;
         }
         break;
       }
       default:
-        *d++ = *s++;
+        *d++ = *p++;
         break;
       } // end switch
-    }  else if (s[0] == '%' && s[1] == 'u' && s + 5 < end && ascii_isxdigit_n(s + 2, 4)) {
+    }  else if (p[0] == '%' && p + 5 < end && p[1] == 'u' && ascii_isxdigit_n(p + 2, 4)) {
       // %uXXXX
-      std::string buf = UTF16HexStringToUTF8(s + 2);
+      std::string buf = UTF16HexStringToUTF8(p + 2);
       if (!buf.empty()) {
         memcpy(d, buf.data(), buf.size());
         d += buf.size();
-        s += 6;
+        p += 6;
       } else {
-        *d++ = *s++;
+        *d++ = *p++;
       }
-    } else if (s[0] == '&' && s[1] == '#' && s + 6 < end && ascii_isddigit_n(s + 2, 5)) {
+    } else if (p[0] == '&' && p + 6 < end && p[1] == '#' && ascii_isddigit_n(p + 2, 5)) {
       // &#\XXXXX
       uint16_t value = 0;
       for (size_t i = 2; i <= 6; ++i)
-        value = value * 10 + dec_digit_to_int(s[i]);
+        value = value * 10 + dec_digit_to_int(p[i]);
       std::string buf;
       if (Utf16Decode(reinterpret_cast<const char*>(&value), 2, &buf) == SUCCESS) {
         memcpy(d, buf.data(), buf.size());
         d += buf.size();
-        s += 7;
+        p += 7;
       } else {
-        *d++ = *s++;
+        *d++ = *p++;
       }
     } else {
-      *d++ = *s++;
+      *d++ = *p++;
     }
   }
-  out->erase(d - out->data());
+  *n = d - s;
   return SUCCESS;
 }
 
-int QpDecode(const char* s, size_t n, std::string* out) {
-  assert(s && n > 0 && out);
-  out->resize(n + 2);
-  const char* end = s + n;
-  char* d = const_cast<char*>(out->data());
-  while (s < end) {
-    if (*s != '=') {
-      *d++ = *s++;
+int QpDecode(char* s, size_t* n) {
+  assert(s && n && *n > 0);
+  char* d = s;
+  const char* p = s;
+  const char* end = s + *n;
+  while (p < end) {
+    if (*p != '=') {
+      *d++ = *p++;
     } else {
-      if (s + 2 < end && s[1] == '\r' && s[2] == '\n') {
+      if (p + 2 < end && p[1] == '\r' && p[2] == '\n') {
         // skip
-        s += 3;
-      } else if (s + 2 < end && ascii_isxdigit(s[1]) && ascii_isxdigit(s[2])){
-        *d++ = (hex_digit_to_int(s[1]) << 4) | hex_digit_to_int(s[2]);
-        s += 3;
+        p += 3;
+      } else if (p + 2 < end && ascii_isxdigit(p[1]) && ascii_isxdigit(p[2])){
+        *d++ = (hex_digit_to_int(p[1]) << 4) | hex_digit_to_int(p[2]);
+        p += 3;
       } else {
-        *d++ = *s++;
+        *d++ = *p++;
       }
     }
   }
-  out->erase(d - out->data());
+  *n = d - s;
   return SUCCESS;
 }
 
-int Codecode(Codec::Type type, std::string* s) {
-  if (type == Codec::UTF8)
-    return 0;
-
-  static const std::map<Codec::Type, CodecFunc> map{
-      { Codec::GZIP,    GzipUncompress },
-      { Codec::ZLIB,    ZlibUncompress },
-      { Codec::DEFLATE, ZlibUncompress },
-
-      { Codec::URL,     UrlDecode      },
-      { Codec::BASE64,  Base64Decode   },
-      { Codec::UNICODE, Utf16Decode    },
-      { Codec::ESCAPE,  EscapeDecode   },
-      { Codec::QP,      QpDecode       },
-      { Codec::CONVERT, ConvertDecode  },
+CodecChain::CodecChain(const std::vector<Codec::Type>& types) {
+  static const std::map<Codec::Type, Stage> map{
+      { Codec::GZIP,    { NULL,          GzipUncompress, true,  0 } },
+      { Codec::ZLIB,    { NULL,          ZlibUncompress, true,  0 } },
+      { Codec::DEFLATE, { NULL,          ZlibUncompress, true,  0 } },
+      { Codec::UNICODE, { NULL,          UnicodeDecode,  false, 0 } },
+
+      // %XX, and \uXXXX/&#XXXXX are the longest sequences. QP drops the
+      // soft line breaks, so its output isn't bounded by the input.
+      { Codec::URL,     { UrlDecode,     NULL,           false, 3 } },
+      { Codec::BASE64,  { Base64Decode,  NULL,           false, 0 } },
+      { Codec::ESCAPE,  { EscapeDecode,  NULL,           false, 7 } },
+      { Codec::QP,      { QpDecode,      NULL,           false, 0 } },
+      { Codec::CONVERT, { ConvertDecode, NULL,           false, 0 } },
   };
 
-  CodecFunc func = SafeFindOrDie(map, type);
-  std::string buf;
-  int ret = func(s->data(), s->size(), &buf);
-  if (ret == SUCCESS)
-    s->swap(buf);
+  for (size_t i = 0; i < types.size(); ++i) {
+    if (types[i] == Codec::UTF8)
+      continue;
+    // Reversing twice is nothing to do.
+    if (types[i] == Codec::CONVERT &&
+        !types_.empty() && types_.back() == Codec::CONVERT) {
+      types_.pop_back();
+      stages_.pop_back();
+      continue;
+    }
+    types_.push_back(types[i]);
+    stages_.push_back(SafeFindOrDie(map, types[i]));
+  }
+}
+
+size_t CodecChain::Need(size_t n, size_t reach) const {
+  assert(n <= stages_.size());
+  for (size_t i = stages_.size(); i > n; --i) {
+    const Stage& stage = stages_[i - 1];
+    if (reach == std::string::npos || stage.ratio == 0 ||
+        reach >= g_inflate_limit) {
+      return std::string::npos;
+    }
+    // A sequence cut at the end is left as it is.
+    reach = (reach + 1) * stage.ratio;
+  }
+  return reach;
+}
+
+int CodecChain::Decode(size_t i, std::string* s,
+                       size_t limit, bool* truncated) const {
+  assert(i < stages_.size());
+  if (truncated)
+    *truncated = false;
+  if (s->empty())
+    return SUCCESS;
+
+  const Stage& stage = stages_[i];
+  if (stage.inplace) {
+    size_t n = s->size();
+    int ret = stage.inplace(&(*s)[0], &n);
+    if (ret == SUCCESS)
+      s->resize(n);
+    return ret;
+  }
+
+  // The input is kept on error, so it's decoded into the other buffer,
+  // whose storage is reused by the next expanding decoder after swapping.
+  static thread_local std::string buf;
+  buf.clear();
+  int ret = stage.func(s->data(), s->size(), limit, &buf);
+  if (ret != SUCCESS)
+    return ret;
+  if (truncated && stage.inflate)
+    *truncated = buf.size() >= std::min(limit, g_inflate_limit);
+  s->swap(buf);
   return ret;
 }
 
-int Codecode(const std::vector<Codec::Type>& types, std::string* s) {
+int CodecChain::Decode(std::string* s) const {
   int ret = SUCCESS;
-  for (size_t i = 0; i < types.size(); ++i) {
-    ret = Codecode(types[i], s);
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    ret = Decode(i, s, std::string::npos, NULL);
     if (ret != SUCCESS)
       break;
   }
   return ret;
 }
 
+int Codecode(Codec::Type type, std::string* s) {
+  return Codecode(std::vector<Codec::Type>(1, type), s);
+}
+
+// The in-place codecs write over the input before they may fail, so the
+// chain decodes a copy in a per-thread buffer that's swapped with s only
+// on success, as the callers expect s to be kept on error. The input is
+// copied once for the whole chain.
+int Codecode(const std::vector<Codec::Type>& types, std::string* s) {
+  static thread_local std::string scratch;
+  CodecChain chain(types);
+  scratch.assign(*s);
+  int ret = chain.Decode(&scratch);
+  if (ret == SUCCESS)
+    s->swap(scratch);
+  return ret;
+}
+
 } // namespace ext
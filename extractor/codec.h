@@ -10,11 +10,96 @@
 
 namespace ext {
 // Decode s with the type and result will be written back to s.
-// returns zero on success, on error, error code is returned.
+// returns zero on success, on error, error code is returned and s is
+// left untouched.
 int Codecode(Codec::Type type, std::string* s);
 
-// Like as Codecode, but it decoded with more types.
+// Like as Codecode, but it decoded with more types, s is left untouched
+// if any of them fails.
 int Codecode(const std::vector<Codec::Type>& types, std::string* s);
+
+// Converts s in the charset `from' to UTF-8 and writes it to out.
+// GBK, GB18030 and UTF-16 are converted natively as iconv does, the
+// others by iconv, whose descriptors are cached per thread.
+// returns zero on success, DECODE_FAILED if s is invalid in the charset.
+int CharsetToUtf8(const std::string& from, const char* s, size_t n,
+                  std::string* out);
+
+// Backend that inflates the zlib and gzip streams, the default one is
+// based on zlib. It's pluggable so that other implementations can be
+// dropped in and compared with zlib.
+class Inflater {
+ public:
+  enum Format {
+    ZLIB,
+    GZIP,
+  };
+
+  virtual ~Inflater() {}
+
+  // Inflates the stream s and writes at most `limit' bytes to out, the
+  // content of out is replaced. A truncated or corrupted stream yields
+  // what has been inflated before it broke, UNCOMPRESS_FAILED is returned
+  // only if nothing could be inflated.
+  virtual int Inflate(Format fmt, const char* s, size_t n, size_t limit,
+                      std::string* out) = 0;
+};
+
+// Replaces the inflater, NULL restores the default one. The caller keeps
+// the ownership, and it must be called before extracting, it's not
+// thread-safe.
+void SetInflater(Inflater* inflater);
+
+// The most bytes a compressed content is inflated to, the rest is dropped.
+extern size_t g_inflate_limit;
+
+// A codec chain resolved to the decoder functions, it's built once when
+// the rules are loaded. UTF8 is dropped and adjacent CONVERTs cancel out,
+// so types() is the normalized chain.
+//
+// Decoders which never grow the data (URL, BASE64, ESCAPE, QP, CONVERT)
+// run in place, the others decode into a per-thread buffer which is
+// swapped with the input, so a chain doesn't allocate once the buffers
+// are warmed up.
+class CodecChain {
+ public:
+  CodecChain() {}
+  explicit CodecChain(const std::vector<Codec::Type>& types);
+
+  bool empty() const { return types_.empty(); }
+  size_t size() const { return types_.size(); }
+  const std::vector<Codec::Type>& types() const { return types_; }
+
+  // Returns how many bytes the first n codecs have to decode so that the
+  // first `reach' bytes of the chain's output are exact, npos means the
+  // whole content. A prefix decoded by URL or ESCAPE is the prefix of
+  // the whole decoded content, but other codecs need the whole input.
+  size_t Need(size_t n, size_t reach) const;
+
+  // Decodes s with the i-th codec of the chain, an inflating codec stops
+  // after `limit' bytes and `truncated' tells whether it has stopped.
+  // s is garbage on error if the codec runs in place.
+  int Decode(size_t i, std::string* s, size_t limit, bool* truncated) const;
+  // Decodes s with the whole chain, it stops at the first error.
+  int Decode(std::string* s) const;
+
+ private:
+  typedef int (*InplaceFunc)(char* s, size_t* n);
+  typedef int (*CodecFunc)(const char* s, size_t n, size_t limit,
+                           std::string* out);
+
+  struct Stage {
+    InplaceFunc inplace;
+    CodecFunc func;
+    bool inflate;
+    // The most input bytes an output byte is decoded from, zero if a
+    // decoded prefix is not the prefix of the whole output.
+    size_t ratio;
+  };
+
+  std::vector<Codec::Type> types_;
+  std::vector<Stage> stages_;
+};
 } // namespace ext
 
 #endif // EXTRACTOR_CODEC_H_
@@ -3,8 +3,13 @@
 #include <iostream>
 #include <cassert>
 #include <cstring>
+#include <cstdlib>
+#include <cctype>
 #include <string>
+#include <vector>
 #include <fstream>
+#include <zlib.h>
+#include <iconv.h>
 
 #include "extractor/codec.h"
 #include "extractor/trivial.h"
@@ -29,6 +34,45 @@ void TestCaseDecodeUrl() {
   assert(out == src);
 }
 
+// The byte-by-byte decoder that the vectorized one must agree with.
+std::string UrlDecodeReference(const std::string& s) {
+  std::string out;
+  size_t i = 0;
+  while (i < s.size()) {
+    if (s[i] == '%' && i + 2 < s.size()) {
+      if (isxdigit(s[i + 1]) && isxdigit(s[i + 2])) {
+        out.push_back(std::stoi(s.substr(i + 1, 2), NULL, 16));
+      } else {
+        out.append(s, i, 3);
+      }
+      i += 3;
+    } else {
+      out.push_back(s[i] == '+' ? ' ' : s[i]);
+      ++i;
+    }
+  }
+  return out;
+}
+
+void TestCaseDecodeUrlRandom() {
+  const char alphabet[] = "%%%++aZ09fFgG \x80\xff";
+  unsigned int seed = 20191019;
+  for (int i = 0; i < 20000; ++i) {
+    size_t n = 1 + rand_r(&seed) % 100;
+    std::string s;
+    for (size_t j = 0; j < n; ++j) {
+      // Long clean spans as well as dense escapes.
+      if (rand_r(&seed) % 4 == 0)
+        s.append(rand_r(&seed) % 40, 'a' + j % 26);
+      s.push_back(alphabet[rand_r(&seed) % (sizeof(alphabet) - 1)]);
+    }
+    std::string out(s);
+    int ret = Codecode(Codec::Type::URL, &out);
+    assert(ret == SUCCESS);
+    assert(out == UrlDecodeReference(s));
+  }
+}
+
 void TestCaseDecodeEscape() {
   const char* s =
       "&#23567 \\x68ello \\u5C0F world %u5C0F\\\\ \\\" \\\'";
@@ -1893,6 +1937,67 @@ void TestCaseDecodeBase64() {
   assert(out == src);
 };
 
+std::string Base64Encode(const std::string& s, bool url_safe, bool pad) {
+  const char* chars = url_safe
+      ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+      : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  size_t i = 0;
+  for (; i + 3 <= s.size(); i += 3) {
+    unsigned int v = (unsigned char)s[i] << 16 |
+                     (unsigned char)s[i + 1] << 8 |
+                     (unsigned char)s[i + 2];
+    for (int j = 3; j >= 0; --j)
+      out.push_back(chars[(v >> (6 * j)) & 0x3F]);
+  }
+  size_t left = s.size() - i;
+  if (left > 0) {
+    unsigned int v = (unsigned char)s[i] << 16;
+    if (left == 2)
+      v |= (unsigned char)s[i + 1] << 8;
+    for (size_t j = 0; j <= left; ++j)
+      out.push_back(chars[(v >> (18 - 6 * j)) & 0x3F]);
+    if (pad)
+      out.append(3 - left, '=');
+  }
+  return out;
+}
+
+void TestCaseDecodeBase64Random() {
+  unsigned int seed = 1019;
+  for (int i = 0; i < 5000; ++i) {
+    std::string src;
+    size_t n = rand_r(&seed) % 300;
+    for (size_t j = 0; j < n; ++j)
+      src.push_back(static_cast<char>(rand_r(&seed)));
+    std::string b64 = Base64Encode(src, i % 2 == 0, i % 3 != 0);
+    if (i % 5 == 0 && !b64.empty()) {
+      // MIME line breaks.
+      for (size_t j = 76; j < b64.size(); j += 78)
+        b64.insert(j, "\r\n");
+    }
+    if (b64.empty())
+      continue;
+
+    std::string out(b64);
+    int ret = Codecode(Codec::Type::BASE64, &out);
+    assert(ret == SUCCESS);
+    assert(out == src);
+
+    // An invalid character anywhere fails as before.
+    out = b64;
+    out[rand_r(&seed) % out.size()] = '*';
+    ret = Codecode(Codec::Type::BASE64, &out);
+    assert(ret == DECODE_FAILED);
+  }
+
+  std::string out("aGVsbG8gd29ybGQh" "aGVsbG8gd29ybGQh" "a");
+  assert(Codecode(Codec::Type::BASE64, &out) == DECODE_FAILED);
+  out = "aGVsbG8gd29ybGQ= \n";
+  assert(Codecode(Codec::Type::BASE64, &out) == SUCCESS);
+  assert(out == "hello world");
+}
+
 void TestCaseDecodeQp() {
   const char* s = "hello=20=\r\nworld=0d=0a";
   const char* src = "hello world\r\n";
@@ -1902,6 +2007,215 @@ void TestCaseDecodeQp() {
   assert(out == src);
 };
 
+void TestCaseDecodeConvert() {
+  std::string out("dlrow olleh");
+  int ret = Codecode(Codec::Type::CONVERT, &out);
+  assert(ret == SUCCESS);
+  assert(out == "hello world");
+}
+
+void TestCaseCodecChain() {
+  std::vector<Codec::Type> types{
+      Codec::Type::URL, Codec::Type::UTF8, Codec::Type::BASE64,
+      Codec::Type::CONVERT, Codec::Type::CONVERT, Codec::Type::QP};
+  CodecChain chain(types);
+  assert(chain.size() == 3);
+  assert(chain.types()[0] == Codec::Type::URL);
+  assert(chain.types()[1] == Codec::Type::BASE64);
+  assert(chain.types()[2] == Codec::Type::QP);
+
+  // "hello=20world" in base64, then URL encoded.
+  std::string out("aGVsbG89MjB3b3JsZA%3D%3D");
+  int ret = chain.Decode(&out);
+  assert(ret == SUCCESS);
+  assert(out == "hello world");
+
+  // The input is kept when it failed.
+  out = "a!b";
+  ret = CodecChain(std::vector<Codec::Type>(1, Codec::Type::GZIP)).Decode(&out);
+  assert(ret == UNCOMPRESS_FAILED);
+  assert(out == "a!b");
+
+  assert(CodecChain(std::vector<Codec::Type>(1, Codec::Type::UTF8)).empty());
+}
+
+void TestCaseCodecodeError() {
+  // BASE64 decodes in place and fails after the first quad.
+  std::string out("QUJDRA==!!!!");
+  int ret = Codecode(Codec::Type::BASE64, &out);
+  assert(ret != SUCCESS);
+  assert(out == "QUJDRA==!!!!");
+
+  // Nor are the codecs before the failed one kept.
+  std::vector<Codec::Type> types{Codec::Type::URL, Codec::Type::BASE64};
+  out = "QUJDRA%3D%3D!!!!";
+  ret = Codecode(types, &out);
+  assert(ret != SUCCESS);
+  assert(out == "QUJDRA%3D%3D!!!!");
+
+  out = "QUJDRA%3D%3D";
+  ret = Codecode(types, &out);
+  assert(ret == SUCCESS);
+  assert(out == "ABCD");
+}
+
+// Compresses s to the zlib or gzip format.
+std::string Deflate(const std::string& s, bool gzip) {
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  int ret = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                         MAX_WBITS + (gzip ? 16 : 0), 8, Z_DEFAULT_STRATEGY);
+  assert(ret == Z_OK);
+  std::string out(deflateBound(&strm, s.size()) + 32, '\0');
+  strm.next_in = (Bytef*)s.data();
+  strm.avail_in = s.size();
+  strm.next_out = (Bytef*)&out[0];
+  strm.avail_out = out.size();
+  ret = deflate(&strm, Z_FINISH);
+  assert(ret == Z_STREAM_END);
+  out.resize(strm.total_out);
+  deflateEnd(&strm);
+  return out;
+}
+
+void TestCaseInflateLarge() {
+  // Larger than the old 256KB chunk, with ISIZE and without it.
+  std::string src;
+  for (int i = 0; src.size() < (1 << 20); ++i)
+    src.append(std::to_string(i * 7919)).push_back(',');
+
+  for (int i = 0; i < 2; ++i) {
+    bool gzip = i == 0;
+    std::string out = Deflate(src, gzip);
+    int ret = Codecode(gzip ? Codec::Type::GZIP : Codec::Type::ZLIB, &out);
+    assert(ret == SUCCESS);
+    assert(out == src);
+  }
+
+  // The stream of the thread is reused after a corrupted one.
+  std::string bad("\x1f\x8b\x08\x00garbage garbage");
+  assert(Codecode(Codec::Type::GZIP, &bad) == UNCOMPRESS_FAILED);
+  std::string out = Deflate("hello world", true);
+  assert(Codecode(Codec::Type::GZIP, &out) == SUCCESS);
+  assert(out == "hello world");
+}
+
+void TestCaseInflatePartial() {
+  std::string src;
+  for (int i = 0; src.size() < (1 << 20); ++i)
+    src.append(std::to_string(i * 104729)).push_back(';');
+  const std::string gz = Deflate(src, true);
+
+  // What has been inflated before the stream is truncated or corrupted.
+  std::string out = gz.substr(0, gz.size() / 2);
+  assert(Codecode(Codec::Type::GZIP, &out) == SUCCESS);
+  assert(!out.empty() && out.size() < src.size());
+  assert(src.compare(0, out.size(), out) == 0);
+
+  out = gz;
+  out[out.size() / 2] ^= 0x55;
+  out[out.size() / 2 + 1] ^= 0x55;
+  assert(Codecode(Codec::Type::GZIP, &out) == SUCCESS);
+  assert(!out.empty() && out.size() < src.size());
+
+  // Inflated no more than the limit.
+  CodecChain chain(std::vector<Codec::Type>{Codec::Type::GZIP,
+                                            Codec::Type::URL});
+  assert(chain.Need(2, 100) == 100);
+  assert(chain.Need(1, 100) == 303);
+  assert(chain.Need(1, std::string::npos) == std::string::npos);
+  out = gz;
+  bool truncated = false;
+  assert(chain.Decode(0, &out, 303, &truncated) == SUCCESS);
+  assert(truncated);
+  assert(out == src.substr(0, 303));
+  out = gz;
+  assert(chain.Decode(0, &out, std::string::npos, &truncated) == SUCCESS);
+  assert(!truncated);
+  assert(out == src);
+
+  CodecChain b64(std::vector<Codec::Type>{Codec::Type::GZIP,
+                                          Codec::Type::BASE64});
+  assert(b64.Need(1, 100) == std::string::npos);
+
+  // The global limit.
+  size_t limit = g_inflate_limit;
+  g_inflate_limit = 1000;
+  out = gz;
+  assert(Codecode(Codec::Type::GZIP, &out) == SUCCESS);
+  assert(out == src.substr(0, 1000));
+  g_inflate_limit = limit;
+}
+
+struct FakeInflater : public Inflater {
+  int calls;
+  FakeInflater(): calls(0) {}
+  virtual int Inflate(Format fmt, const char*, size_t, size_t,
+                      std::string* out) {
+    ++calls;
+    out->assign(fmt == GZIP ? "gzip" : "zlib");
+    return SUCCESS;
+  }
+};
+
+void TestCaseSetInflater() {
+  FakeInflater fake;
+  SetInflater(&fake);
+  std::string out = Deflate("hello world", true);
+  assert(Codecode(Codec::Type::GZIP, &out) == SUCCESS);
+  assert(out == "gzip");
+  assert(fake.calls == 1);
+
+  SetInflater(NULL);
+  out = Deflate("hello world", false);
+  assert(Codecode(Codec::Type::ZLIB, &out) == SUCCESS);
+  assert(out == "hello world");
+  assert(fake.calls == 1);
+}
+
+// Converts by iconv directly, empty on error.
+bool IconvReference(const char* from, const std::string& s, std::string* out) {
+  iconv_t id = iconv_open("UTF-8", from);
+  assert(id != iconv_t(-1));
+  out->assign(s.size() * 4, '\0');
+  char* ibuf = const_cast<char*>(s.data());
+  size_t ilen = s.size();
+  char* obuf = &(*out)[0];
+  size_t olen = out->size();
+  bool ok = iconv(id, &ibuf, &ilen, &obuf, &olen) != size_t(-1);
+  out->resize(out->size() - olen);
+  iconv_close(id);
+  return ok;
+}
+
+void TestCaseCharset() {
+  const char* charsets[] = {"GBK", "gb18030", "UTF-16", "utf-16le",
+                            "UTF-16BE", "BIG5"};
+  unsigned int seed = 33;
+  for (size_t c = 0; c < sizeof(charsets) / sizeof(charsets[0]); ++c) {
+    // Every two-byte sequence, and random mixed strings.
+    for (int i = 0; i < 0x10000 + 20000; ++i) {
+      std::string s;
+      if (i < 0x10000) {
+        s.push_back(static_cast<char>(i >> 8));
+        s.push_back(static_cast<char>(i));
+      } else {
+        size_t n = 1 + rand_r(&seed) % 12;
+        for (size_t j = 0; j < n; ++j) {
+          int r = rand_r(&seed);
+          s.push_back(static_cast<char>(r % 3 == 0 ? 'a' + r % 26 : r >> 8));
+        }
+      }
+      std::string expected, out;
+      bool ok = IconvReference(charsets[c], s, &expected);
+      int ret = CharsetToUtf8(charsets[c], s.data(), s.size(), &out);
+      assert(ok == (ret == SUCCESS));
+      if (ok)
+        assert(out == expected);
+    }
+  }
+}
+
 void ReadFile(const char* fname, std::string* out) {
   std::ifstream in(fname);
   assert(in);
@@ -1914,10 +2228,19 @@ void ReadFile(const char* fname, std::string* out) {
 
 int main(int argc, char* argv[]) {
   TestCaseDecodeUrl();
+  TestCaseDecodeUrlRandom();
   TestCaseDecodeEscape();
   TestCaseDecodeEscape2();
   TestCaseUncompressGzip();
   TestCaseDecodeQp();
+  TestCaseDecodeBase64Random();
+  TestCaseCharset();
+  TestCaseDecodeConvert();
+  TestCaseCodecChain();
+  TestCaseCodecodeError();
+  TestCaseInflateLarge();
+  TestCaseInflatePartial();
+  TestCaseSetInflater();
   if (argc == 2) {
     std::string buf;
     ReadFile(argv[1], &buf);
@@ -27,6 +27,10 @@ public:
                 const char* down, size_t down_size,
                 RecordSet* res, Record* attrib) const;
 
+  int ExtractAll(const char* buf, size_t size,
+                 std::vector<RecordSet>* res,
+                 std::vector<Record>* attribs) const;
+
 private:
   mutable pthread_rwlock_t rw_lock_;
   RuleTree rt_;
@@ -71,6 +75,28 @@ int Extractor::Impl::Extract(const char* up, size_t up_size,
   return ParserFactory(&rt_, &msg, res, attrib);
 }
 
+int Extractor::Impl::ExtractAll(const char* buf, size_t size,
+                                std::vector<RecordSet>* res,
+                                std::vector<Record>* attribs) const {
+  rdlock_guard guard(&rw_lock_);
+  std::vector<Message> msgs = ProbeAll(buf, size);
+  res->assign(msgs.size(), RecordSet());
+  attribs->assign(msgs.size(), Record());
+  if (msgs.empty())
+    return UNKNOWN_MESSAGE;
+
+  int ret = SUCCESS;
+  bool extracted = false;
+  for (size_t i = 0; i < msgs.size(); ++i) {
+    int err = ParserFactory(&rt_, &msgs[i], &(*res)[i], &(*attribs)[i]);
+    if (err == SUCCESS)
+      extracted = true;
+    else if (ret == SUCCESS)
+      ret = err;
+  }
+  return extracted ? SUCCESS : ret;
+}
+
 // Extractor interface
 Extractor::Extractor(): impl_(new Impl) {}
 
@@ -100,6 +126,12 @@ int Extractor::Extract(const char* up, size_t up_size,
   return impl_->Extract(up, up_size, down, down_size, res, attrib);
 }
 
+int Extractor::ExtractAll(const char* buf, size_t size,
+                          std::vector<RecordSet>* res,
+                          std::vector<Record>* attribs) const {
+  return impl_->ExtractAll(buf, size, res, attribs);
+}
+
 const char* Extractor::StringError(int code) {
   return string_error(code);
 }
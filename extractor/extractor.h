@@ -42,6 +42,15 @@ public:
               const char* down, size_t down_size,
               RecordSet* res, Record* attrib) const;
 
+  // Same as the above, but every transaction of the buffer, such as the
+  // requests and responses of several FHMF fields or pipelined requests,
+  // is extracted on its own. The results and attributes of the i-th one
+  // are written to res[i] and attribs[i]. Returns zero if one of them at
+  // least is extracted, the error of the first one otherwise.
+  int ExtractAll(const char* buf, size_t size,
+                 std::vector<RecordSet>* res,
+                 std::vector<Record>* attribs) const;
+
   static const char* StringError(int code);
 
 private:
@@ -1,12 +1,14 @@
 // Author: yuyue/X3130 (yuyue2200@hotmail.com)
 // File: rule_test.cc
 
+#include <cassert>
 #include <iostream>
 #include <cstring>
 #include <fstream>
 
 #include "extractor/rule.h"
 #include "extractor/extractor.h"
+#include "extractor/trivial.h"
 #include "rule_define.h"
 
 void ReadFile(const char* fname, std::string* out) {
@@ -40,13 +42,82 @@ void Extract(const char* http_file, const char* rule_file) {
   }
 }
 
+// A request of the URL with the BASE64 body.
+std::string Request(const char* url, const std::string& body) {
+  return std::string("POST ") + url + " HTTP/1.1\r\n"
+         "Host: extractor.example.com\r\n"
+         "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" +
+         body;
+}
+
+void ExtractAllTestCase() {
+  const char* user =
+      "<RULE RuleId=\"1000000793900000001\"  Key=\"USERNAME\"  \n"
+      "      DataSource=\"REQUESTCONTENT\"  >"
+      "  <STEP Prefix=\"1-user=\"  />"
+      "</RULE>";
+  std::string rule =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+      "<pIE_RULES>"
+      "  <HOST HostId=\"20000007939\"  Host=\"extractor.example.com\"  >"
+      "    <URL UrlId=\"2000000793900001\"  Url=\"/a\"  \n"
+      "          AppName=\"extractor\"  Action=\"TEST\"  \n"
+      "          ReqCntEncode=\"BASE64\"  >";
+  rule += user;
+  rule += "    </URL>"
+          "    <URL UrlId=\"2000000793900002\"  Url=\"/b\"  \n"
+          "          AppName=\"extractor\"  Action=\"TEST\"  \n"
+          "          ReqCntEncode=\"BASE64\"  >";
+  rule += user;
+  rule += "    </URL>"
+          "  </HOST>"
+          "</pIE_RULES>";
+  ext::Extractor ext(rule.data(), rule.size());
+
+  // "user=alice" and "user=bob", "!!!!" is no BASE64.
+  std::string alice = Request("/a", "dXNlcj1hbGljZQ==");
+  std::string bob = Request("/b", "dXNlcj1ib2I=");
+  std::string bad = Request("/a", "!!!!");
+  std::string unknown = Request("/unknown", "dXNlcj1ib2I=");
+
+  // The records and attributes of the pipelined requests line up with
+  // them, one that fails has none.
+  std::string buf = bob + unknown + alice;
+  std::vector<ext::RecordSet> res;
+  std::vector<ext::Record> attribs;
+  int ret = ext.ExtractAll(buf.data(), buf.size(), &res, &attribs);
+  assert(ret == ext::SUCCESS);
+  assert(res.size() == 3 && attribs.size() == 3);
+  assert(res[0].size() == 1 && ext::SafeFind(res[0][0], "USERNAME") == "bob");
+  assert(ext::SafeFind(attribs[0], "URL_ID") == "2000000793900002");
+  assert(res[1].empty() && attribs[1].empty());
+  assert(res[2].size() == 1 &&
+         ext::SafeFind(res[2][0], "USERNAME") == "alice");
+  assert(ext::SafeFind(attribs[2], "URL_ID") == "2000000793900001");
+
+  // It succeeds if any request does, else fails with the first error.
+  buf = bad + alice;
+  ret = ext.ExtractAll(buf.data(), buf.size(), &res, &attribs);
+  assert(ret == ext::SUCCESS && res.size() == 2 && res[0].empty());
+  assert(res[1].size() == 1);
+  buf = bad + unknown;
+  ret = ext.ExtractAll(buf.data(), buf.size(), &res, &attribs);
+  assert(ret != ext::SUCCESS && ret != ext::NOT_FOUND_RULE);
+  assert(res.size() == 2 && res[0].empty() && res[1].empty());
+  buf = unknown + bad;
+  ret = ext.ExtractAll(buf.data(), buf.size(), &res, &attribs);
+  assert(ret == ext::NOT_FOUND_RULE);
+
+  // No message at all.
+  ret = ext.ExtractAll("", 0, &res, &attribs);
+  assert(ret == ext::UNKNOWN_MESSAGE && res.empty() && attribs.empty());
+}
+
 int main(int argc, char* argv[]) {
   if (argc == 3) {
     Extract(argv[1], argv[2]);
   } else {
-    //Extract("../tools/post.http", "../tools/rule.xml");
-    //Extract("../tools/json/3.http", "../tools/json/full_oep.xml");
-    Extract("../tools/gzip/2.http", "../tools/gzip/full_oep.xml");
+    ExtractAllTestCase();
   }
 
   return 0;
@@ -5,11 +5,17 @@
 #include <cmath>
 #include <cctype>
 #include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
 #include <unordered_map>
-#include <unordered_set>
 #include <memory>
 #include <algorithm>
 #include <stdexcept>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EXTRACTOR_X86 1
+#endif
 
 namespace ext {
 namespace {
@@ -17,7 +23,6 @@ namespace {
   XX(PHONENUM,                  KeyType::PHONE)       \
   XX(IDFAorIDFV,                KeyType::IDFX)        \
   XX(TAOBAO_ACCOUNT,            KeyType::UNKNOWN)     \
-  XX(TAOBAO_ACCOUNT,            KeyType::UNKNOWN)     \
   XX(ALIPAY_ACCOUNT,            KeyType::UNKNOWN)     \
   XX(QQ_ACCOUNT,                KeyType::UNKNOWN)     \
   XX(WEIXIN_ACCOUNT,            KeyType::UNKNOWN)     \
@@ -380,163 +385,281 @@ namespace {
   XX(BANKNAME,                  KeyType::UNKNOWN)     \
   XX(BANKNODE,                  KeyType::UNKNOWN)
 
-const char* kAsciiDigit = "1234567890";
-const char* kAsciiHexDigit = "1234567890abcdefABCDEF";
-//const char* kMacCharSet = "1234567890abcdefABCDEF:-";
+// FNV-1a, also used at compile time for the case labels of MakeType.
+constexpr uint32_t fnv1a(const char* s, uint32_t h = 2166136261u) {
+  return *s ? fnv1a(s + 1, (h ^ static_cast<unsigned char>(*s)) * 16777619u)
+            : h;
+}
+
+enum CharClass {
+  DIGIT,      // 0-9
+  HEX,        // 0-9a-fA-F
+  HEX_DASH,   // 0-9a-fA-F-
+};
 
 bool ascii_digit(char c) {
   int x = static_cast<unsigned char>(c);
   return x >= '0' && x <= '9';
 }
 
-inline int hex_digit_to_int(char c) {
-  int x = static_cast<unsigned char>(c);
-  if (x > '9')
-    x += 9;
-  return x & 0xf;
+bool ascii_hex(char c) {
+  int x = static_cast<unsigned char>(c) | 0x20;
+  return ascii_digit(c) || (x >= 'a' && x <= 'f');
 }
 
-void ToLower(std::string* s) {
-  for (size_t i = 0; i < s->size(); ++i) {
-    if ((*s)[i] >= 'A' && (*s)[i] <= 'Z')
-      (*s)[i] += 32;
+// Checks the n bytes starting at p all belong to the class, n is a
+// multiple of 16 so the vector variants need no tail loop.
+typedef bool (*ClassCheckFunc)(const char* p, size_t n, CharClass cls);
+
+bool class_check(const char* p, size_t n, CharClass cls) {
+  for (const char* e = p + n; p < e; ++p) {
+    switch (cls) {
+    case DIGIT: if (!ascii_digit(*p)) return false; break;
+    case HEX: if (!ascii_hex(*p)) return false; break;
+    case HEX_DASH: if (!ascii_hex(*p) && *p != '-') return false; break;
+    }
   }
+  return true;
 }
 
-bool phone_filter(std::string* s) {
-  assert(!s->empty());
-  const size_t size = s->size();
-  std::unique_ptr<char[]> buf(new char[size]);
-  if (!buf)
-    throw std::runtime_error("No enough memory");
-  char* p = buf.get();
-  for (size_t i = 0; i < size; ++i) {
-    if (ascii_digit((*s)[i]))
-      *p++ = (*s)[i];
+#ifdef EXTRACTOR_X86
+__attribute__((target("sse2")))
+bool class_check_sse2(const char* p, size_t n, CharClass cls) {
+  // Shift the range's low bound onto -128 so one signed compare checks
+  // both ends of it.
+  const __m128i digit_bias = _mm_set1_epi8(static_cast<char>('0' - 128));
+  const __m128i digit_max = _mm_set1_epi8(-128 + 9);
+  const __m128i alpha_bias = _mm_set1_epi8(static_cast<char>('a' - 128));
+  const __m128i alpha_max = _mm_set1_epi8(-128 + 5);
+  const __m128i lower = _mm_set1_epi8(0x20);
+  const __m128i dash = _mm_set1_epi8('-');
+  for (const char* e = p + n; p < e; p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i bad = _mm_cmpgt_epi8(_mm_sub_epi8(v, digit_bias), digit_max);
+    if (cls != DIGIT) {
+      __m128i l = _mm_or_si128(v, lower);
+      bad = _mm_and_si128(bad, _mm_cmpgt_epi8(
+          _mm_sub_epi8(l, alpha_bias), alpha_max));
+      if (cls == HEX_DASH)
+        bad = _mm_andnot_si128(_mm_cmpeq_epi8(v, dash), bad);
+    }
+    if (_mm_movemask_epi8(bad) != 0)
+      return false;
   }
-  s->assign(buf.get(), p);
+  return true;
+}
+#endif
+
+ClassCheckFunc resolve_class_check() {
+#ifdef EXTRACTOR_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+    return class_check_sse2;
+#endif
+  return class_check;
+}
+
+const ClassCheckFunc kClassCheck = resolve_class_check();
+
+// Pads out[n..] with '0', which every class accepts, up to a multiple
+// of 16 and checks the whole span.
+bool padded_check(char* out, size_t n, CharClass cls) {
+  size_t padded = (n + 15) & ~static_cast<size_t>(15);
+  memset(out + n, '0', padded - n);
+  return kClassCheck(out, padded, cls);
+}
 
-  if ((*s)[0] == '8' && (*s)[1] == '6') {
-    *s = s->substr(2);
-  } else if ((*s)[0] == '0' && (*s)[1] == '8' && (*s)[2] == '6') {
-    *s = s->substr(3);
+size_t phone_validator(string_view in, char* out) {
+  memcpy(out, in.data(), in.size());
+  size_t n = in.size();
+  if (!padded_check(out, n, DIGIT)) {
+    n = 0;
+    for (size_t i = 0; i < in.size(); ++i) {
+      if (ascii_digit(in[i]))
+        out[n++] = in[i];
+    }
   }
 
-  if (s->size() >= 3 && s->size() <= 6)
-    return (*s)[0] == '6' && (*s)[1] >= '1' && (*s)[1] <= '9';
+  const char* s = out;
+  if (n >= 2 && s[0] == '8' && s[1] == '6') {
+    s += 2;
+    n -= 2;
+  } else if (n >= 3 && s[0] == '0' && s[1] == '8' && s[2] == '6') {
+    s += 3;
+    n -= 3;
+  }
+  memmove(out, s, n);
 
-  if (s->size() != 11 || (*s)[0] != '1')
-    return false;
+  if (n >= 3 && n <= 6)
+    return out[0] == '6' && out[1] >= '1' && out[1] <= '9' ? n : 0;
 
-  switch ((*s)[1]) {
+  if (n != 11 || out[0] != '1')
+    return 0;
+
+  bool valid = false;
+  switch (out[1]) {
   case '3':
-  case '8': return (*s)[2] >= '0' && (*s)[2] <= '9';
-  case '4': return (*s)[2] >= '5' && (*s)[2] <= '9';
-  case '5': return (*s)[2] >= '0' && (*s)[2] <= '9' && (*s)[2] != '4';
-  case '6': return (*s)[2] == '5' || (*s)[2] == '6';
-  case '7': return (*s)[2] >= '0' && (*s)[2] <= '8';
-  case '9': return (*s)[2] == '1' || (*s)[2] == '5' || (*s)[2] == '8' || (*s)[2] == '9';
-  default: return false;
+  case '8': valid = out[2] >= '0' && out[2] <= '9'; break;
+  case '4': valid = out[2] >= '5' && out[2] <= '9'; break;
+  case '5': valid = out[2] >= '0' && out[2] <= '9' && out[2] != '4'; break;
+  case '6': valid = out[2] == '5' || out[2] == '6'; break;
+  case '7': valid = out[2] >= '0' && out[2] <= '8'; break;
+  case '9': valid = out[2] == '1' || out[2] == '5' || out[2] == '8' || out[2] == '9'; break;
+  default: break;
   }
+  return valid ? n : 0;
+}
 
-  return true;
+inline int digits_to_int(const char* s, size_t n) {
+  int v = 0;
+  for (size_t i = 0; i < n; ++i)
+    v = v * 10 + (s[i] - '0');
+  return v;
 }
 
-#if 0
-bool city_code_filter(std::string* s) {
-  assert(!s->empty());
-  if (s->size() != 6)
-    return false;
-  static const std::unordered_set<std::string> city_code{
+inline bool test_bit(const uint64_t* words, int i) {
+  return (words[i >> 6] >> (i & 63)) & 1;
+}
+
+// Returns the number of bits set below bit i of a 128 bits set.
+inline int rank_bit(const uint64_t* words, int i) {
+  const uint64_t below = (static_cast<uint64_t>(1) << (i & 63)) - 1;
+  return i < 64 ? __builtin_popcountll(words[0] & below)
+                : __builtin_popcountll(words[0]) +
+                  __builtin_popcountll(words[1] & below);
+}
+
+// Computes word w of the bit set holding values at compile time, the
+// tables below are constant initialized without any startup work.
+constexpr uint64_t bit_word(int) {
+  return 0;
+}
+
+template <typename... Values>
+constexpr uint64_t bit_word(int w, int v, Values... values) {
+  return ((v >> 6) == w ? static_cast<uint64_t>(1) << (v & 63) : 0) |
+         bit_word(w, values...);
+}
+
+// A city code is PPCCDD, province, city and district. kCityProvinces is
+// indexed by PP and holds the set of its cities CC, each city owns a row
+// of kCityDistricts holding the set of its districts DD. The rows of a
+// province are consecutive and ordered by CC. The tables are generated
+// from city_code.list by city_code_gen.
+struct CityProvince {
+  uint16_t first_row;
+  uint64_t cities[2];
+};
+
+const CityProvince kCityProvinces[100] = {
+#include "extractor/city_province.inline.h"
+};
+
+const uint64_t kCityDistricts[][2] = {
 #include "extractor/city_code.inline.h"
-  };
+};
 
-  return city_code.find(*s) != city_code.end();
+size_t city_code_validator(string_view in, char* out) {
+  if (in.size() != 6)
+    return 0;
+  memcpy(out, in.data(), in.size());
+  if (!padded_check(out, in.size(), DIGIT))
+    return 0;
+
+  const CityProvince& province = kCityProvinces[digits_to_int(out, 2)];
+  const int city = digits_to_int(out + 2, 2);
+  if (!test_bit(province.cities, city))
+    return 0;
+  const int row = province.first_row + rank_bit(province.cities, city);
+  return test_bit(kCityDistricts[row], digits_to_int(out + 4, 2)) ? 6 : 0;
 }
-#endif
 
-bool imsi_filter(std::string* s) {
-  assert(!s->empty());
-  if (s->size() != 15)
-    return false;
-  auto pos = s->find_first_not_of(kAsciiDigit);
-  if (pos != std::string::npos)
-    return false;
+#define IMSI_MCC_LIST                             \
+    202, 204, 206, 208, 212, 213, 214, 216,       \
+    218, 219, 220, 222, 225, 226, 228, 230,       \
+    231, 232, 234, 235, 238, 240, 242, 244,       \
+    246, 247, 248, 250, 255, 257, 259, 260,       \
+    262, 266, 268, 270, 272, 274, 276, 278,       \
+    280, 282, 283, 284, 286, 288, 290, 292,       \
+    293, 294, 295, 297, 302, 308, 310, 311,       \
+    312, 313, 314, 315, 316, 330, 332, 334,       \
+    338, 340, 342, 344, 346, 348, 350, 352,       \
+    354, 356, 358, 360, 362, 363, 364, 365,       \
+    366, 368, 370, 372, 374, 376, 400, 401,       \
+    402, 404, 405, 406, 410, 412, 413, 414,       \
+    415, 416, 417, 418, 419, 420, 421, 422,       \
+    424, 425, 426, 427, 428, 429, 430, 431,       \
+    432, 434, 436, 437, 438, 440, 441, 450,       \
+    452, 454, 455, 456, 457, 460, 461, 466,       \
+    467, 470, 472, 502, 505, 510, 514, 515,       \
+    520, 525, 528, 530, 534, 535, 536, 537,       \
+    539, 540, 541, 542, 543, 544, 545, 546,       \
+    547, 548, 549, 550, 551, 552, 555, 602,       \
+    603, 604, 605, 606, 607, 608, 609, 610,       \
+    611, 612, 613, 614, 615, 616, 617, 618,       \
+    619, 620, 621, 622, 623, 624, 625, 626,       \
+    627, 628, 629, 630, 631, 632, 633, 634,       \
+    635, 636, 637, 638, 639, 640, 641, 642,       \
+    643, 645, 646, 647, 648, 649, 650, 651,       \
+    652, 653, 654, 655, 657, 702, 704, 706,       \
+    708, 710, 712, 714, 716, 722, 724, 730,       \
+    732, 734, 736, 738, 740, 742, 744, 746,       \
+    748, 750, 901
+
+#define IMSI_CHINA_MNC_LIST                       \
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 20
+
+#define XX(w) bit_word(w, IMSI_MCC_LIST)
+const uint64_t kImsiMcc[16] = {
+  XX(0),  XX(1),  XX(2),  XX(3),  XX(4),  XX(5),  XX(6),  XX(7),
+  XX(8),  XX(9),  XX(10), XX(11), XX(12), XX(13), XX(14), XX(15),
+};
+#undef XX
 
-  // 460 08 7495038274
-  // MCC = 460
-  // MNC = 08
+const uint64_t kImsiChinaMnc[2] = {
+  bit_word(0, IMSI_CHINA_MNC_LIST), bit_word(1, IMSI_CHINA_MNC_LIST),
+};
 
-  static const std::unordered_set<std::string> imsi_mcc{
-    "202", "204", "206", "208", "212", "213", "214", "216",
-    "218", "219", "220", "222", "225", "226", "228", "230",
-    "231", "232", "234", "235", "238", "240", "242", "244",
-    "246", "247", "248", "250", "255", "257", "259", "260",
-    "262", "266", "268", "270", "272", "274", "276", "278",
-    "280", "282", "283", "284", "286", "288", "290", "292",
-    "293", "294", "295", "297", "302", "308", "310", "311",
-    "312", "313", "314", "315", "316", "330", "332", "334",
-    "338", "340", "342", "344", "346", "348", "350", "352",
-    "354", "356", "358", "360", "362", "363", "364", "365",
-    "366", "368", "370", "372", "374", "376", "400", "401",
-    "402", "404", "405", "406", "410", "412", "413", "414",
-    "415", "416", "417", "418", "419", "420", "421", "422",
-    "424", "425", "426", "427", "428", "429", "430", "431",
-    "432", "434", "436", "437", "438", "440", "441", "450",
-    "452", "454", "455", "456", "457", "460", "461", "466",
-    "467", "470", "472", "502", "505", "510", "514", "515",
-    "520", "525", "528", "530", "534", "535", "536", "537",
-    "539", "540", "541", "542", "543", "544", "545", "546",
-    "547", "548", "549", "550", "551", "552", "555", "602",
-    "603", "604", "605", "606", "607", "608", "609", "610",
-    "611", "612", "613", "614", "615", "616", "617", "618",
-    "619", "620", "621", "622", "623", "624", "625", "626",
-    "627", "628", "629", "630", "631", "632", "633", "634",
-    "635", "636", "637", "638", "639", "640", "641", "642",
-    "643", "645", "646", "647", "648", "649", "650", "651",
-    "652", "653", "654", "655", "657", "702", "704", "706",
-    "708", "710", "712", "714", "716", "722", "724", "730",
-    "732", "734", "736", "738", "740", "742", "744", "746",
-    "748", "750", "901",
-  };
+#undef IMSI_MCC_LIST
+#undef IMSI_CHINA_MNC_LIST
 
-  static const std::unordered_set<std::string> imsi_china_mnc{
-    "00", "01", "02", "03", "04", "05", "06", "07", "08",
-    "09", "11", "20"
-  };
+size_t imsi_validator(string_view in, char* out) {
+  if (in.size() != 15)
+    return 0;
+  memcpy(out, in.data(), in.size());
+  if (!padded_check(out, in.size(), DIGIT))
+    return 0;
 
-  const std::string mcc = s->substr(0, 3);
-  if (imsi_mcc.find(mcc) == imsi_mcc.end())
-    return false;
-  return mcc == "460" ?
-      (imsi_china_mnc.find(s->substr(3, 2)) != imsi_china_mnc.end()) : true;
+  // 460 08 7495038274
+  // MCC = 460
+  // MNC = 08
+  const int mcc = digits_to_int(out, 3);
+  if (!test_bit(kImsiMcc, mcc))
+    return 0;
+  if (mcc == 460 && !test_bit(kImsiChinaMnc, digits_to_int(out + 3, 2)))
+    return 0;
+  return in.size();
 }
 
-bool imei_filter(std::string* s) {
-  assert(!s->empty());
-  switch (s->size()) {
+size_t imei_validator(string_view in, char* out) {
+  memcpy(out, in.data(), in.size());
+  switch (in.size()) {
   case 14: {
     // 99, 98, 97
-    if ((*s)[0] == '9' &&
-        ((*s)[1] == '9' || (*s)[1] == '8' || (*s)[1] == '7'))
-      return true;
-    auto pos = s->find_first_not_of(kAsciiDigit);
-    if (pos == std::string::npos)
-      return true;
-    if ((*s)[0] == 'A' &&
-        (((*s)[1] >= '0' && (*s)[1] <= '9') || ((*s)[1] >= 'A' && (*s)[1] <= 'F'))) {
-      auto pos = s->find_first_not_of(kAsciiHexDigit);
-      if (pos == std::string::npos)
-        return true;
-    }
-    return false;
-  }
-  case 15: {
-    auto pos = s->find_first_not_of(kAsciiDigit);
-    return pos == std::string::npos;
+    if (in[0] == '9' && (in[1] == '9' || in[1] == '8' || in[1] == '7'))
+      return in.size();
+    if (padded_check(out, in.size(), DIGIT))
+      return in.size();
+    if (in[0] == 'A' &&
+        ((in[1] >= '0' && in[1] <= '9') || (in[1] >= 'A' && in[1] <= 'F')) &&
+        padded_check(out, in.size(), HEX))
+      return in.size();
+    return 0;
   }
+  case 15:
+    return padded_check(out, in.size(), DIGIT) ? in.size() : 0;
   default:
-    return false;
+    return 0;
   }
 }
 
@@ -553,26 +676,77 @@ bool CheckMacContinuedZero(const char* s, size_t n, int limit) {
   return true;
 }
 
-bool mac_filter(std::string* s) {
-  assert(!s->empty());
-  switch (s->size()) {
-  case 17: {
-    static const int offset[] = {2, 4, 6, 8, 10};
-    for (unsigned int i = 0; i < sizeof(offset) / sizeof(offset[0]); ++i) {
-      *reinterpret_cast<uint16_t*>(&(*s)[offset[i]])
-        = *reinterpret_cast<uint16_t*>(&(*s)[offset[i] + i + 1]);
+size_t mac_validator(string_view in, char* out) {
+  switch (in.size()) {
+  case 17:
+    for (size_t i = 0; i < 6; ++i) {
+      out[i * 2] = in[i * 3];
+      out[i * 2 + 1] = in[i * 3 + 1];
     }
-    s->resize(12);
+    break;
+  case 12:
+    memcpy(out, in.data(), in.size());
+    break;
+  default:
+    return 0;
   }
-  case 12: {
-    if (s->find_first_not_of(kAsciiHexDigit) != std::string::npos)
-      return false;
-    ToLower(s);
-    return CheckMacContinuedZero(s->data(), s->size(), 3);
+
+  if (!padded_check(out, 12, HEX))
+    return 0;
+  // Every byte is a hex digit now, setting bit 5 lowers the letters
+  // and leaves the digits alone.
+  for (size_t i = 0; i < 12; ++i)
+    out[i] |= 0x20;
+  return CheckMacContinuedZero(out, 12, 3) ? 12 : 0;
+}
+
+size_t lonlat_validator(string_view in, char* out) {
+  if (in.find_first_not_of("1234567890.") != string_view::npos)
+    return 0;
+  int v = 0;
+  const char* b = in.data();
+  const char* e = in.data() + in.size();
+  while (b < e && *b != '.') {
+    v *= 10;
+    v += *b++ - '0';
   }
-  default:
+  if (v >= 180 || v <= 0)
+    return 0;
+  memcpy(out, in.data(), in.size());
+  return in.size();
+}
+
+size_t idfx_validator(string_view in, char* out) {
+  memcpy(out, in.data(), in.size());
+  if (!padded_check(out, in.size(), HEX_DASH))
+    return 0;
+  if (in.size() == 32)
+    return in.size();
+  if (in.size() <= 23)
+    return 0;
+  return in[8] == in[13] && in[18] == in[23] && in[23] == in[8] ? in.size() : 0;
+}
+
+size_t email_validator(string_view in, char* out) {
+  if (in.find_first_not_of(
+      "1234567890"
+      "abcdefghijklmnopqrstuvwxyz"
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+      "@_-.") != string_view::npos)
+    return 0;
+  memcpy(out, in.data(), in.size());
+  return in.size();
+}
+
+// Bridges a Validator to the legacy Filter signature.
+template <Validator V>
+bool legacy_filter(std::string* s) {
+  char buf[kValidateBufferSize];
+  size_t n = Validate(V, *s, buf);
+  if (n == 0)
     return false;
-  }
+  s->assign(buf, n);
+  return true;
 }
 
 bool IsOutofChina(double lon, double lat) {
@@ -702,27 +876,6 @@ double TransformLng(double x, double y) {
   return ret;
 }
 
-bool Transform(double f_lon, double f_lat, double* t_lon, double* t_lat) {
-  if (IsOutofChina(f_lon, f_lat))
-    return false;
-
-  double l_dLat = TransformLat(f_lon - 105.0, f_lat - 35.0);
-  double l_dLng = TransformLng(f_lon - 105.0, f_lat - 35.0);
-  double l_radLat = f_lat / 180.0 * COORD_PI;
-  double l_magic = sin(l_radLat);
-  l_magic = 1 - COORD_ECCENTRICITY * l_magic * l_magic;
-  double l_sqrtMagic = sqrt(l_magic);
-  l_dLat = (l_dLat * 180.0)
-      / ((COORD_A * (1 - COORD_ECCENTRICITY)) / (l_magic * l_sqrtMagic)
-          * COORD_PI);
-  l_dLng = (l_dLng * 180.0)
-      / (COORD_A / l_sqrtMagic * cos(l_radLat) * COORD_PI);
-
-  *t_lon = f_lon + l_dLng;
-  *t_lat = f_lat + l_dLat;
-  return true;
-}
-
 bool WGS84ToGCJ02(double f_lon, double f_lat, double* t_lon, double* t_lat) {
   if (IsOutofChina(f_lon, f_lat))
     return false;
@@ -760,22 +913,22 @@ bool GCJ02ToBD09(double f_lon, double f_lat, double* t_lon, double* t_lat) {
 }
 
 bool WGS84ToBD09(double f_lon, double f_lat, double* t_lon, double* t_lat) {
-  return !WGS84ToGCJ02(f_lon, f_lat, t_lon, t_lat)
-      ? GCJ02ToBD09(f_lon, f_lat, t_lon, t_lat) : false;
+  double x, y;
+  return WGS84ToGCJ02(f_lon, f_lat, &x, &y) &&
+         GCJ02ToBD09(x, y, t_lon, t_lat);
 }
 
+// GCJ02 shifts a point by an offset that hardly varies nearby, so the
+// shift computed at the GCJ02 point is taken back off it.
 bool GCJ02ToWGS84(double f_lon, double f_lat, double* t_lon, double* t_lat) {
-  Transform(f_lon, f_lat, &f_lon, &f_lat);
-  *t_lon = f_lon * 2 - f_lon;
-  *t_lat = f_lat * 2 - f_lat;
-  return true;
-}
-
-bool GCJ02ToBd09(double f_lon, double f_lat, double *t_lon, double *t_lat) {
-  double z = sqrt(f_lon * f_lon + f_lat * f_lat) + 0.00002 * sin(f_lat * COORD_PI);
-  double theta = atan2(f_lat, f_lon) + 0.000003 * cos(f_lon * COORD_PI);
-  *t_lon = z * cos(theta) + 0.0065;
-  *t_lat = z * sin(theta) + 0.006;
+  double x, y;
+  if (!WGS84ToGCJ02(f_lon, f_lat, &x, &y)) {
+    *t_lon = f_lon;
+    *t_lat = f_lat;
+    return true;
+  }
+  *t_lon = f_lon * 2 - x;
+  *t_lat = f_lat * 2 - y;
   return true;
 }
 
@@ -870,15 +1023,6 @@ bool MapBarToWGS84(double f_lon, double f_lat, double* t_lon, double* t_lat) {
   return true;
 }
 
-bool MapBarToBD09(double f_lon, double f_lat, double* t_lon, double* t_lat) {
-  double x, y;
-  if (MapBarToWGS84(f_lon, f_lat, &x, &y) &&
-      WGS84ToGCJ02(x, y, &f_lon, &f_lat)) {
-    return GCJ02ToBd09(f_lon, f_lat, t_lon, t_lat);
-  }
-  return false;
-}
-
 bool MercatorToWGS84(double f_lon, double f_lat, double* t_lon, double* t_lat) {
   *t_lon = f_lon / 20037508.34 * 180;
   *t_lat = f_lat / 20037508.34 * 180;
@@ -886,62 +1030,107 @@ bool MercatorToWGS84(double f_lon, double f_lat, double* t_lon, double* t_lat) {
   return true;
 }
 
-bool CoordinateTranslateImpl(
-    Coordinate::Type from, double f_lon, double f_lat,
-    Coordinate::Type to, double* to_lon, double* to_lat) {
-  typedef bool (*Translater)(double, double, double*, double*);
-  static const Translater translaters[Coordinate::Type::UNKNOWN][Coordinate::Type::UNKNOWN] = {
-  /* from\to */ /* WGS84            GCJ02         BD09          MERCATOR        MAPBAR  SOUGOU */
-  /* WGS84    */ { NULL,            WGS84ToGCJ02, WGS84ToBD09,  WGS84ToMercator,NULL,   NULL },
-  /* GCJ02    */ { GCJ02ToWGS84,    NULL,         GCJ02ToBd09,  NULL,           NULL,   NULL },
-  /* BD09     */ { BD09ToWGS84,     BD09ToGCJ02,  NULL,         NULL,           NULL,   NULL },
-  /* MERCATOR */ { MercatorToWGS84, NULL,         NULL,         NULL,           NULL,   NULL },
-  /* MAPBAR   */ { MapBarToWGS84,   NULL,         MapBarToBD09, NULL,           NULL,   NULL },
-  /* SOUGOU   */ { SogouToWGS84,    NULL,         NULL,         NULL,           NULL,   NULL },
-  };
-
-  return (translaters[from][to])
-      ? (translaters[from][to])(f_lon, f_lat, to_lon, to_lat) : false;
+bool Identity(double f_lon, double f_lat, double* t_lon, double* t_lat) {
+  *t_lon = f_lon;
+  *t_lat = f_lat;
+  return true;
 }
 
-bool lonlat_filter(std::string* s) {
-  assert(!s->empty());
-  auto pos = s->find_first_not_of("1234567890.");
-  if (pos != std::string::npos)
-    return false;
-  int v = 0;
-  const char* b = s->data();
-  const char* e = s->data() + s->size();
-  while (b < e && *b != '.') {
-    v *= 10;
-    v += *b++ - '0';
-  }
-  return v < 180 && v > 0;
-}
+typedef bool (*Translater)(double, double, double*, double*);
 
-bool idfx_filter(std::string* s) {
-  assert(!s->empty());
-  auto pos = s->find_first_not_of("1234567890abcdefABCDEF-");
-  if (pos != std::string::npos)
-    return false;
-  if (s->size() == 32)
+const Translater kTranslaters[Coordinate::Type::UNKNOWN][Coordinate::Type::UNKNOWN] = {
+/* from\to */ /* WGS84            GCJ02         BD09          MERCATOR         MAPBAR    SOUGOU */
+/* WGS84    */ { Identity,        WGS84ToGCJ02, WGS84ToBD09,  WGS84ToMercator, NULL,     NULL },
+/* GCJ02    */ { GCJ02ToWGS84,    Identity,     GCJ02ToBD09,  NULL,            NULL,     NULL },
+/* BD09     */ { BD09ToWGS84,     BD09ToGCJ02,  Identity,     NULL,            NULL,     NULL },
+/* MERCATOR */ { MercatorToWGS84, NULL,         NULL,         Identity,        NULL,     NULL },
+/* MAPBAR   */ { MapBarToWGS84,   NULL,         NULL,         NULL,            Identity, NULL },
+/* SOUGOU   */ { SogouToWGS84,    NULL,         NULL,         NULL,            NULL,     Identity },
+};
+
+// Pairs without a translater of their own go through WGS84, second is
+// NULL when the pair has one. Returns false if either leg is missing.
+bool ResolveTranslaters(Coordinate::Type from, Coordinate::Type to,
+                        Translater* first, Translater* second) {
+  *first = kTranslaters[from][to];
+  *second = NULL;
+  if (*first)
     return true;
-  return (*s)[8] == (*s)[13] &&
-         (*s)[18] == (*s)[23] &&
-         (*s)[23] == (*s)[8];
+  *first = kTranslaters[from][Coordinate::Type::WGS84];
+  *second = kTranslaters[Coordinate::Type::WGS84][to];
+  return *first && *second;
 }
 
-bool email_filter(std::string* s) {
-  assert(!s->empty());
-  return s->find_first_not_of(
-      "1234567890"
-      "abcdefghijklmnopqrstuvwxyz"
-      "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-      "@_-.") == std::string::npos;
+// Parses the digits and dot lonlat_validator lets through. Up to 15
+// significant digits the mantissa and the power of ten are both exact
+// doubles and one division rounds correctly, longer values go to strtod.
+bool ParseCoordinate(const std::string& s, double* v) {
+  static const double kPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+    1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+  };
+  uint64_t mantissa = 0;
+  int digits = 0, scale = -1;
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (ascii_digit(s[i])) {
+      mantissa = mantissa * 10 + (s[i] - '0');
+      ++digits;
+      if (scale >= 0)
+        ++scale;
+    } else if (s[i] == '.' && scale < 0) {
+      scale = 0;
+    } else {
+      digits = 16;
+      break;
+    }
+  }
+  if (digits > 0 && digits <= 15) {
+    *v = static_cast<double>(mantissa) / kPow10[scale < 0 ? 0 : scale];
+    return true;
+  }
+
+  const char* b = s.c_str();
+  char* e = NULL;
+  *v = strtod(b, &e);
+  return e != b;
 }
 
 } // anonymous namespace
 
+size_t FormatCoordinate(double v, char* out) {
+  // v * 1e6 is rounded in binary, fma gives what it's rounded off by, so
+  // the exact product is rounded to the nearest integer as printf does.
+  // An exact tie is left to printf, which breaks it to even.
+  double x = fabs(v) * 1e6;
+  double err = std::fma(fabs(v), 1e6, -x);
+  double integral = floor(x);
+  double above_half = (x - integral - 0.5) + err;
+  if (!(fabs(v) < 1e12) || above_half == 0) {
+    int n = snprintf(out, kCoordinateBufferSize, "%f", v);
+    return std::min(static_cast<size_t>(n), kCoordinateBufferSize - 1);
+  }
+  char* p = out;
+  if (std::signbit(v))
+    *p++ = '-';
+  uint64_t scaled = static_cast<uint64_t>(integral) + (above_half > 0);
+  uint64_t integer = scaled / 1000000;
+  uint64_t fraction = scaled % 1000000;
+  char digits[24];
+  int n = 0;
+  do {
+    digits[n++] = '0' + integer % 10;
+    integer /= 10;
+  } while (integer != 0);
+  while (n > 0)
+    *p++ = digits[--n];
+  *p++ = '.';
+  for (int i = 5; i >= 0; --i) {
+    p[i] = '0' + fraction % 10;
+    fraction /= 10;
+  }
+  return p + 6 - out;
+}
+
 bool CoordinateTranslate(
     Coordinate::Type from, const std::string& f_lon, const std::string& f_lat,
     Coordinate::Type to, std::string* to_lon, std::string* to_lat) {
@@ -949,39 +1138,65 @@ bool CoordinateTranslate(
       from != Coordinate::Type::UNKNOWN &&
       to != Coordinate::Type::UNKNOWN);
 
-  double longitude, latitude;
-  bool ret = CoordinateTranslateImpl(from, std::stod(f_lon), std::stod(f_lat),
-                                     to, &longitude, &latitude);
-  if (ret) {
-    *to_lon = std::to_string(static_cast<long double>(longitude));
-    *to_lat = std::to_string(static_cast<long double>(latitude));
+  Translater first, second;
+  if (!ResolveTranslaters(from, to, &first, &second))
+    return false;
+  double lon, lat;
+  if (!ParseCoordinate(f_lon, &lon) || !ParseCoordinate(f_lat, &lat))
+    return false;
+  if (!first(lon, lat, &lon, &lat) ||
+      (second && !second(lon, lat, &lon, &lat))) {
+    return false;
   }
-  return ret;
+
+  char buf[kCoordinateBufferSize];
+  to_lon->assign(buf, FormatCoordinate(lon, buf));
+  to_lat->assign(buf, FormatCoordinate(lat, buf));
+  return true;
 }
 
 int MakeType(const std::string& key) {
-  static const std::unordered_map<std::string, int> map{
-#define XX(key, type) { #key, type },
+  // A key listed twice or two keys sharing a hash break the build with
+  // duplicate case labels, so one string compare confirms the match.
+  switch (fnv1a(key.c_str())) {
+#define XX(name, type) \
+  case fnv1a(#name): return key == #name ? type : KeyType::UNKNOWN;
     KEY_TYPE_MAP(XX)
 #undef XX
+  default: return KeyType::UNKNOWN;
+  }
+}
+
+Validator ValidatorFactory(int type) {
+  static const std::unordered_map<int, Validator> validators{
+    { KeyType::PHONE,     phone_validator  },
+    { KeyType::IMEI,      imei_validator   },
+    { KeyType::IMSI,      imsi_validator   },
+    { KeyType::MAC,       mac_validator    },
+    { KeyType::LONGITUDE, lonlat_validator },
+    { KeyType::LATITUDE,  lonlat_validator },
+    { KeyType::IDFX,      idfx_validator   },
+    { KeyType::EMAIL,     email_validator  },
+    { KeyType::CITYCODE,  city_code_validator },
   };
 
-  auto iter = map.find(key);
-  if (iter != map.end())
+  auto iter = validators.find(type);
+  if (iter != validators.end())
     return iter->second;
-  return KeyType::UNKNOWN;
+  return NULL;
 }
 
 Filter FilterFactory(int type) {
   static const std::unordered_map<int, Filter> filters{
-    { KeyType::PHONE,     phone_filter  },
-    { KeyType::IMEI,      imei_filter   },
-    { KeyType::IMSI,      imsi_filter   },
-    { KeyType::MAC,       mac_filter    },
-    { KeyType::LONGITUDE, lonlat_filter },
-    { KeyType::LATITUDE,  lonlat_filter },
-    { KeyType::IDFX,      idfx_filter   },
-    { KeyType::EMAIL,     email_filter  },
+    { KeyType::PHONE,     legacy_filter<phone_validator>  },
+    { KeyType::IMEI,      legacy_filter<imei_validator>   },
+    { KeyType::IMSI,      legacy_filter<imsi_validator>   },
+    { KeyType::MAC,       legacy_filter<mac_validator>    },
+    { KeyType::LONGITUDE, legacy_filter<lonlat_validator> },
+    { KeyType::LATITUDE,  legacy_filter<lonlat_validator> },
+    { KeyType::IDFX,      legacy_filter<idfx_validator>   },
+    { KeyType::EMAIL,     legacy_filter<email_validator>  },
+    { KeyType::CITYCODE,  legacy_filter<city_code_validator> },
   };
 
   auto iter = filters.find(type);
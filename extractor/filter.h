@@ -5,6 +5,7 @@
 
 #include <string>
 #include "extractor/rule_define.h"
+#include "extractor/third_party/string_view.h"
 
 namespace ext {
 enum KeyType {
@@ -24,6 +25,26 @@ enum KeyType {
 // Format and check value valid
 typedef bool (*Filter)(std::string*);
 
+// Longest value a Validator accepts.
+const size_t kValidateMaxLength = 256;
+
+// Size of the buffer a Validator writes into, it's larger than
+// kValidateMaxLength so the checks can pad the value to whole vectors.
+const size_t kValidateBufferSize = kValidateMaxLength + 32;
+
+// Checks value valid and writes its formatted form into out, which holds
+// kValidateBufferSize bytes. Returns the formatted length, 0 if invalid.
+// Validators never allocate; call them through Validate().
+typedef size_t (*Validator)(string_view in, char* out);
+
+// Runs the validator, values that are empty or longer than
+// kValidateMaxLength are invalid.
+inline size_t Validate(Validator v, string_view in, char* out) {
+  if (in.empty() || in.size() > kValidateMaxLength)
+    return 0;
+  return v(in, out);
+}
+
 // Returns an number in relation to the key.
 int MakeType(const std::string& key);
 
@@ -31,10 +52,23 @@ int MakeType(const std::string& key);
 // that in relation to the key.
 Filter FilterFactory(int type);
 
+// Returns the validator for the type, NULL if the type has none.
+Validator ValidatorFactory(int type);
+
+// Translates a coordinate in decimal text, pairs without a translation of
+// their own go through WGS84. The results have six decimals as
+// FormatCoordinate writes them.
 bool CoordinateTranslate(
     Coordinate::Type from, const std::string& f_lon, const std::string& f_lat,
     Coordinate::Type to, std::string* to_lon, std::string* to_lat);
 
+const size_t kCoordinateBufferSize = 64;
+
+// Writes v as "%f" does, six decimals rounded the same way, without going
+// through printf for the usual values. out holds kCoordinateBufferSize
+// bytes, returns the length written.
+size_t FormatCoordinate(double v, char* out);
+
 } // namespace ext
 
 #endif // EXTRACTOR_FILTER_H_
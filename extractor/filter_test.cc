@@ -3,6 +3,9 @@
 #include <iostream>
 #include <cassert>
 #include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
 #include "extractor/filter.h"
 
 using namespace ext;
@@ -16,7 +19,162 @@ void TestCase(const char* key, std::string s, bool expect) {
   std::cout << s << std::endl;
 }
 
+void ValidateCase(const char* key, const std::string& s, const char* expect) {
+  auto func = ValidatorFactory(MakeType(key));
+  assert(func);
+  char buf[kValidateBufferSize];
+  size_t n = Validate(func, s, buf);
+  if (expect) {
+    assert(std::string(buf, n) == expect);
+  } else {
+    assert(n == 0);
+  }
+
+  // The legacy filter is a shim over the validator.
+  std::string legacy(s);
+  bool ret = !legacy.empty() && FilterFactory(MakeType(key))(&legacy);
+  assert(ret == (expect != NULL));
+  if (ret)
+    assert(legacy == expect);
+}
+
+void ValidatorTestCase() {
+  ValidateCase("PHONENUM", "13812345678", "13812345678");
+  ValidateCase("PHONENUM", "+86 138-1234-5678", "13812345678");
+  ValidateCase("PHONENUM", "08613812345678", "13812345678");
+  ValidateCase("PHONENUM", "12812345678", NULL);
+  ValidateCase("PHONENUM", "86", NULL);
+  ValidateCase("PHONENUM", "", NULL);
+  ValidateCase("PHONENUM", std::string(kValidateMaxLength + 1, '1'), NULL);
+  ValidateCase("APP_IMSI", "460087495038274", "460087495038274");
+  ValidateCase("APP_IMSI", "460307495038274", NULL);
+  ValidateCase("APP_IMSI", "310307495038274", "310307495038274");
+  ValidateCase("APP_IMSI", "999087495038274", NULL);
+  ValidateCase("APP_IMEI", "A2008749503827", "A2008749503827");
+  ValidateCase("APP_IMEI", "A200874950382G", NULL);
+  ValidateCase("APP_MAC", "A0:B1:C2:D3:E4:F5", "a0b1c2d3e4f5");
+  ValidateCase("APP_MAC", "a0b1000000f5", NULL);
+  ValidateCase("APP_IDFA", "6D92078A-8246-4BA4-AE5B-76104861E7DC",
+               "6D92078A-8246-4BA4-AE5B-76104861E7DC");
+  ValidateCase("APP_IDFA", "6D92078A82464BA4AE5B76104861E7DC",
+               "6D92078A82464BA4AE5B76104861E7DC");
+  ValidateCase("APP_IDFA", "6D92078A-8246", NULL);
+  ValidateCase("APP_LONGITUDE", "116.397128", "116.397128");
+  ValidateCase("EMAIL", "a b@c.com", NULL);
+
+  // A bad byte anywhere in the value, across the vector boundary.
+  for (size_t i = 0; i < 15; ++i) {
+    std::string imei("358240051111110");
+    ValidateCase("APP_IMEI", imei, imei.c_str());
+    imei[i] = static_cast<char>(i & 1 ? '/' : 0xb9);
+    ValidateCase("APP_IMEI", imei, NULL);
+  }
+}
+
+void MakeTypeTestCase() {
+  assert(MakeType("APP_MAC") == KeyType::MAC);
+  assert(MakeType("WIFI_MAC") == KeyType::MAC);
+  assert(MakeType("REGISTER_PHONE") == KeyType::PHONE);
+  assert(MakeType("TAOBAO_ACCOUNT") == KeyType::UNKNOWN);
+  assert(MakeType("APP_MA") == KeyType::UNKNOWN);
+  assert(MakeType("") == KeyType::UNKNOWN);
+}
+
+void CityCodeTestCase() {
+  auto func = ValidatorFactory(KeyType::CITYCODE);
+  assert(func);
+  char buf[kValidateBufferSize];
+  assert(Validate(func, "110101", buf) == 6);
+  assert(Validate(func, "659006", buf) == 6);
+  assert(Validate(func, "820000", buf) == 6);
+  assert(Validate(func, "110103", buf) == 0);
+  assert(Validate(func, "659005", buf) == 0);
+  assert(Validate(func, "11010", buf) == 0);
+  assert(Validate(func, "11010a", buf) == 0);
+
+  // The tables hold the codes of city_code.list and no other.
+  static const char* const codes[] = {
+#include "extractor/city_code.list"
+  };
+  const size_t n = sizeof(codes) / sizeof(codes[0]);
+  assert(n == 3137);
+  size_t j = 0;
+  for (int i = 0; i < 1000000; ++i) {
+    char code[8];
+    snprintf(code, sizeof(code), "%06d", i);
+    bool listed = j < n && strcmp(codes[j], code) == 0;
+    if (listed)
+      ++j;
+    assert((Validate(func, string_view(code, 6), buf) != 0) == listed);
+  }
+  assert(j == n);
+}
+
+void CoordinateTestCase() {
+  std::string lon, lat;
+  assert(CoordinateTranslate(Coordinate::WGS84, "116.397128", "39.916527",
+                             Coordinate::GCJ02, &lon, &lat));
+  assert(lon == "116.403372" && lat == "39.917931");
+  assert(CoordinateTranslate(Coordinate::WGS84, "116.397128", "39.916527",
+                             Coordinate::BD09, &lon, &lat));
+  assert(lon == "116.409832" && lat == "39.924033");
+  assert(!CoordinateTranslate(Coordinate::WGS84, "2.294481", "48.858370",
+                              Coordinate::GCJ02, &lon, &lat));
+  assert(!CoordinateTranslate(Coordinate::WGS84, "116.397128", "39.916527",
+                              Coordinate::SOUGOU, &lon, &lat));
+
+  // Mercator has no translation to BD09 of its own, it goes via WGS84.
+  assert(CoordinateTranslate(Coordinate::MERCATOR, "12957269.016956", "4853819.613934",
+                             Coordinate::BD09, &lon, &lat));
+  assert(lon == "116.409832" && lat == "39.924033");
+
+  // Translating there and back lands close to the start.
+  srand(1);
+  for (size_t i = 0; i < 1000; ++i) {
+    double x = 100 + rand() % 2000000 / 1e5;
+    double y = 25 + rand() % 1500000 / 1e5;
+    char f_lon[32], f_lat[32];
+    snprintf(f_lon, sizeof(f_lon), "%.5f", x);
+    snprintf(f_lat, sizeof(f_lat), "%.5f", y);
+    std::string t_lon, t_lat;
+    assert(CoordinateTranslate(Coordinate::WGS84, f_lon, f_lat,
+                               Coordinate::BD09, &t_lon, &t_lat));
+    assert(CoordinateTranslate(Coordinate::BD09, t_lon, t_lat,
+                               Coordinate::WGS84, &lon, &lat));
+    assert(fabs(atof(lon.c_str()) - x) < 5e-5 &&
+           fabs(atof(lat.c_str()) - y) < 5e-5);
+  }
+}
+
+void FormatCoordinateTestCase() {
+  char buf[kCoordinateBufferSize], expected[kCoordinateBufferSize];
+  const double values[] = {
+    -82.8217785, 116.4098325, 0.0000005, 0.0000015, -0.0, 0, 1e-7, -1e-7,
+    999999.9999995, 1e11 + 0.5, 1e12, -1e300, 2.5, 0.125, 1.0 / 3,
+  };
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+    snprintf(expected, sizeof(expected), "%f", values[i]);
+    assert(std::string(buf, FormatCoordinate(values[i], buf)) == expected);
+  }
+  assert(std::string(buf, FormatCoordinate(-82.8217785, buf)) == "-82.821778");
+
+  // Coordinates with seven decimals are the ones printf rounds off a tie.
+  srand(37);
+  for (int i = 0; i < 1000000; ++i) {
+    double v = (rand() % 1800000000) / 1e7 * (rand() % 2 ? 1 : -1);
+    if (i % 2)
+      v = (rand() - RAND_MAX / 2) / 1e4 + rand() / (RAND_MAX + 1.0);
+    snprintf(expected, sizeof(expected), "%f", v);
+    assert(std::string(buf, FormatCoordinate(v, buf)) == expected);
+  }
+}
+
 int main() {
+  ValidatorTestCase();
+  CoordinateTestCase();
+  FormatCoordinateTestCase();
+  MakeTypeTestCase();
+  CityCodeTestCase();
   TestCase("APP_IMSI", "460087495038274", true);
   TestCase("APP_IMEI", "99008749503827", true);
   TestCase("APP_IMEI", "980087495038277", true);
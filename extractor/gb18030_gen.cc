@@ -0,0 +1,86 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+// Generates gb18030.inline.h, the two-byte GB18030 table of codec.cc,
+// from the iconv of glibc:
+//
+//   make gb18030_gen && ./gb18030_gen > gb18030.inline.h
+//
+// The table in the tree was generated with glibc 2.36. With `-gbk' it
+// lists the two-byte sequences that GBK lacks besides the ones mapped to
+// the private use area instead, which gbk_lacks() of codec.cc spells out.
+
+#include <iconv.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+// Converts the sequence to a code point, 0 if iconv fails on it or it's
+// not a single character of the BMP.
+uint32_t convert(iconv_t cd, unsigned int lead, unsigned int trail) {
+  char in[2] = {static_cast<char>(lead), static_cast<char>(trail)};
+  char out[8];
+  char* p = in;
+  char* q = out;
+  size_t in_left = sizeof(in);
+  size_t out_left = sizeof(out);
+  iconv(cd, NULL, NULL, NULL, NULL);
+  if (iconv(cd, &p, &in_left, &q, &out_left) == static_cast<size_t>(-1) ||
+      in_left != 0 || q - out != 4) {
+    return 0;
+  }
+  uint32_t cp;
+  memcpy(&cp, out, sizeof(cp));
+  return cp <= 0xFFFF ? cp : 0;
+}
+
+bool private_use(uint32_t cp) {
+  return cp >= 0xE000 && cp <= 0xF8FF;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+  bool gbk = argc == 2 && strcmp(argv[1], "-gbk") == 0;
+  iconv_t gb18030 = iconv_open("UTF-32LE", "GB18030");
+  iconv_t gbk_cd = iconv_open("UTF-32LE", "GBK");
+  if (gb18030 == reinterpret_cast<iconv_t>(-1) ||
+      gbk_cd == reinterpret_cast<iconv_t>(-1)) {
+    fprintf(stderr, "iconv_open failed\n");
+    return 1;
+  }
+
+  size_t n = 0;
+  unsigned int first = 0, last = 0;
+  for (unsigned int lead = 0x81; lead <= 0xFE; ++lead) {
+    for (unsigned int trail = 0x40; trail <= 0xFE; ++trail) {
+      uint32_t cp = convert(gb18030, lead, trail);
+      if (!gbk) {
+        printf("0x%04X,", cp);
+        if (++n % 12 == 0)
+          printf("\n");
+        continue;
+      }
+
+      // The ranges of the sequences GBK lacks.
+      unsigned int code = lead << 8 | trail;
+      if (cp != 0 && !private_use(cp) && convert(gbk_cd, lead, trail) != cp) {
+        if (first != 0 && code == last + 1) {
+          last = code;
+          continue;
+        }
+        if (first != 0)
+          printf("0x%04X-0x%04X\n", first, last);
+        first = last = code;
+      }
+    }
+  }
+  if (!gbk && n % 12 != 0)
+    printf("\n");
+  if (gbk && first != 0)
+    printf("0x%04X-0x%04X\n", first, last);
+
+  iconv_close(gb18030);
+  iconv_close(gbk_cd);
+  return 0;
+}
@@ -0,0 +1,280 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include "extractor/http_head.h"
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EXTRACTOR_X86 1
+#endif
+
+namespace ext {
+namespace {
+// Returns the first byte of [p, end) that can't be in a URL or a header
+// value, which ends it, or `end'.
+typedef const char* (*ScanFunc)(const char* p, const char* end);
+
+// URLs are printable ASCII, `?' and `#' included.
+inline bool url_char(unsigned char c) {
+  return c > 0x20 && c < 0x7f;
+}
+
+// Header values take HT and every byte but the other controls, as
+// http_parser does.
+inline bool value_char(unsigned char c) {
+  return c == '\t' || (c > 0x1f && c != 0x7f);
+}
+
+// The token characters of header names.
+inline bool token_char(unsigned char c) {
+  if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+      (c >= 'A' && c <= 'Z')) {
+    return true;
+  }
+  return c != 0 && strchr("!#$%&'*+-.^_`|~", c) != NULL;
+}
+
+const char* url_scan(const char* p, const char* end) {
+  while (p < end && url_char(*p))
+    ++p;
+  return p;
+}
+
+const char* value_scan(const char* p, const char* end) {
+  while (p < end && value_char(*p))
+    ++p;
+  return p;
+}
+
+#ifdef EXTRACTOR_X86
+// The byte ranges that end a URL and a header value, as PCMPESTRI takes
+// them.
+const char kUrlRanges[16] = "\x00\x20\x7f\xff";
+const int kUrlRangesSize = 4;
+const char kValueRanges[16] = "\x00\x08\x0a\x1f\x7f\x7f";
+const int kValueRangesSize = 6;
+
+__attribute__((target("sse4.2")))
+const char* ranges_scan_sse42(const char* ranges, int size,
+                              const char* p, const char* end) {
+  const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ranges));
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    int i = _mm_cmpestri(r, size, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                                         _SIDD_LEAST_SIGNIFICANT);
+    if (i != 16)
+      return p + i;
+    p += 16;
+  }
+  return p;
+}
+
+__attribute__((target("sse4.2")))
+const char* url_scan_sse42(const char* p, const char* end) {
+  return url_scan(ranges_scan_sse42(kUrlRanges, kUrlRangesSize, p, end), end);
+}
+
+__attribute__((target("sse4.2")))
+const char* value_scan_sse42(const char* p, const char* end) {
+  return value_scan(ranges_scan_sse42(kValueRanges, kValueRangesSize, p, end),
+                    end);
+}
+
+__attribute__((target("avx2")))
+const char* url_scan_avx2(const char* p, const char* end) {
+  const __m256i bang = _mm256_set1_epi8('!');
+  const __m256i del = _mm256_set1_epi8(0x7f);
+  while (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    // The bytes from 0x80 are negative, so they're below `!' too.
+    unsigned int mask = _mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_cmpgt_epi8(bang, v),
+                        _mm256_cmpeq_epi8(v, del)));
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+    p += 32;
+  }
+  return url_scan_sse42(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* value_scan_avx2(const char* p, const char* end) {
+  const __m256i us = _mm256_set1_epi8(0x1f);
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i del = _mm256_set1_epi8(0x7f);
+  while (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i ctl = _mm256_cmpeq_epi8(_mm256_max_epu8(v, us), us);
+    ctl = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab), ctl);
+    unsigned int mask = _mm256_movemask_epi8(
+        _mm256_or_si256(ctl, _mm256_cmpeq_epi8(v, del)));
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+    p += 32;
+  }
+  return value_scan_sse42(p, end);
+}
+#endif
+
+ScanFunc resolve_url_scan() {
+#ifdef EXTRACTOR_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return url_scan_avx2;
+  if (__builtin_cpu_supports("sse4.2"))
+    return url_scan_sse42;
+#endif
+  return url_scan;
+}
+
+ScanFunc resolve_value_scan() {
+#ifdef EXTRACTOR_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return value_scan_avx2;
+  if (__builtin_cpu_supports("sse4.2"))
+    return value_scan_sse42;
+#endif
+  return value_scan;
+}
+
+inline bool crlf(const char* p, const char* end) {
+  return end - p >= 2 && p[0] == '\r' && p[1] == '\n';
+}
+
+inline bool version(const char* p, const char* end) {
+  return end - p >= 8 && !memcmp(p, "HTTP/1.", 7) &&
+         (p[7] == '0' || p[7] == '1');
+}
+
+bool method(string_view s) {
+  static const char* const kMethods[] = {
+    "GET", "POST", "PUT", "HEAD", "DELETE", "OPTIONS", "PATCH",
+  };
+  for (size_t i = 0; i < sizeof(kMethods) / sizeof(kMethods[0]); ++i) {
+    if (s == kMethods[i])
+      return true;
+  }
+  return false;
+}
+
+bool name_is(string_view name, const char* lower) {
+  size_t n = strlen(lower);
+  return name.size() == n && !strncasecmp(name.data(), lower, n);
+}
+
+// Content-Length is digits and the spaces after them, the big ones are
+// left to http_parser.
+bool content_length(string_view s, uint64_t* length) {
+  size_t digits = 0;
+  while (digits < s.size() && s[digits] >= '0' && s[digits] <= '9')
+    ++digits;
+  if (digits == 0 || digits > 18)
+    return false;
+  for (size_t i = digits; i < s.size(); ++i) {
+    if (s[i] != ' ')
+      return false;
+  }
+  *length = 0;
+  for (size_t i = 0; i < digits; ++i)
+    *length = *length * 10 + (s[i] - '0');
+  return true;
+}
+
+} // anonymous namespace
+
+bool ParseHttpHead(const char* s, size_t n, bool request, HttpHead* head) {
+  static const ScanFunc url_scan_func = resolve_url_scan();
+  static const ScanFunc value_scan_func = resolve_value_scan();
+
+  const char* p = s;
+  const char* end = s + std::min(n, kHttpMaxHeadSize);
+  head->headers.clear();
+
+  // request or status line
+  if (request) {
+    const char* sp = static_cast<const char*>(memchr(p, ' ', end - p));
+    if (!sp || !method(string_view(p, sp - p)))
+      return false;
+    head->method = string_view(p, sp - p);
+    p = sp + 1;
+    if (p == end || *p != '/')
+      return false;
+    const char* url_end = url_scan_func(p, end);
+    if (url_end == end || *url_end != ' ')
+      return false;
+    head->url = string_view(p, url_end - p);
+    p = url_end + 1;
+    if (!version(p, end))
+      return false;
+    p += 8;
+  } else {
+    if (!version(p, end))
+      return false;
+    p += 8;
+    if (end - p < 4 || p[0] != ' ')
+      return false;
+    head->status = 0;
+    for (int i = 1; i < 4; ++i) {
+      if (p[i] < '0' || p[i] > '9')
+        return false;
+      head->status = head->status * 10 + (p[i] - '0');
+    }
+    p += 4;
+    if (p < end && *p == ' ')
+      p = value_scan_func(p + 1, end);
+  }
+  if (!crlf(p, end))
+    return false;
+  p += 2;
+
+  // header lines
+  bool has_length = false;
+  uint64_t length = 0;
+  while (!crlf(p, end)) {
+    const char* name = p;
+    while (p < end && token_char(*p))
+      ++p;
+    if (p == name || p == end || *p != ':')
+      return false;
+    HttpHead::Header header;
+    header.name = string_view(name, p - name);
+
+    ++p;
+    while (p < end && (*p == ' ' || *p == '\t'))
+      ++p;
+    const char* value = p;
+    p = value_scan_func(p, end);
+    if (!crlf(p, end))
+      return false;
+    header.value = string_view(value, p - value);
+    p += 2;
+    // folded lines
+    if (p < end && (*p == ' ' || *p == '\t'))
+      return false;
+
+    if (name_is(header.name, "content-length")) {
+      if (has_length || !content_length(header.value, &length))
+        return false;
+      has_length = true;
+    } else if (name_is(header.name, "transfer-encoding") ||
+               name_is(header.name, "upgrade")) {
+      return false;
+    }
+    head->headers.push_back(header);
+  }
+  p += 2;
+
+  // The body is what http_parser would take, the bytes after it are of
+  // the next message.
+  head->body = p - s;
+  size_t rest = n - head->body;
+  bool to_eof = !request && !has_length && head->status / 100 != 1 &&
+                head->status != 204 && head->status != 304;
+  head->body_size = to_eof ? rest : std::min<uint64_t>(rest, length);
+  return true;
+}
+
+} // namespace ext
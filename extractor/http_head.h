@@ -0,0 +1,51 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#ifndef EXTRACTOR_HTTP_HEAD_H_
+#define EXTRACTOR_HTTP_HEAD_H_
+
+#include <vector>
+
+#include "extractor/third_party/string_view.h"
+
+namespace ext {
+// The heads this parser takes are bounded well below the header limit of
+// http_parser, bigger ones are left to it.
+const size_t kHttpMaxHeadSize = 64 * 1024;
+
+// The HTTP/1.x head of a request or response, the spans point into the
+// message.
+struct HttpHead {
+  struct Header {
+    string_view name;
+    string_view value;
+  };
+
+  string_view method;   // request only
+  string_view url;      // request only
+  int status;           // response only
+  std::vector<Header> headers;
+  // Where the body starts, which is the size of the head, and how many
+  // bytes of it the buffer has. The message ends at `body + body_size',
+  // a pipelined one may follow.
+  size_t body;
+  size_t body_size;
+
+  HttpHead(): status(0), body(0), body_size(0) {}
+};
+
+// Parses the head of the first message of the buffer, which is found in
+// a pass over the request line and the header lines that scans them with
+// SSE4.2/AVX2 if the CPU has them, rather than byte by byte as
+// http_parser does.
+//
+// It takes the common shape of a message only and gives the same spans
+// as http_parser would, false is returned for the others, which are left
+// to http_parser: incomplete heads, lines that end in a bare LF or are
+// folded, methods other than GET/POST/PUT/HEAD/DELETE/OPTIONS/PATCH, URLs
+// that aren't paths, versions other than 1.0 and 1.1, Transfer-Encoding
+// and Upgrade headers, and malformed or repeated Content-Length headers.
+bool ParseHttpHead(const char* s, size_t n, bool request, HttpHead* head);
+
+} // namespace ext
+
+#endif // EXTRACTOR_HTTP_HEAD_H_
@@ -0,0 +1,341 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "extractor/http_head.h"
+#include "extractor/message.h"
+
+using namespace ext;
+
+std::string Str(string_view s) {
+  return std::string(s.data(), s.size());
+}
+
+bool Parse(const std::string& s, bool request, HttpHead* head) {
+  return ParseHttpHead(s.data(), s.size(), request, head);
+}
+
+void TestCaseRequest() {
+  std::string s =
+      "POST /login?uid=1#top HTTP/1.1\r\n"
+      "Host: example.com\r\n"
+      "X-Empty:\r\n"
+      "X-Trailing: \t a b  \r\n"
+      "Content-Length: 10  \r\n"
+      "\r\n"
+      "uid=123456";
+  HttpHead head;
+  assert(Parse(s, true, &head));
+  assert(Str(head.method) == "POST");
+  assert(Str(head.url) == "/login?uid=1#top");
+  assert(head.headers.size() == 4);
+  assert(Str(head.headers[0].name) == "Host");
+  assert(Str(head.headers[0].value) == "example.com");
+  assert(Str(head.headers[1].value) == "");
+  // leading spaces are skipped, trailing ones kept as http_parser does
+  assert(Str(head.headers[2].value) == "a b  ");
+  assert(head.body == s.size() - 10 && head.body_size == 10);
+
+  // a body that's cut short
+  assert(Parse(s.substr(0, s.size() - 4), true, &head));
+  assert(head.body_size == 6);
+  // no body at all
+  s = "GET / HTTP/1.0\r\n\r\n";
+  assert(Parse(s, true, &head));
+  assert(head.headers.empty() && head.body == s.size() && head.body_size == 0);
+
+  // the first of pipelined requests
+  assert(Parse(s + s, true, &head) && head.body + head.body_size == s.size());
+  s = "POST / HTTP/1.1\r\nContent-Length: 1\r\n\r\nab";
+  assert(Parse(s, true, &head) && head.body_size == 1);
+}
+
+void TestCaseResponse() {
+  std::string s = "HTTP/1.1 200 OK\r\nServer: x\r\n\r\nuntil the end";
+  HttpHead head;
+  assert(Parse(s, false, &head));
+  assert(head.status == 200 && head.headers.size() == 1);
+  assert(head.body_size == strlen("until the end"));
+
+  assert(Parse("HTTP/1.1 304\r\n\r\n", false, &head) && head.status == 304);
+  assert(Parse("HTTP/1.1 204 No Content\r\n\r\nextra", false, &head));
+  assert(head.body_size == 0);
+  assert(Parse("HTTP/1.0 404 Not Found\r\nContent-Length: 3\r\n\r\nabc",
+               false, &head));
+  assert(head.body_size == 3);
+}
+
+void TestCaseFallback() {
+  const char* requests[] = {
+    "GET / HTTP/1.1\r\nHost: a\r\n",                        // incomplete
+    "GET / HTTP/1.1\nHost: a\n\n",                          // bare LF
+    "GET / HTTP/1.1\r\nX: a\r\n b\r\n\r\n",                 // folded
+    "CONNECT a:443 HTTP/1.1\r\n\r\n",
+    "GET http://a/ HTTP/1.1\r\n\r\n",
+    "GET  / HTTP/1.1\r\n\r\n",
+    "GET / HTTP/2.0\r\n\r\n",
+    "GET /\r\n\r\n",
+    "GET / HTTP/1.1\r\nX : a\r\n\r\n",
+    "GET / HTTP/1.1\r\nX\x01: a\r\n\r\n",
+    "GET / HTTP/1.1\r\nX: a\x01\r\n\r\n",
+    "GET / HTTP/1.1\r\nX: a\rb\r\n\r\n",
+    "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n1\r\na\r\n0\r\n\r\n",
+    "GET / HTTP/1.1\r\nUpgrade: h2c\r\n\r\n",
+    "POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 1\r\n\r\na",
+    "POST / HTTP/1.1\r\nContent-Length: 1 1\r\n\r\na",
+    "POST / HTTP/1.1\r\nContent-Length: \r\n\r\n",
+    "POST / HTTP/1.1\r\nContent-Length: 1234567890123456789\r\n\r\n",
+  };
+  HttpHead head;
+  for (size_t i = 0; i < sizeof(requests) / sizeof(requests[0]); ++i)
+    assert(!Parse(requests[i], true, &head));
+
+  assert(!Parse("HTTP/1.1 20 OK\r\n\r\n", false, &head));
+  assert(!Parse("HTTP/1.1 200 OK\n\r\n", false, &head));
+
+  std::string big = "GET / HTTP/1.1\r\nX: " + std::string(kHttpMaxHeadSize, 'a') +
+                    "\r\n\r\n";
+  assert(!Parse(big, true, &head));
+}
+
+// Every byte of long URLs and values is looked at, whichever way they're
+// scanned.
+void TestCaseScan() {
+  HttpHead head;
+  for (size_t i = 0; i < 100; ++i) {
+    std::string url(100, 'u');
+    std::string value(100, 'v');
+    url[i] = '\x7f';
+    value[i] = '\x1f';
+    assert(!Parse("GET /" + url + " HTTP/1.1\r\n\r\n", true, &head));
+    assert(!Parse("GET / HTTP/1.1\r\nX: a" + value + "\r\n\r\n", true, &head));
+
+    url[i] = i % 2 ? '?' : '#';
+    value[i] = i % 2 ? '\t' : '\xe4';
+    std::string s = "GET /" + url + " HTTP/1.1\r\n\r\n";
+    assert(Parse(s, true, &head) && Str(head.url) == "/" + url);
+    s = "GET / HTTP/1.1\r\nX: a" + value + "\r\n\r\n";
+    assert(Parse(s, true, &head) && Str(head.headers[0].value) == "a" + value);
+  }
+}
+
+std::string Random(const char* chars, size_t n) {
+  std::string s;
+  size_t size = strlen(chars);
+  for (size_t i = 0; i < n; ++i)
+    s.push_back(chars[rand() % size]);
+  return s;
+}
+
+std::string RandomHeader() {
+  static const char* names[] = {
+    "Host", "host", "Cookie", "User-Agent", "Content-Length", "X-Id",
+    "Transfer-Encoding", "Accept", "X-Empty",
+  };
+  std::string name = names[rand() % 9];
+  std::string value = Random("abc =;%\t", rand() % 12);
+  if (name == "Content-Length")
+    value = std::to_string(rand() % 8);
+  if (name == "Transfer-Encoding")
+    value = "chunked";
+  if (rand() % 20 == 0)
+    value.push_back("\x01\x7f\x80 "[rand() % 4]);
+  std::string line = name + ":" + (rand() % 2 ? " " : "") + value;
+  line += rand() % 30 == 0 ? "\n" : "\r\n";
+  if (rand() % 30 == 0)
+    line += " folded\r\n";
+  return line;
+}
+
+std::string RandomMessage(bool request) {
+  static const char* methods[] = { "GET", "POST", "PATCH", "PURGE" };
+  std::string s;
+  if (request) {
+    s = methods[rand() % 4];
+    s += " /" + Random("ab?#&=%", rand() % 20) + " HTTP/1.1\r\n";
+  } else {
+    static const char* status[] = { "200 OK", "204 No Content", "304", "404" };
+    s = "HTTP/1.1 ";
+    s += status[rand() % 4];
+    s += "\r\n";
+  }
+  int n = rand() % 6;
+  for (int i = 0; i < n; ++i)
+    s += RandomHeader();
+  s += "\r\n" + Random("xyz", rand() % 10);
+  if (rand() % 10 == 0)
+    s += "GET / HTTP/1.1\r\nHost: b\r\n\r\n";
+  if (rand() % 10 == 0)
+    s.resize(rand() % s.size() + 1);
+  return s;
+}
+
+std::string Dump(const Message& msg) {
+  std::string s;
+  for (auto iter = msg.slices.begin(); iter != msg.slices.end(); ++iter) {
+    const Message::Slice& slice = iter->second;
+    if (slice.str.empty() && slice.headers.empty())
+      continue;
+    s += std::to_string(iter->first) + "[" + slice.str + "]";
+    for (size_t i = 0; i < slice.headers.size(); ++i) {
+      const Message::Slice::Header& h = slice.headers[i];
+      s += "<" + slice.str.substr(h.name, h.name_size) + ":" +
+           slice.str.substr(h.value, h.value_size) + ">";
+    }
+  }
+  return s;
+}
+
+std::string Body(const std::string& up, const std::string& down,
+                 Message::Slice::Type type) {
+  Message msg = MakeHttpMessage(up.data(), up.size(),
+                                down.data(), down.size());
+  return Slice(&msg, type).str;
+}
+
+// Chunked bodies are joined, the heads end where the first chunk starts.
+void TestCaseChunked() {
+  std::string up = "POST /upload HTTP/1.1\r\nHost: a\r\n"
+                   "Transfer-Encoding: chunked\r\n\r\n"
+                   "6\r\nphone=\r\n"
+                   "b;ext=1\r\n13812345678\r\n"
+                   "0\r\nX-Trailer: 1\r\n\r\n";
+  std::string down = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                     "2\r\n{}\r\n0\r\n\r\n";
+  assert(Body(up, down, Message::Slice::HTTP_REQ) == "phone=13812345678");
+  assert(Body(up, down, Message::Slice::HTTP_REQ_HEAD) ==
+         up.substr(0, up.find("6\r\n")));
+  assert(Body(up, down, Message::Slice::HTTP_RES) == "{}");
+
+  // as far as it goes
+  std::string cut = up.substr(0, up.find("345"));
+  assert(Body(cut, down, Message::Slice::HTTP_REQ) == "phone=13812");
+  // a pipelined request keeps its own body
+  std::string two = "POST / HTTP/1.1\r\nHost: a\r\nContent-Length: 2\r\n\r\nab"
+                    "POST / HTTP/1.1\r\nHost: a\r\nContent-Length: 2\r\n\r\ncd";
+  assert(Body(two, down, Message::Slice::HTTP_REQ) == "ab");
+}
+
+std::string Field(const char* mime, const char* fname,
+                  const std::string& payload) {
+  std::string len = std::to_string(payload.size());
+  std::string s = "\r\n\r\n----------------\r\n";
+  s.push_back(3);
+  s += std::string(1, 1) + char(strlen(mime)) + mime;
+  s += std::string(1, 2) + char(strlen(fname)) + fname;
+  s += std::string(1, 3) + char(len.size()) + len;
+  return s + "\r\n\r\n" + payload;
+}
+
+std::string Fhmf(const std::vector<std::string>& fields) {
+  std::string s = "FHMF";
+  s += std::string(1, 0) + char(1) + char(0) + char(fields.size());
+  for (size_t i = 0; i < fields.size(); ++i)
+    s += fields[i];
+  return s;
+}
+
+std::string Get(const Message& msg, Message::Slice::Type type) {
+  auto iter = msg.slices.find(type);
+  return iter == msg.slices.end() ? "" : iter->second.str;
+}
+
+// Requests and responses are paired in order, pipelined ones are split.
+void TestCaseProbeAll() {
+  std::string req1 = "GET /1 HTTP/1.1\r\nHost: a\r\n\r\n";
+  std::string req2 = "POST /2 HTTP/1.1\r\nHost: b\r\nContent-Length: 3\r\n"
+                     "\r\nuid";
+  std::string req3 = "POST /3 HTTP/1.1\r\nHost: c\r\n"
+                     "Transfer-Encoding: chunked\r\n\r\n1\r\nx\r\n0\r\n\r\n";
+  std::string res1 = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nr1";
+  std::string res2 = "HTTP/1.1 304\r\n\r\n";
+
+  std::string s = Fhmf({
+      Field("application/http", "Request.http", req1 + req2),
+      Field("application/http", "Response.http", res1 + res2),
+      Field("application/http", "Request.http", req3),
+      Field("application/tcp", "Request.tcp", "ping"),
+      Field("application/tcp", "Response.tcp", "pong"),
+      Field("application/http", "Response.http", res1),
+  });
+  std::vector<Message> msgs = ProbeAll(s.data(), s.size());
+  assert(msgs.size() == 4);
+  assert(Get(msgs[0], Message::Slice::HTTP_URL) == "/1");
+  assert(Get(msgs[0], Message::Slice::HTTP_REQ_HEAD) == req1);
+  assert(Get(msgs[0], Message::Slice::HTTP_RES) == "r1");
+  assert(Get(msgs[1], Message::Slice::HTTP_HOST) == "b");
+  assert(Get(msgs[1], Message::Slice::HTTP_REQ) == "uid");
+  assert(Get(msgs[1], Message::Slice::HTTP_RES_HEAD) == res2);
+  assert(Get(msgs[2], Message::Slice::HTTP_REQ) == "x");
+  assert(Get(msgs[2], Message::Slice::HTTP_RES) == "r1");
+  assert(msgs[3].type == Protocol::Type::TCP);
+  assert(Get(msgs[3], Message::Slice::BIN_REQ) == "ping");
+  assert(Get(msgs[3], Message::Slice::BIN_RES) == "pong");
+
+  // a response alone, and raw requests
+  s = Fhmf({ Field("application/http", "Response.http", res2) });
+  msgs = ProbeAll(s.data(), s.size());
+  assert(msgs.size() == 1 && Get(msgs[0], Message::Slice::HTTP_RES_HEAD) == res2);
+  s = req2 + req1 + req3;
+  msgs = ProbeAll(s.data(), s.size());
+  assert(msgs.size() == 3);
+  assert(Get(msgs[0], Message::Slice::HTTP_URL) == "/2");
+  assert(Get(msgs[1], Message::Slice::HTTP_URL) == "/1");
+  assert(Get(msgs[2], Message::Slice::HTTP_URL) == "/3");
+
+  // the first message only
+  Message msg = Probe(s.data(), s.size());
+  assert(Get(msg, Message::Slice::HTTP_URL) == "/2");
+  assert(Get(msg, Message::Slice::HTTP_REQ_HEAD) + "uid" == req2);
+}
+
+// The slices are the same as http_parser makes.
+void TestCaseProbe() {
+  srand(1);
+  int fast = 0;
+  for (int i = 0; i < 20000; ++i) {
+    std::string up = RandomMessage(true);
+    std::string down = RandomMessage(false);
+    HttpHead head;
+    if (Parse(up, true, &head))
+      ++fast;
+
+    g_fast_http_probe = true;
+    Message a = MakeHttpMessage(up.data(), up.size(), down.data(), down.size());
+    g_fast_http_probe = false;
+    Message b = MakeHttpMessage(up.data(), up.size(), down.data(), down.size());
+    if (Dump(a) != Dump(b)) {
+      std::cout << up << "\n--\n" << down << "\n--\n"
+                << Dump(a) << "\n" << Dump(b) << std::endl;
+      assert(false);
+    }
+
+    // and so are the ones of the pipelined requests
+    up += RandomMessage(true);
+    g_fast_http_probe = true;
+    std::vector<Message> all = ProbeAll(up.data(), up.size());
+    g_fast_http_probe = false;
+    std::vector<Message> slow = ProbeAll(up.data(), up.size());
+    assert(all.size() == slow.size());
+    for (size_t j = 0; j < all.size(); ++j)
+      assert(Dump(all[j]) == Dump(slow[j]));
+  }
+  g_fast_http_probe = true;
+  assert(fast > 1000);
+}
+
+int main() {
+  TestCaseRequest();
+  TestCaseResponse();
+  TestCaseFallback();
+  TestCaseScan();
+  TestCaseChunked();
+  TestCaseProbeAll();
+  TestCaseProbe();
+  return 0;
+}
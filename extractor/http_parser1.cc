@@ -19,6 +19,10 @@ namespace ext {
 typedef Message::Slice::Type SliceType;
 
 namespace {
+// Query, cookie and headers are always URL decoded.
+const CodecChain kUrlChain(std::vector<Codec::Type>(1, Codec::Type::URL));
+const CodecChain kRawChain;
+
 int find_by_wild(const std::vector<int>& wild_index,
                  const std::string& key,
                  const std::vector<Application>& apps) {
@@ -128,61 +132,82 @@ int HttpParser::Parse(Message* msg, RecordSet* res, Record* attrib) {
     ++tmp.appear;
 
     // codec
-    std::vector<Codec::Type> codec;
-    Message::Slice* slice;
+    const CodecChain* codec = &kUrlChain;
+    size_t reach = std::string::npos;
+    SliceType type;
     switch (rule.data_src) {
     case DataSource::Type::URL:
-      slice = &Slice(msg, SliceType::HTTP_QUERY);
-      codec.push_back(Codec::Type::URL);
+      type = SliceType::HTTP_QUERY;
       break;
     case DataSource::Type::COOKIE:
-      slice = &Slice(msg, SliceType::HTTP_COOKIE);
-      codec.push_back(Codec::Type::URL);
+      type = SliceType::HTTP_COOKIE;
       break;
     case DataSource::Type::REQ_HEAD:
-      slice = &Slice(msg, SliceType::HTTP_REQ_HEAD);
-      codec.push_back(Codec::Type::URL);
+      type = SliceType::HTTP_REQ_HEAD;
       break;
     case DataSource::Type::REQ_CONTENT:
-      slice = &Slice(msg, SliceType::HTTP_REQ);
-      codec = cate->req_codec;
+      type = SliceType::HTTP_REQ;
+      codec = &cate->req_codec;
+      reach = cate->req_reach;
       break;
     case DataSource::Type::RES_HEAD:
-      slice = &Slice(msg, SliceType::HTTP_RES_HEAD);
-      codec.push_back(Codec::Type::URL);
+      type = SliceType::HTTP_RES_HEAD;
       break;
     case DataSource::Type::RES_CONTENT:
-      slice = &Slice(msg, SliceType::HTTP_RES);
-      codec = cate->res_codec;
+      type = SliceType::HTTP_RES;
+      codec = &cate->res_codec;
+      reach = cate->res_reach;
       break;
     default: UNREACHABLE_CODE;
     }
 
-    if (slice->str.empty())
+    if (Slice(msg, type).str.empty())
       continue;
-    if (!slice->codec) {
-      int ret = Codecode(codec, &slice->str);
-      if (ret != SUCCESS)
-        return ret;
-      slice->codec = true;
+    // The rule decodes its value itself if it's extracted from the raw.
+    int ret = SUCCESS;
+    const std::string* view = NULL;
+    if (rule.header >= 0) {
+      // Only the header of the rule is decoded, and none if it's absent.
+      view = DecodeHeader(msg, type, rule.header,
+                          rule.late_decode.empty() ? *codec : kRawChain,
+                          &ret);
+      if (!view && ret == SUCCESS)
+        continue;
+    } else {
+      view = rule.late_decode.empty()
+          ? Decode(msg, type, *codec, reach, &ret)
+          : &Slice(msg, type).str;
     }
+    if (!view)
+      return ret;
 
     // Parse
     switch (rule.type) {
     case RuleLayer::Type::UNKNOWN:
-      ParseUKN(rule, slice->str, &record, &tmp);
+      ParseUKN(rule, *view,
+               rule.params ? IndexParams(msg, *view, rule.data_src) : NULL,
+               &record, &tmp);
       break;
     case RuleLayer::Type::JSON:
-      ParseJSON(rule, slice->str, res, &tmp);
+      ParseJSON(*cate, rule, msg, *view, res, &tmp);
       break;
     case RuleLayer::Type::XML:
-      ParseXML(rule, slice->str, res, &tmp);
+      ParseXML(*cate, rule, msg, *view, res, &tmp);
       break;
     case RuleLayer::Type::F0:
-      ParseF0(rule, slice->str, res, &tmp);
+      ParseF0(rule, *view, res, &tmp);
       break;
     case RuleLayer::Type::F1:
-      ParseF1(rule, slice->str, res, &tmp);
+      ParseF1(rule, *view, res, &tmp);
+      break;
+    case RuleLayer::Type::PB:
+      ParsePB(rule, *view, res, &tmp);
+      break;
+    case RuleLayer::Type::MSGPACK:
+      ParseMSGPACK(rule, *view, res, &tmp);
+      break;
+    case RuleLayer::Type::THRIFT:
+      ParseTHRIFT(rule, *view, res, &tmp);
       break;
     default: UNREACHABLE_CODE;
     }
@@ -0,0 +1,843 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include "extractor/json_scanner.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EXTRACTOR_X86 1
+#endif
+
+namespace ext {
+namespace {
+// AJson::Reader throws once values nest this deep, the scanner stops
+// there as it does on any other error.
+const int kDepthLimit = 1000;
+
+// Sets the bits of the quotes, backslashes and whitespaces of the 64
+// bytes blocks at p, bit i of a word is byte i of its block.
+typedef void (*ClassifyFunc)(const char* p, size_t blocks, uint64_t* quote,
+                             uint64_t* backslash, uint64_t* space);
+
+void classify(const char* p, size_t blocks, uint64_t* quote,
+              uint64_t* backslash, uint64_t* space) {
+  for (size_t n = 0; n < blocks; ++n, p += 64) {
+    quote[n] = backslash[n] = space[n] = 0;
+    for (int i = 0; i < 64; ++i) {
+      uint64_t bit = 1ULL << i;
+      switch (p[i]) {
+      case '"': quote[n] |= bit; break;
+      case '\\': backslash[n] |= bit; break;
+      case ' ': case '\t': case '\r': case '\n': space[n] |= bit; break;
+      default: break;
+      }
+    }
+  }
+}
+
+#ifdef EXTRACTOR_X86
+__attribute__((target("sse2")))
+void classify_sse2(const char* p, size_t blocks, uint64_t* quote,
+                   uint64_t* backslash, uint64_t* space) {
+  const __m128i q = _mm_set1_epi8('"');
+  const __m128i b = _mm_set1_epi8('\\');
+  const __m128i sp = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+  for (size_t n = 0; n < blocks; ++n, p += 64) {
+    uint64_t qs = 0, bs = 0, ss = 0;
+    for (int i = 0; i < 64; i += 16) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      __m128i s = _mm_or_si128(
+          _mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(v, tab)),
+          _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+      qs |= static_cast<uint64_t>(static_cast<uint16_t>(
+          _mm_movemask_epi8(_mm_cmpeq_epi8(v, q)))) << i;
+      bs |= static_cast<uint64_t>(static_cast<uint16_t>(
+          _mm_movemask_epi8(_mm_cmpeq_epi8(v, b)))) << i;
+      ss |= static_cast<uint64_t>(static_cast<uint16_t>(
+          _mm_movemask_epi8(s))) << i;
+    }
+    quote[n] = qs;
+    backslash[n] = bs;
+    space[n] = ss;
+  }
+}
+
+__attribute__((target("avx2")))
+void classify_avx2(const char* p, size_t blocks, uint64_t* quote,
+                   uint64_t* backslash, uint64_t* space) {
+  const __m256i q = _mm256_set1_epi8('"');
+  const __m256i b = _mm256_set1_epi8('\\');
+  const __m256i sp = _mm256_set1_epi8(' ');
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i lf = _mm256_set1_epi8('\n');
+  for (size_t n = 0; n < blocks; ++n, p += 64) {
+    uint64_t qs = 0, bs = 0, ss = 0;
+    for (int i = 0; i < 64; i += 32) {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+      __m256i s = _mm256_or_si256(
+          _mm256_or_si256(_mm256_cmpeq_epi8(v, sp), _mm256_cmpeq_epi8(v, tab)),
+          _mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, lf)));
+      qs |= static_cast<uint64_t>(static_cast<uint32_t>(
+          _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, q)))) << i;
+      bs |= static_cast<uint64_t>(static_cast<uint32_t>(
+          _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, b)))) << i;
+      ss |= static_cast<uint64_t>(static_cast<uint32_t>(
+          _mm256_movemask_epi8(s))) << i;
+    }
+    quote[n] = qs;
+    backslash[n] = bs;
+    space[n] = ss;
+  }
+}
+#endif
+
+ClassifyFunc resolve_classify() {
+#ifdef EXTRACTOR_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return classify_avx2;
+  if (__builtin_cpu_supports("sse2"))
+    return classify_sse2;
+#endif
+  return classify;
+}
+
+// Returns the bytes escaped by a backslash, which are the ones after an
+// odd run of backslashes. `carry' tells whether the first byte of the
+// block is escaped by the previous one, and is updated for the next.
+uint64_t find_escaped(uint64_t backslash, uint64_t* carry) {
+  const uint64_t even = 0x5555555555555555ULL;
+  backslash &= ~*carry;
+  uint64_t follows = (backslash << 1) | *carry;
+  // The runs that start on odd bytes, adding them to the backslashes
+  // carries a bit out of each run, just past its end.
+  uint64_t odd_starts = backslash & ~even & ~follows;
+  uint64_t sum = odd_starts + backslash;
+  *carry = sum < odd_starts ? 1 : 0;
+  uint64_t invert = sum << 1;
+  return (even ^ invert) & follows;
+}
+
+} // anonymous namespace
+
+typedef std::unique_ptr<JsonNode> JsonNodePtr;
+
+// What's left of a container once it's read. A collapsed node stands for
+// a subtree without any record of any key set, all that matters of it is
+// the number of objects inside, each one may drop res->back().
+struct JsonNode {
+  bool object;
+  bool collapsed;
+  int objects;                                // collapsed only
+  std::vector<Record> records;                // object only, by key set
+  std::map<string_view, JsonNodePtr> members; // object only, name order
+  std::vector<JsonNodePtr> elements;          // array only
+
+  JsonNode(bool o): object(o), collapsed(false), objects(0) {}
+};
+
+namespace {
+JsonNodePtr MakeCollapsed(int objects) {
+  JsonNodePtr node(new JsonNode(false));
+  node->collapsed = true;
+  node->objects = objects;
+  return node;
+}
+
+// A value read by the scanner.
+struct JsonValue {
+  enum Kind {
+    NONE,       // broken before the value was set
+    SCALAR,
+    CONTAINER,
+  };
+
+  Kind kind;
+  std::string str;  // AJson::Value::asString() of a wanted scalar
+  JsonNodePtr node; // container with records
+  int objects;      // objects inside a container without records
+
+  JsonValue(): kind(NONE), objects(0) {}
+};
+
+void AppendUtf8(unsigned int cp, std::string* out) {
+  if (cp <= 0x7f) {
+    out->push_back(static_cast<char>(cp));
+  } else if (cp <= 0x7FF) {
+    out->push_back(static_cast<char>(0xC0 | (0x1f & (cp >> 6))));
+    out->push_back(static_cast<char>(0x80 | (0x3f & cp)));
+  } else if (cp <= 0xFFFF) {
+    out->push_back(static_cast<char>(0xE0 | (0xf & (cp >> 12))));
+    out->push_back(static_cast<char>(0x80 | (0x3f & (cp >> 6))));
+    out->push_back(static_cast<char>(0x80 | (0x3f & cp)));
+  } else if (cp <= 0x10FFFF) {
+    out->push_back(static_cast<char>(0xF0 | (0x7 & (cp >> 18))));
+    out->push_back(static_cast<char>(0x80 | (0x3f & (cp >> 12))));
+    out->push_back(static_cast<char>(0x80 | (0x3f & (cp >> 6))));
+    out->push_back(static_cast<char>(0x80 | (0x3f & cp)));
+  }
+}
+
+bool DecodeHex4(const char** p, const char* end, unsigned int* cp) {
+  if (end - *p < 4)
+    return false;
+  *cp = 0;
+  for (int i = 0; i < 4; ++i) {
+    char c = *(*p)++;
+    *cp *= 16;
+    if (c >= '0' && c <= '9')
+      *cp += c - '0';
+    else if (c >= 'a' && c <= 'f')
+      *cp += c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      *cp += c - 'A' + 10;
+    else
+      return false;
+  }
+  return true;
+}
+
+// Checks the contents of a string token as AJson::Reader::decodeString
+// does, the decoded string is appended to out if any.
+bool DecodeString(const char* p, const char* end, std::string* out) {
+  while (p != end) {
+    const char* run = p;
+    p = static_cast<const char*>(memchr(p, '\\', end - p));
+    if (!p)
+      p = end;
+    if (out)
+      out->append(run, p);
+    if (p == end)
+      break;
+
+    if (++p == end)
+      return false;
+    char escape = *p++;
+    char c;
+    switch (escape) {
+    case '"': c = '"'; break;
+    case '/': c = '/'; break;
+    case '\\': c = '\\'; break;
+    case 'b': c = '\b'; break;
+    case 'f': c = '\f'; break;
+    case 'n': c = '\n'; break;
+    case 'r': c = '\r'; break;
+    case 't': c = '\t'; break;
+    case 'u': {
+      unsigned int cp;
+      if (!DecodeHex4(&p, end, &cp))
+        return false;
+      if (cp >= 0xD800 && cp <= 0xDBFF) {
+        // surrogate pairs
+        unsigned int low;
+        if (end - p < 6 || *p++ != '\\' || *p++ != 'u' ||
+            !DecodeHex4(&p, end, &low))
+          return false;
+        cp = 0x10000 + ((cp & 0x3FF) << 10) + (low & 0x3FF);
+      }
+      if (out)
+        AppendUtf8(cp, out);
+      continue;
+    }
+    default: return false;
+    }
+    if (out)
+      out->push_back(c);
+  }
+  return true;
+}
+
+// Checks a number token as AJson::Reader::decodeNumber does, its
+// AJson::Value::asString() goes to out if any.
+bool DecodeNumber(const char* b, const char* e, std::string* out) {
+  const char* p = b;
+  const bool negative = *p == '-';
+  if (negative)
+    ++p;
+  const uint64_t max = negative
+      ? static_cast<uint64_t>(INT64_MAX) + 1 : UINT64_MAX;
+  const uint64_t threshold = max / 10;
+  uint64_t value = 0;
+  bool integer = true;
+  while (p < e) {
+    char c = *p++;
+    if (c < '0' || c > '9') {
+      integer = false;
+      break;
+    }
+    unsigned int digit = c - '0';
+    if (value >= threshold &&
+        (value > threshold || p != e || digit > max % 10)) {
+      integer = false;
+      break;
+    }
+    value = value * 10 + digit;
+  }
+
+  char buf[64];
+  if (integer) {
+    if (out) {
+      char* s = buf + sizeof(buf);
+      do {
+        *--s = '0' + value % 10;
+        value /= 10;
+      } while (value != 0);
+      if (negative && !(s[0] == '0' && s + 1 == buf + sizeof(buf)))
+        *--s = '-';
+      out->assign(s, buf + sizeof(buf));
+    }
+    return true;
+  }
+
+  // The reader goes through std::istringstream, which is strtod that
+  // has to take the whole token and must not overflow.
+  std::string copy;
+  const char* s = buf;
+  if (static_cast<size_t>(e - b) < sizeof(buf)) {
+    memcpy(buf, b, e - b);
+    buf[e - b] = '\0';
+  } else {
+    copy.assign(b, e);
+    s = copy.c_str();
+  }
+  char* stop = NULL;
+  double d = strtod(s, &stop);
+  if (stop != s + (e - b) || std::isinf(d))
+    return false;
+  if (out) {
+    int n = snprintf(buf, sizeof(buf), "%.17g", d);
+    out->assign(buf, n);
+  }
+  return true;
+}
+
+class JsonScanner {
+public:
+  JsonScanner(string_view doc, const JsonDocument::KeySets& key_sets,
+              const JsonIndex* index, std::deque<std::string>* names)
+    : p_(doc.data()), end_(doc.data() + doc.size()), index_(index),
+      names_(names) {
+    // The keys of all sets in a row, set i is [offsets_[i], offsets_[i + 1]).
+    offsets_.push_back(0);
+    for (size_t i = 0; i < key_sets.size(); ++i) {
+      for (size_t j = 0; j < key_sets[i]->size(); ++j)
+        keys_.push_back(&(*key_sets[i])[j]);
+      offsets_.push_back(keys_.size());
+    }
+  }
+
+  // Returns the root container, NULL if it doesn't matter.
+  JsonNodePtr Scan() {
+    JsonValue root;
+    ReadValue(0, true, false, &root);
+    if (!root.node && root.objects > 0)
+      return MakeCollapsed(root.objects);
+    return std::move(root.node);
+  }
+
+private:
+  enum Token {
+    OBJECT_BEGIN,
+    OBJECT_END,
+    ARRAY_BEGIN,
+    ARRAY_END,
+    STRING,
+    NUMBER,
+    TRUE,
+    FALSE,
+    NUL,
+    SEPARATOR,
+    COLON,
+    COMMENT,
+    END,
+    ERROR,
+  };
+
+  static bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+  }
+
+  void SkipSpaces() {
+    if (index_) {
+      if (p_ != end_ && IsSpace(*p_))
+        p_ = index_->SkipSpaces(p_, end_);
+      return;
+    }
+    while (p_ != end_ && IsSpace(*p_))
+      ++p_;
+  }
+
+  // Whether the string token in [b, e) has escapes.
+  bool Escaped(const char* b, const char* e) const {
+    if (index_)
+      return index_->FindBackslash(b, e) != e;
+    return memchr(b, '\\', e - b) != NULL;
+  }
+
+  bool Match(const char* pattern, size_t n) {
+    if (static_cast<size_t>(end_ - p_) < n || memcmp(p_, pattern, n) != 0)
+      return false;
+    p_ += n;
+    return true;
+  }
+
+  bool ReadString() {
+    if (index_) {
+      p_ = index_->FindQuote(p_, end_);
+      if (p_ == end_)
+        return false;
+      ++p_;
+      return true;
+    }
+    while (p_ != end_) {
+      char c = *p_++;
+      if (c == '"')
+        return true;
+      if (c == '\\') {
+        if (p_ == end_)
+          return false;
+        ++p_;
+      }
+    }
+    return false;
+  }
+
+  bool ReadComment() {
+    if (p_ == end_)
+      return false;
+    char c = *p_++;
+    if (c == '*') {
+      while (p_ != end_) {
+        if (*p_++ == '*' && p_ != end_ && *p_ == '/')
+          break;
+      }
+      return Match("/", 1);
+    }
+    if (c != '/')
+      return false;
+    while (p_ != end_) {
+      c = *p_++;
+      if (c == '\n')
+        break;
+      if (c == '\r') {
+        if (p_ != end_ && *p_ == '\n')
+          ++p_;
+        break;
+      }
+    }
+    return true;
+  }
+
+  void ReadNumber() {
+    while (p_ != end_ && *p_ >= '0' && *p_ <= '9')
+      ++p_;
+    if (p_ != end_ && *p_ == '.') {
+      ++p_;
+      while (p_ != end_ && *p_ >= '0' && *p_ <= '9')
+        ++p_;
+    }
+    if (p_ != end_ && (*p_ == 'e' || *p_ == 'E')) {
+      ++p_;
+      if (p_ != end_ && (*p_ == '+' || *p_ == '-'))
+        ++p_;
+      while (p_ != end_ && *p_ >= '0' && *p_ <= '9')
+        ++p_;
+    }
+  }
+
+  // Reads the next token, [tb_, p_) holds it.
+  Token ReadToken() {
+    SkipSpaces();
+    tb_ = p_;
+    if (p_ == end_)
+      return END;
+    switch (*p_++) {
+    case '{': return OBJECT_BEGIN;
+    case '}': return OBJECT_END;
+    case '[': return ARRAY_BEGIN;
+    case ']': return ARRAY_END;
+    case '"': return ReadString() ? STRING : ERROR;
+    case '/': return ReadComment() ? COMMENT : ERROR;
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+    case '-':
+      ReadNumber();
+      return NUMBER;
+    case 't': return Match("rue", 3) ? TRUE : ERROR;
+    case 'f': return Match("alse", 4) ? FALSE : ERROR;
+    case 'n': return Match("ull", 3) ? NUL : ERROR;
+    case ',': return SEPARATOR;
+    case ':': return COLON;
+    case '\0': return END;
+    default: return ERROR;
+    }
+  }
+
+  Token ReadTokenSkipComments() {
+    Token token;
+    do {
+      token = ReadToken();
+    } while (token == COMMENT);
+    return token;
+  }
+
+  // Reads a value, building containers only if keep, and converting
+  // scalars to strings only if want. Returns false on a broken document,
+  // value then holds what was set before the error.
+  bool ReadValue(int depth, bool keep, bool want, JsonValue* value) {
+    if (depth >= kDepthLimit)
+      return false;
+
+    switch (ReadTokenSkipComments()) {
+    case OBJECT_BEGIN:
+      value->kind = JsonValue::CONTAINER;
+      return ReadObject(depth, keep, value);
+    case ARRAY_BEGIN:
+      value->kind = JsonValue::CONTAINER;
+      return ReadArray(depth, keep, value);
+    case NUMBER:
+      if (!DecodeNumber(tb_, p_, want ? &value->str : NULL))
+        return false;
+      break;
+    case STRING:
+      if (want) {
+        if (!DecodeString(tb_ + 1, p_ - 1, &value->str))
+          return false;
+      } else if (Escaped(tb_ + 1, p_ - 1)) {
+        if (!DecodeString(tb_ + 1, p_ - 1, NULL))
+          return false;
+      }
+      break;
+    case TRUE:
+      if (want)
+        value->str = "true";
+      break;
+    case FALSE:
+      if (want)
+        value->str = "false";
+      break;
+    case NUL:
+      break;
+    default:
+      return false;
+    }
+    value->kind = JsonValue::SCALAR;
+    return true;
+  }
+
+  // Returns the decoded member name, it points into the document unless
+  // the name has escapes.
+  bool ReadName(bool keep, string_view* name) {
+    const char* b = tb_ + 1;
+    const char* e = p_ - 1;
+    if (!Escaped(b, e)) {
+      *name = string_view(b, e - b);
+      return true;
+    }
+    if (!keep)
+      return DecodeString(b, e, NULL);
+    names_->push_back(std::string());
+    if (!DecodeString(b, e, &names_->back()))
+      return false;
+    *name = names_->back();
+    return true;
+  }
+
+  bool ReadObject(int depth, bool keep, JsonValue* out) {
+    JsonNodePtr node;
+    std::vector<std::string> values;
+    bool ok = ReadMembers(depth, keep, &node, &values);
+    if (keep)
+      CloseObject(std::move(node), &values, out);
+    return ok;
+  }
+
+  bool ReadMembers(int depth, bool keep, JsonNodePtr* node,
+                   std::vector<std::string>* values) {
+    // The reader only takes '}' in place of a name after an empty name,
+    // which is the case before the first member.
+    bool empty_name = true;
+    for (;;) {
+      Token token = ReadTokenSkipComments();
+      if (token == OBJECT_END && empty_name)
+        return true;
+      if (token != STRING)
+        return false;
+      string_view name;
+      if (!ReadName(keep, &name))
+        return false;
+      empty_name = tb_ + 2 == p_;
+      if (ReadToken() != COLON)
+        return false;
+
+      bool matched = false;
+      if (keep) {
+        for (size_t i = 0; i < keys_.size() && !matched; ++i)
+          matched = name == keys_[i]->mapped;
+      }
+
+      JsonValue value;
+      bool ok = ReadValue(depth + 1, keep, matched, &value);
+      if (keep && value.kind != JsonValue::NONE)
+        SetMember(name, matched, &value, node, values);
+      if (!ok)
+        return false;
+
+      token = ReadToken();
+      if (token != OBJECT_END && token != SEPARATOR && token != COMMENT)
+        return false;
+      while (token == COMMENT)
+        token = ReadToken();
+      if (token == OBJECT_END)
+        return true;
+    }
+  }
+
+  // A member replaces the one of the same name read before.
+  void SetMember(string_view name, bool matched, JsonValue* value,
+                 JsonNodePtr* node, std::vector<std::string>* values) {
+    if (*node)
+      (*node)->members.erase(name);
+
+    if (matched) {
+      if (values->empty())
+        values->resize(keys_.size());
+      for (size_t i = 0; i < keys_.size(); ++i) {
+        if (name == keys_[i]->mapped)
+          (*values)[i] = value->kind == JsonValue::SCALAR ? value->str : "";
+      }
+    }
+
+    if (value->node || value->objects > 0) {
+      if (!*node)
+        node->reset(new JsonNode(true));
+      (*node)->members[name] = value->node ? std::move(value->node)
+                                           : MakeCollapsed(value->objects);
+    }
+  }
+
+  void CloseObject(JsonNodePtr node, std::vector<std::string>* values,
+                   JsonValue* out) {
+    std::vector<Record> records;
+    bool collapsed = true;
+    if (!values->empty()) {
+      records.resize(offsets_.size() - 1);
+      for (size_t i = 0; i + 1 < offsets_.size(); ++i) {
+        for (size_t j = offsets_[i]; j < offsets_[i + 1]; ++j) {
+          std::string& value = (*values)[j];
+          if (value.empty() || value == "null")
+            continue;
+          const auto& key = *keys_[j];
+          if (!key.filter || key.filter(&value))
+            records[i][key.key].swap(value);
+        }
+        collapsed = collapsed && records[i].empty();
+      }
+    }
+
+    int objects = 1;
+    if (node) {
+      for (auto iter = node->members.begin();
+           iter != node->members.end() && collapsed; ++iter) {
+        collapsed = iter->second->collapsed;
+        objects += iter->second->objects;
+      }
+    }
+    if (collapsed) {
+      out->objects = objects;
+      return;
+    }
+
+    if (!node)
+      node.reset(new JsonNode(true));
+    node->records.swap(records);
+    out->node = std::move(node);
+  }
+
+  bool ReadArray(int depth, bool keep, JsonValue* out) {
+    JsonNodePtr node;
+    bool ok = ReadElements(depth, keep, &node);
+    if (keep && node) {
+      if (node->elements.size() == 1 && node->elements[0]->collapsed)
+        out->objects = node->elements[0]->objects;
+      else
+        out->node = std::move(node);
+    }
+    return ok;
+  }
+
+  bool ReadElements(int depth, bool keep, JsonNodePtr* node) {
+    SkipSpaces();
+    if (p_ != end_ && *p_ == ']') {
+      ++p_;
+      return true;
+    }
+
+    // The walk stops at the first element that isn't a container.
+    bool stopped = !keep;
+    for (;;) {
+      JsonValue value;
+      bool ok = ReadValue(depth + 1, !stopped, false, &value);
+      if (!stopped) {
+        if (value.kind != JsonValue::CONTAINER)
+          stopped = true;
+        else
+          AppendElement(&value, node);
+      }
+      if (!ok)
+        return false;
+
+      Token token = ReadTokenSkipComments();
+      if (token == ARRAY_END)
+        return true;
+      if (token != SEPARATOR)
+        return false;
+    }
+  }
+
+  // Adjacent elements without records fold into one.
+  void AppendElement(JsonValue* value, JsonNodePtr* node) {
+    if (!value->node && value->objects == 0)
+      return;
+    if (!*node)
+      node->reset(new JsonNode(false));
+    auto& elements = (*node)->elements;
+    if (value->node) {
+      elements.push_back(std::move(value->node));
+    } else if (!elements.empty() && elements.back()->collapsed) {
+      elements.back()->objects += value->objects;
+    } else {
+      elements.push_back(MakeCollapsed(value->objects));
+    }
+  }
+
+  const char* p_;
+  const char* end_;
+  const char* tb_;
+  std::vector<const Rule::Key*> keys_;
+  std::vector<size_t> offsets_;
+  const JsonIndex* index_;
+  std::deque<std::string>* names_; // member names that had escapes
+};
+
+void Replay(const JsonNode* node, size_t set, size_t keys, RecordSet* res,
+            bool complete) {
+  if (node->collapsed) {
+    for (int i = 0; i < node->objects && complete && !res->empty(); ++i) {
+      if (res->back().size() != keys)
+        res->pop_back();
+    }
+    return;
+  }
+
+  if (!node->object) {
+    for (size_t i = 0; i < node->elements.size(); ++i)
+      Replay(node->elements[i].get(), set, keys, res, complete);
+    return;
+  }
+
+  if (!node->records.empty() && !node->records[set].empty()) {
+    const Record& record = node->records[set];
+    if (complete || res->empty()) {
+      // first extract
+      res->push_back(record);
+    } else {
+      res->back().insert(record.begin(), record.end());
+      complete = false;
+    }
+  }
+
+  for (auto iter = node->members.begin(); iter != node->members.end(); ++iter)
+    Replay(iter->second.get(), set, keys, res, complete);
+
+  // check numbers of record from back.
+  if (complete && !res->empty()) {
+    if (res->back().size() != keys)
+      res->pop_back();
+  }
+}
+
+} // anonymous namespace
+
+JsonIndex::JsonIndex(string_view doc)
+  : base_(doc.data()), size_(doc.size()),
+    quotes_((doc.size() + 63) / 64), backslashes_(quotes_.size()),
+    spaces_(quotes_.size()) {
+  static const ClassifyFunc classify_func = resolve_classify();
+  size_t blocks = size_ / 64;
+  classify_func(base_, blocks, quotes_.data(), backslashes_.data(),
+                spaces_.data());
+  if (blocks < quotes_.size()) {
+    char tail[64] = {0};
+    memcpy(tail, base_ + blocks * 64, size_ - blocks * 64);
+    classify_func(tail, 1, &quotes_[blocks], &backslashes_[blocks],
+                  &spaces_[blocks]);
+  }
+
+  uint64_t carry = 0;
+  for (size_t i = 0; i < quotes_.size(); ++i)
+    quotes_[i] &= ~find_escaped(backslashes_[i], &carry);
+}
+
+bool JsonIndex::Covers(string_view part) const {
+  if (part.data() < base_ || part.data() + part.size() > base_ + size_)
+    return false;
+  return part.data() == base_ || part.data()[-1] != '\\';
+}
+
+const char* JsonIndex::Find(const std::vector<uint64_t>& bits, uint64_t flip,
+                            const char* p, const char* end) const {
+  size_t i = p - base_;
+  size_t n = end - base_;
+  while (i < n) {
+    uint64_t word = (bits[i / 64] ^ flip) >> (i % 64);
+    if (word != 0) {
+      i += __builtin_ctzll(word);
+      break;
+    }
+    i = (i | 63) + 1;
+  }
+  return base_ + std::min(i, n);
+}
+
+JsonDocument::JsonDocument(string_view doc, const KeySets& key_sets,
+                           const JsonIndex* index)
+  : key_sets_(key_sets) {
+  root_ = JsonScanner(doc, key_sets, index, &names_).Scan();
+}
+
+JsonDocument::~JsonDocument() {}
+
+bool JsonDocument::FindKeySet(const std::vector<Rule::Key>& keys,
+                              size_t* set) const {
+  auto iter = std::find(key_sets_.begin(), key_sets_.end(), &keys);
+  *set = iter - key_sets_.begin();
+  return iter != key_sets_.end();
+}
+
+void JsonDocument::Extract(size_t set, RecordSet* res) const {
+  assert(set < key_sets_.size());
+  if (root_)
+    Replay(root_.get(), set, key_sets_[set]->size(), res, true);
+}
+
+void ScanJson(string_view doc, const std::vector<Rule::Key>& keys,
+              const JsonIndex* index, RecordSet* res) {
+  JsonDocument(doc, JsonDocument::KeySets(1, &keys), index).Extract(0, res);
+}
+
+} // namespace ext
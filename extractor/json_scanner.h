@@ -0,0 +1,104 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#ifndef EXTRACTOR_JSON_SCANNER_H_
+#define EXTRACTOR_JSON_SCANNER_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "extractor/rule.h"
+#include "extractor/parser.h"
+#include "extractor/trivial.h"
+#include "extractor/third_party/string_view.h"
+
+namespace ext {
+// Documents shorter than this are scanned without an index.
+const size_t kJsonIndexMinSize = 1024;
+
+// The stage-1 index of a JSON document: bitmaps of its unescaped quotes,
+// backslashes and whitespaces, found 64 bytes at a time, so that the
+// scanner jumps over strings and spaces instead of stepping through them.
+// It's built once per decoded slice and shared by the JSON rules on it.
+class JsonIndex {
+public:
+  explicit JsonIndex(string_view doc);
+
+  // Whether the index applies to a part of the document, it doesn't if
+  // the part starts in the middle of a run of backslashes.
+  bool Covers(string_view part) const;
+
+  // Returns the first unescaped quote in [p, end), or end.
+  const char* FindQuote(const char* p, const char* end) const {
+    return Find(quotes_, 0, p, end);
+  }
+  // Returns the first backslash in [p, end), or end.
+  const char* FindBackslash(const char* p, const char* end) const {
+    return Find(backslashes_, 0, p, end);
+  }
+  // Returns the first byte in [p, end) that isn't a whitespace, or end.
+  const char* SkipSpaces(const char* p, const char* end) const {
+    return Find(spaces_, ~0ULL, p, end);
+  }
+
+private:
+  const char* Find(const std::vector<uint64_t>& bits, uint64_t flip,
+                   const char* p, const char* end) const;
+
+  const char* base_;
+  size_t size_;
+  std::vector<uint64_t> quotes_;
+  std::vector<uint64_t> backslashes_;
+  std::vector<uint64_t> spaces_;
+};
+
+struct JsonNode;
+
+// The records of several key sets in a JSON document, which is scanned
+// once for all of them.
+//
+// The records of a key set are the ones of reading the document with
+// AJson::Reader (Features::all()) and walking the DOM: every object
+// yields the record of its scalar members whose names are the keys'
+// `mapped', it's pushed to `res' while the objects above it are complete,
+// otherwise it's merged into res->back(), and a complete object drops
+// res->back() once its children are done unless it holds every key.
+// Children are visited in name order, arrays stop at their first scalar
+// element, and a broken document yields what was read before the error.
+//
+// Only what decides the records is kept: member names and values that
+// aren't keys are validated and skipped, and subtrees without any record
+// collapse into the number of objects inside them.
+class JsonDocument {
+public:
+  typedef std::vector<const std::vector<Rule::Key>*> KeySets;
+
+  // The index, if any, must cover `doc'. The key sets must outlive the
+  // document, `doc' needn't.
+  JsonDocument(string_view doc, const KeySets& key_sets,
+               const JsonIndex* index);
+  ~JsonDocument();
+
+  // Finds out which of the key sets `keys' is.
+  bool FindKeySet(const std::vector<Rule::Key>& keys, size_t* set) const;
+
+  // Adds the records of the key set to `res'.
+  void Extract(size_t set, RecordSet* res) const;
+
+private:
+  KeySets key_sets_;
+  std::unique_ptr<JsonNode> root_;
+  std::deque<std::string> names_; // member names that had escapes
+  DISALLOW_COPY_AND_ASSIGN(JsonDocument);
+};
+
+// Extracts the records of the keys from a JSON document in a single pass,
+// see JsonDocument.
+void ScanJson(string_view doc, const std::vector<Rule::Key>& keys,
+              const JsonIndex* index, RecordSet* res);
+
+} // namespace ext
+
+#endif // EXTRACTOR_JSON_SCANNER_H_
@@ -0,0 +1,318 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "extractor/json_scanner.h"
+#include "extractor/filter.h"
+#include "extractor/third_party/json.h"
+
+using namespace ext;
+
+// The DOM walk ScanJson has to agree with.
+Record ReadJsonObject(const AJson::Value& root,
+                      const std::vector<Rule::Key>& keys) {
+  Record records;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto const& key = keys[i];
+    if (root.isMember(key.mapped)) {
+      if (root[key.mapped].type() == AJson::arrayValue
+          || root[key.mapped].type() == AJson::objectValue) {
+        continue;
+      }
+      auto value = root[key.mapped].asString();
+      if (value.empty() || value == "null")
+        continue;
+      if (!key.filter || key.filter(&value))
+        records[key.key] = value;
+    }
+  }
+  return records;
+}
+
+void ParseJsonRecursively(const AJson::Value& root,
+                          const std::vector<Rule::Key>& keys,
+                          RecordSet* res, bool complete) {
+  switch (root.type()) {
+  case AJson::arrayValue:
+    for (auto iter = root.begin(); iter != root.end(); ++iter) {
+      if (iter->type() != AJson::arrayValue
+          && iter->type() != AJson::objectValue) {
+        break;
+      }
+      ParseJsonRecursively(*iter, keys, res, complete);
+    }
+    break;
+  case AJson::objectValue: {
+    Record records = ReadJsonObject(root, keys);
+    if (!records.empty()) {
+      if (complete || res->empty()) {
+        res->push_back(records);
+      } else {
+        res->back().insert(records.begin(), records.end());
+        complete = false;
+      }
+    }
+    for (auto iter = root.begin(); iter != root.end(); ++iter) {
+      if (iter->type() == AJson::arrayValue
+          || iter->type() == AJson::objectValue) {
+        ParseJsonRecursively(*iter, keys, res, complete);
+      }
+    }
+    if (complete && !res->empty()) {
+      if (res->back().size() != keys.size())
+        res->pop_back();
+    }
+    break;
+  }
+  default: break;
+  }
+}
+
+RecordSet DomRecords(const std::string& doc,
+                     const std::vector<Rule::Key>& keys,
+                     const RecordSet& init) {
+  AJson::Value root;
+  AJson::Reader reader(AJson::Features::all());
+  reader.parse(doc.data(), doc.data() + doc.size(), root, false);
+  RecordSet res(init);
+  ParseJsonRecursively(root, keys, &res, true);
+  return res;
+}
+
+RecordSet ScanRecords(string_view doc,
+                      const std::vector<Rule::Key>& keys,
+                      const JsonIndex* index,
+                      const RecordSet& init) {
+  RecordSet res(init);
+  ScanJson(doc, keys, index, &res);
+  return res;
+}
+
+std::vector<Rule::Key> MakeKeys(const char* const* names, size_t n) {
+  std::vector<Rule::Key> keys;
+  for (size_t i = 0; i < n; i += 2) {
+    Rule::Key key;
+    key.key = names[i];
+    key.mapped = names[i + 1];
+    key.type = MakeType(key.key);
+    key.filter = FilterFactory(key.type);
+    key.validate = ValidatorFactory(key.type);
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+void Check(const std::string& doc, const std::vector<Rule::Key>& keys,
+           const RecordSet& init = RecordSet()) {
+  RecordSet expect = DomRecords(doc, keys, init);
+  // with no index, an index of its own, and the one of a bigger document
+  JsonIndex index(doc);
+  std::string outer = "//\\\"" + doc + " ]";
+  JsonIndex outer_index(outer);
+  string_view part(outer.data() + 4, doc.size());
+  assert(outer_index.Covers(part));
+  if (ScanRecords(doc, keys, NULL, init) != expect ||
+      ScanRecords(doc, keys, &index, init) != expect ||
+      ScanRecords(part, keys, &outer_index, init) != expect) {
+    std::cerr << "mismatch on: " << doc << std::endl;
+    assert(false);
+  }
+}
+
+void TestCaseScanJson() {
+  static const char* const names[] = {
+    "PHONENUM", "phone",
+    "NICKNAME", "name",
+  };
+  auto keys = MakeKeys(names, sizeof(names) / sizeof(names[0]));
+
+  RecordSet res;
+  ScanJson("{\"data\":[{\"phone\":\"13812345678\",\"name\":\"a\"},"
+           "{\"phone\":\"13812345679\",\"name\":\"b\",\"x\":{}}]}",
+           keys, NULL, &res);
+  assert(res.size() == 2);
+  assert(res[0]["PHONENUM"] == "13812345678" && res[0]["NICKNAME"] == "a");
+  assert(res[1]["PHONENUM"] == "13812345679" && res[1]["NICKNAME"] == "b");
+
+  const char* docs[] = {
+    // the sibling merge into res->back()
+    "{\"phone\":\"13812345678\",\"a\":{\"name\":\"x\"}}",
+    "{\"b\":{\"name\":\"x\"},\"phone\":\"13812345678\",\"a\":{\"name\":\"y\"}}",
+    "[{\"phone\":\"13812345678\"},{\"name\":\"x\"}]",
+    // incomplete objects are dropped, empty ones drop them too
+    "{\"phone\":\"13812345678\",\"a\":{},\"b\":[{},{}]}",
+    "[{\"phone\":\"13812345678\"},{},[1,{\"name\":\"x\"}]]",
+    // duplicate names, the last one wins
+    "{\"phone\":\"1\",\"phone\":\"13812345678\",\"name\":{},\"name\":\"x\"}",
+    "{\"name\":\"x\",\"name\":{\"phone\":\"13812345678\"}}",
+    // escapes, numbers and literals
+    "{\"n\\u0061me\":\"\\u4e2d\\ud83d\\ude00\\n\",\"phone\":13812345678}",
+    "{\"name\":-0,\"phone\":\"13812345678\"}",
+    "{\"name\":1.5e3,\"phone\":\"13812345678\"}",
+    "{\"name\":18446744073709551616,\"phone\":\"13812345678\"}",
+    "{\"name\":-9223372036854775808,\"phone\":\"13812345678\"}",
+    "{\"name\":true,\"phone\":\"13812345678\"}",
+    "{\"name\":null,\"phone\":\"13812345678\"}",
+    "{\"name\":\"null\",\"phone\":\"13812345678\"}",
+    "{\"name\":-,\"phone\":\"13812345678\"}",
+    // comments and broken documents
+    "/* c */ {\"name\" : \"x\" // c\n, \"phone\":\"13812345678\" /* c */ }",
+    "{\"name\":\"x\",\"phone\":\"13812345678\",\"a\":[{\"name\":\"y\"",
+    "{\"name\":\"x\",\"phone\":\"13812345678\",\"a\":1e999}",
+    "{\"name\":\"x\",\"phone\":\"13812345678\",\"\":1,}",
+    "{\"name\":\"x\",\"phone\":\"13812345678\",\"a\":1,}",
+    "[{\"name\":\"x\",\"phone\":\"13812345678\"},]",
+    "[{\"name\":\"x\",\"phone\":\"13812345678\"}] trailing",
+    "\"name\"",
+  };
+  for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); ++i)
+    Check(docs[i], keys);
+
+  // Records already in the set may be dropped or merged into.
+  RecordSet init(1);
+  init[0]["OTHER"] = "1";
+  Check("[{},{\"name\":\"x\"}]", keys, init);
+  Check("{\"a\":[{\"name\":\"x\"}]}", keys, init);
+}
+
+const char* const kRandomNames[] = {
+  "phone", "name", "a", "b", "", "n\\u0061me",
+};
+
+void RandomScalar(std::string* doc) {
+  switch (rand() % 9) {
+  case 0: *doc += "\"13812345678\""; break;
+  case 1: *doc += "\"x\\u00e9\\\"y\""; break;
+  case 2: *doc += "-12"; break;
+  case 3: *doc += "3.25e2"; break;
+  case 4: *doc += "true"; break;
+  case 5: *doc += "null"; break;
+  case 6: *doc += "\"null\""; break;
+  case 7: *doc += "\"\""; break;
+  default: *doc += "18446744073709551615"; break;
+  }
+}
+
+void RandomValue(std::string* doc, int depth) {
+  int type = depth > 4 ? 2 : rand() % 3;
+  if (type == 2) {
+    RandomScalar(doc);
+    return;
+  }
+
+  bool object = type == 0;
+  *doc += object ? '{' : '[';
+  int n = rand() % 5;
+  for (int i = 0; i < n; ++i) {
+    if (i > 0)
+      *doc += rand() % 16 == 0 ? " /* c */," : ",";
+    if (object) {
+      *doc += '"';
+      *doc += kRandomNames[rand() % (sizeof(kRandomNames) / sizeof(kRandomNames[0]))];
+      *doc += "\":";
+    }
+    RandomValue(doc, depth + 1);
+  }
+  *doc += object ? '}' : ']';
+}
+
+void TestCaseScanJsonRandom() {
+  static const char* const names[] = {
+    "PHONENUM", "phone",
+    "NICKNAME", "name",
+    "APP_NAME", "a",
+  };
+  auto keys = MakeKeys(names, sizeof(names) / sizeof(names[0]));
+  srand(1);
+  for (int i = 0; i < 20000; ++i) {
+    std::string doc;
+    RandomValue(&doc, 0);
+    Check(doc, keys);
+
+    // broken documents yield what was read before the error
+    std::string broken = doc.substr(0, rand() % (doc.size() + 1));
+    Check(broken, keys);
+    if (!doc.empty()) {
+      broken = doc;
+      broken[rand() % broken.size()] = "{}[]\",:x\\/"[rand() % 11];
+      Check(broken, keys);
+    }
+  }
+}
+
+// The quotes and spaces the scanner would find byte by byte.
+void TestCaseJsonIndex() {
+  const char alphabet[] = "\"\\\\ \tx";
+  srand(2);
+  for (int i = 0; i < 2000; ++i) {
+    std::string doc(rand() % 300, 'x');
+    for (size_t j = 0; j < doc.size(); ++j)
+      doc[j] = alphabet[rand() % (sizeof(alphabet) - 1)];
+    JsonIndex index(doc);
+    const char* end = doc.data() + doc.size();
+    for (size_t j = 0; j < doc.size(); ++j) {
+      const char* p = doc.data() + j;
+      if (j > 0 && p[-1] == '\\')
+        continue;
+      const char* quote = p;
+      while (quote != end && *quote != '"')
+        quote += *quote == '\\' && quote + 1 != end ? 2 : 1;
+      const char* space = p;
+      while (space != end && (*space == ' ' || *space == '\t'))
+        ++space;
+      assert(index.FindQuote(p, end) == quote);
+      assert(index.SkipSpaces(p, end) == space);
+    }
+  }
+}
+
+// Each key set of a document has the records it would have alone.
+void TestCaseJsonDocument() {
+  static const char* const names[][6] = {
+    {"PHONENUM", "phone", "NICKNAME", "name", NULL, NULL},
+    {"NICKNAME", "name", NULL, NULL, NULL, NULL},
+    {"APP_NAME", "a", "PHONENUM", "phone", "NICKNAME", "b"},
+  };
+  std::vector<std::vector<Rule::Key> > keys;
+  JsonDocument::KeySets key_sets;
+  for (size_t i = 0; i < 3; ++i) {
+    size_t n = 0;
+    while (n < 6 && names[i][n])
+      n += 2;
+    keys.push_back(MakeKeys(names[i], n));
+  }
+  for (size_t i = 0; i < keys.size(); ++i)
+    key_sets.push_back(&keys[i]);
+
+  RecordSet init(1);
+  init[0]["OTHER"] = "1";
+  srand(3);
+  for (int i = 0; i < 5000; ++i) {
+    std::string doc;
+    RandomValue(&doc, 0);
+    JsonDocument document(doc, key_sets, NULL);
+    for (size_t j = 0; j < keys.size(); ++j) {
+      size_t set;
+      assert(document.FindKeySet(keys[j], &set) && set == j);
+      RecordSet res(init);
+      document.Extract(j, &res);
+      assert(res == DomRecords(doc, keys[j], init));
+      // again, as another rule on the same content would
+      res = init;
+      document.Extract(j, &res);
+      assert(res == DomRecords(doc, keys[j], init));
+    }
+  }
+}
+
+int main() {
+  TestCaseJsonIndex();
+  TestCaseScanJson();
+  TestCaseScanJsonRandom();
+  TestCaseJsonDocument();
+  return 0;
+}
@@ -0,0 +1,168 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#ifndef EXTRACTOR_KEY_SCAN_H_
+#define EXTRACTOR_KEY_SCAN_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "extractor/rule.h"
+#include "extractor/parser.h"
+#include "extractor/third_party/string_view.h"
+
+// What the scanners of binary data without a schema (PB, MSGPACK and
+// THRIFT) have in common: reading the wire, and the keys of a rule that
+// are looked for along their paths and made into records. It's internal
+// to the scanners.
+
+namespace ext {
+// Reads a base 128 varint, the 7-bit groups come least significant first.
+inline bool read_varint(const char** p, const char* end, uint64_t* v) {
+  uint64_t r = 0;
+  for (int shift = 0; shift < 64 && *p != end; shift += 7) {
+    uint8_t b = static_cast<uint8_t>(*(*p)++);
+    r |= static_cast<uint64_t>(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *v = r;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Reads n bytes, `bytes' points into the data.
+inline bool read_bytes(const char** p, const char* end, uint64_t n,
+                       string_view* bytes) {
+  if (n > static_cast<uint64_t>(end - *p))
+    return false;
+  *bytes = string_view(*p, n);
+  *p += n;
+  return true;
+}
+
+// Floating point values are written with the fewest digits that read
+// back to the same value, rather than with the six decimals of "%f" that
+// lose the small ones and spell out the big ones.
+inline void format_double(double d, std::string* out) {
+  char buf[32];
+  int n = 0;
+  for (int precision = 15; precision <= 17; ++precision) {
+    n = snprintf(buf, sizeof(buf), "%.*g", precision, d);
+    if (strtod(buf, NULL) == d)
+      break;
+  }
+  out->assign(buf, n);
+}
+
+inline void format_float(float d, std::string* out) {
+  char buf[32];
+  int n = 0;
+  for (int precision = 6; precision <= 9; ++precision) {
+    n = snprintf(buf, sizeof(buf), "%.*g", precision, d);
+    if (strtof(buf, NULL) == d)
+      break;
+  }
+  out->assign(buf, n);
+}
+
+// A key being looked for, with the last value of it in the current
+// record.
+template<typename Path, typename Value>
+struct ScanKey {
+  const Rule::Key* key;
+  Path path;
+  Value value;
+  bool found;
+};
+
+// The keys of a rule being looked for in the data. A record is made of
+// every part of the data at the steps of `scope', which the paths of the
+// keys go through in common, the keys are at most 64 so that a set of
+// them is a mask.
+template<typename Path, typename Value, typename Step>
+struct KeyScan {
+  typedef ScanKey<Path, Value> Key;
+
+  std::vector<Key> keys;
+  const Step* scope;
+  size_t scope_size;
+  RecordSet* res;
+
+  // Parses the paths of the rule keys with `parse', `steps' gives the
+  // steps of a path. Returns false if there are no keys or too many, or
+  // a path is malformed, which the rules are checked for when they're
+  // loaded.
+  bool Init(const std::vector<Rule::Key>& rule_keys, size_t max_keys,
+            bool (*parse)(const std::string& mapped, Path* path),
+            const Step* (*steps)(const Path& path), RecordSet* records) {
+    if (rule_keys.empty() || rule_keys.size() > max_keys ||
+        rule_keys.size() > 64) {
+      return false;
+    }
+    keys.resize(rule_keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      keys[i].key = &rule_keys[i];
+      if (!parse(rule_keys[i].mapped, &keys[i].path))
+        return false;
+    }
+
+    // The records are where the paths of the keys part.
+    const Step* head = steps(keys[0].path);
+    size_t n = keys[0].path.size - 1;
+    for (size_t i = 1; i < keys.size(); ++i) {
+      const Step* path = steps(keys[i].path);
+      size_t j = 0;
+      while (j < n && j + 1 < keys[i].path.size && path[j] == head[j])
+        ++j;
+      n = j;
+    }
+    scope = head;
+    scope_size = n;
+    res = records;
+    return true;
+  }
+
+  // Forgets the values of the last record, returns the mask of all keys.
+  uint64_t Begin() {
+    for (size_t i = 0; i < keys.size(); ++i)
+      keys[i].found = false;
+    return keys.size() == 64 ? ~0ULL : (1ULL << keys.size()) - 1;
+  }
+
+  // Keeps the value for the keys in `mask' whose paths end at `depth'.
+  void Found(uint64_t mask, size_t depth, const Value& value) {
+    for (uint64_t m = mask; m; m &= m - 1) {
+      Key& key = keys[__builtin_ctzll(m)];
+      if (key.path.size == depth) {
+        key.value = value;
+        key.found = true;
+      }
+    }
+  }
+
+  // Makes a record if every key has been found and passes its filter,
+  // `format' writes the value of a key as text.
+  void MakeRecord(void (*format)(const Key& key, std::string* out)) {
+    Record records;
+    std::string value;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if (!keys[i].found)
+        return;
+      format(keys[i], &value);
+      if (value.empty())
+        return;
+      const auto& key = *keys[i].key;
+      if (!key.filter || key.filter(&value))
+        records[key.key] = value;
+    }
+    if (records.size() == keys.size())
+      res->push_back(records);
+  }
+};
+
+} // namespace ext
+
+#endif // EXTRACTOR_KEY_SCAN_H_
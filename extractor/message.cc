@@ -5,15 +5,21 @@
 #include <cassert>
 #include <cstring>
 #include <map>
+#include <deque>
+#include <vector>
+#include <utility>
 #include <algorithm>
 
 #include "extractor/fhmf.h"
+#include "extractor/http_head.h"
 #include "extractor/third_party/http_parser.h"
 
 namespace ext {
 typedef Message::Slice::Type SliceType;
 typedef Fhmf::Field::Type FieldType;
 
+bool g_fast_http_probe = true;
+
 namespace {
 // HTTP probe
 struct HttpOpaque {
@@ -21,16 +27,22 @@ struct HttpOpaque {
   bool on_host;
   bool on_cookie;
   bool on_user_agent;
-  const char* body_begin;
-  const char* body_end;
-
-  explicit HttpOpaque(std::map<SliceType, Message::Slice>* slices)
+  // The pieces of the body as http_parser gives them, a chunked body
+  // comes in one per chunk.
+  std::vector<std::pair<const char*, size_t> > body;
+  // header fields by offset from `begin', they're given to the head
+  // slice once it's known
+  const char* begin;
+  std::vector<Message::Slice::Header> headers;
+  bool chunked;
+
+  HttpOpaque(std::map<SliceType, Message::Slice>* slices, const char* begin)
     : slices(slices),
       on_host(false),
       on_cookie(false),
       on_user_agent(false),
-      body_begin(NULL),
-      body_end(NULL) {}
+      begin(begin),
+      chunked(false) {}
 };
 
 int on_url(http_parser* hp, const char* s, size_t n) {
@@ -57,6 +69,10 @@ int on_url(http_parser* hp, const char* s, size_t n) {
 int on_header_field(http_parser* hp, const char* s, size_t n) {
   if (n > 0) {
     HttpOpaque* op = reinterpret_cast<HttpOpaque*>(hp->data);
+    Message::Slice::Header header = { static_cast<size_t>(s - op->begin), n,
+                                      0, 0 };
+    op->headers.push_back(header);
+
     const char* host = "Host";
     const char* cookie = "Cookie";
     const char* user_agent = "User-Agent";
@@ -78,6 +94,10 @@ int on_header_field(http_parser* hp, const char* s, size_t n) {
 int on_header_value(http_parser* hp, const char* s, size_t n) {
   HttpOpaque* op = reinterpret_cast<HttpOpaque*>(hp->data);
   std::map<SliceType, Message::Slice>* slices = op->slices;
+  if (!op->headers.empty()) {
+    op->headers.back().value = s - op->begin;
+    op->headers.back().value_size = n;
+  }
   if (op->on_host) {
     if (n == 0)
       return -1;
@@ -95,40 +115,92 @@ int on_header_value(http_parser* hp, const char* s, size_t n) {
   return 0;
 }
 
+int on_headers_complete(http_parser* hp) {
+  HttpOpaque* op = reinterpret_cast<HttpOpaque*>(hp->data);
+  op->chunked = (hp->flags & F_CHUNKED) != 0;
+  return 0;
+}
+
 int on_body(http_parser* hp, const char* s, size_t n) {
+  HttpOpaque* op = reinterpret_cast<HttpOpaque*>(hp->data);
   if (n > 0) {
-    HttpOpaque* op = reinterpret_cast<HttpOpaque*>(hp->data);
-    op->body_begin = s;
-    op->body_end = s + n;
+    if (!op->body.empty() &&
+        op->body.back().first + op->body.back().second == s) {
+      op->body.back().second += n;
+    } else {
+      op->body.push_back(std::make_pair(s, n));
+    }
   }
   return 0;
 }
 
+// The parser stops at the end of the message, a pipelined one after it
+// is parsed on its own.
+int on_message_complete(http_parser* hp) {
+  http_parser_pause(hp, 1);
+  return 0;
+}
+
 void init_http_parser_settings(http_parser_settings* s) {
   http_parser_settings_init(s);
   s->on_url = on_url;
   s->on_header_field = on_header_field;
   s->on_header_value = on_header_value;
+  s->on_headers_complete = on_headers_complete;
   s->on_body = on_body;
+  s->on_message_complete = on_message_complete;
 }
 
-void ParseHttp(const char* s, size_t n,
-               bool up_strm,
-               std::map<SliceType, Message::Slice>* slices) {
-  assert(s && n > 0);
-  http_parser_type type =
-      up_strm ? HTTP_REQUEST : HTTP_RESPONSE;
+// Gives the head parsed by ParseHttpHead to the callbacks of http_parser
+// in the order it would, so that the slices are made the same way.
+// Returns false if a callback has rejected it.
+bool feed_http_head(const char* s, const HttpHead& head, bool up_strm,
+                    HttpOpaque* op) {
   http_parser hp;
-  http_parser_init(&hp, type);
-  HttpOpaque op(slices);
-  hp.data = reinterpret_cast<void*>(&op);
-  http_parser_settings settings;
-  init_http_parser_settings(&settings);
-
-  http_parser_execute(&hp, &settings, s, n);
-  if (hp.http_errno == HPE_CB_url ||          // not found host
-      hp.http_errno == HPE_CB_header_value) { // not found url
-    return;
+  hp.data = reinterpret_cast<void*>(op);
+  if (up_strm && on_url(&hp, head.url.data(), head.url.size()) != 0)
+    return false;
+  for (size_t i = 0; i < head.headers.size(); ++i) {
+    const HttpHead::Header& h = head.headers[i];
+    if (on_header_field(&hp, h.name.data(), h.name.size()) != 0 ||
+        on_header_value(&hp, h.value.data(), h.value.size()) != 0)
+      return false;
+  }
+  if (head.body_size > 0)
+    on_body(&hp, s + head.body, head.body_size);
+  return true;
+}
+
+// Parses the first HTTP message of the buffer into the slices. Returns
+// the size of the message, which is the rest of the buffer if it's cut
+// short or malformed.
+size_t ParseHttp(const char* s, size_t n,
+                 bool up_strm,
+                 std::map<SliceType, Message::Slice>* slices) {
+  assert(s && n > 0);
+  HttpOpaque op(slices, s);
+  HttpHead fast;
+  size_t size = n;
+  if (g_fast_http_probe && ParseHttpHead(s, n, up_strm, &fast)) {
+    if (!feed_http_head(s, fast, up_strm, &op))
+      return size;
+    size = fast.body + fast.body_size;
+  } else {
+    http_parser_type type =
+        up_strm ? HTTP_REQUEST : HTTP_RESPONSE;
+    http_parser hp;
+    http_parser_init(&hp, type);
+    hp.data = reinterpret_cast<void*>(&op);
+    http_parser_settings settings;
+    init_http_parser_settings(&settings);
+
+    size_t parsed = http_parser_execute(&hp, &settings, s, n);
+    if (hp.http_errno == HPE_CB_url ||          // not found host
+        hp.http_errno == HPE_CB_header_value) { // not found url
+      return size;
+    }
+    if (hp.http_errno == HPE_PAUSED && parsed > 0)
+      size = parsed;
   }
 
   SliceType head = up_strm ?
@@ -136,17 +208,33 @@ void ParseHttp(const char* s, size_t n,
   SliceType payload = up_strm ?
       SliceType::HTTP_REQ : SliceType::HTTP_RES;
 
-  if (op.body_begin && op.body_end) {
-    assert(op.body_begin > s);
-    assert(op.body_end > op.body_begin);
+  if (!op.body.empty()) {
+    assert(op.body[0].first > s);
 
-    n = op.body_begin - s;
+    // The head of a chunked body ends before the size line of the first
+    // chunk, which ends with a CRLF.
+    const char* head_end = op.body[0].first;
+    if (op.chunked) {
+      head_end -= 2;
+      while (head_end > s && head_end[-1] != '\n')
+        --head_end;
+    }
+    n = head_end - s;
     (*slices)[head].str.assign(s, n);
-    n = op.body_end - op.body_begin;
-    (*slices)[payload].str.assign(op.body_begin, n);
+    // The chunks are joined as they're copied into the slice.
+    size_t body_size = 0;
+    for (size_t i = 0; i < op.body.size(); ++i)
+      body_size += op.body[i].second;
+    std::string& str = (*slices)[payload].str;
+    str.clear();
+    str.reserve(body_size);
+    for (size_t i = 0; i < op.body.size(); ++i)
+      str.append(op.body[i].first, op.body[i].second);
   } else {
-    (*slices)[head].str.assign(s, n);
+    (*slices)[head].str.assign(s, size);
   }
+  (*slices)[head].headers.swap(op.headers);
+  return size;
 }
 
 void ProbeHttp(const Fhmf::Field& field,
@@ -181,6 +269,13 @@ void ProbeBinary(const Fhmf::Field& field,
 
 }
 
+// Whether the field is of a request, Request.http/tcp/udp.
+bool upstream(const Fhmf::Field& field) {
+  const std::string& fname =
+      SafeFind(field.options, FieldType::FILE_NAME);
+  return fname.compare(0, 8, "Request.") == 0;
+}
+
 Protocol::Type MessageTypeMapped(const std::string& key) {
   static const std::map<std::string, Protocol::Type> map{
     { "application/http", Protocol::Type::HTTP   },
@@ -229,6 +324,65 @@ Message Probe(const char* s, size_t n) {
   return msg;
 }
 
+std::vector<Message> ProbeAll(const char* s, size_t n) {
+  std::vector<Message> msgs;
+  Fhmf fhmf;
+  if (!ParseFhmf(s, n, &fhmf)) {
+    while (n > 0) {
+      msgs.push_back(Message());
+      msgs.back().type = Protocol::Type::HTTP;
+      size_t size = ParseHttp(s, n, true, &msgs.back().slices);
+      s += size;
+      n -= size;
+    }
+    return msgs;
+  }
+
+  // The messages whose requests wait for their responses by protocol,
+  // responses come in the order of the requests.
+  std::map<Protocol::Type, std::deque<size_t> > pending;
+  const std::vector<Fhmf::Field>& fields = fhmf.fields;
+  for (size_t i = 0; i < fields.size(); ++i) {
+    const Fhmf::Field& field = fields[i];
+    if (field.payload_len == 0)
+      continue;
+    Protocol::Type type = MessageTypeMapped(
+        SafeFind(field.options, FieldType::MIME_TYPE));
+    if (type == Protocol::Type::UNKNOWN)
+      continue;
+
+    bool upstrm = upstream(field);
+    std::deque<size_t>& waiting = pending[type];
+    const char* p = field.payload_ptr;
+    size_t left = field.payload_len;
+    while (left > 0) {
+      size_t index;
+      if (upstrm || waiting.empty()) {
+        index = msgs.size();
+        msgs.push_back(Message());
+        msgs.back().type = type;
+        if (upstrm)
+          waiting.push_back(index);
+      } else {
+        index = waiting.front();
+        waiting.pop_front();
+      }
+
+      // A HTTP field may have pipelined messages, a TCP/UDP one is a
+      // message as a whole.
+      if (type == Protocol::Type::HTTP) {
+        size_t size = ParseHttp(p, left, upstrm, &msgs[index].slices);
+        p += size;
+        left -= size;
+      } else {
+        ProbeBinary(field, &msgs[index].slices);
+        left = 0;
+      }
+    }
+  }
+  return msgs;
+}
+
 Message MakeHttpMessage(const char* up, size_t up_size,
                         const char* down, size_t down_size) {
   Message msg;
@@ -5,12 +5,19 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 #include <map>
+#include <tuple>
 
 #include "extractor/rule_define.h"
 #include "extractor/trivial.h"
 
 namespace ext {
+class JsonIndex;
+class ParamIndex;
+class JsonDocument;
+class XmlDocument;
+
 struct Message {
 public:
   struct Slice {
@@ -36,19 +43,75 @@ public:
       BIN_RES,
     };
 
-    bool codec;
+    // A header field of the HTTP_REQ_HEAD/HTTP_RES_HEAD slice, its name
+    // and value are offsets into the slice.
+    struct Header {
+      size_t name;
+      size_t name_size;
+      size_t value;
+      size_t value_size;
+    };
+
     std::string str;
-    Slice(): codec(false) {}
+    // The header fields of a head slice in the order they appear.
+    std::vector<Header> headers;
   };
 
+  // The slice that has been decoded with a codec chain, it's built
+  // lazily by parsers and never written back to the raw slice, so
+  // that categories with different codec chains are not affected by
+  // each other.
+  struct View {
+    int error;
+    std::string str;
+    // How many bytes it was decoded for, and whether the inflation
+    // stopped there, a view that's too short is decoded again.
+    size_t limit;
+    bool truncated;
+    View(): error(0), limit(0), truncated(false) {}
+  };
+  typedef std::pair<Slice::Type, std::vector<Codec::Type> > ViewKey;
+
+  // The JSON indexes of the slices and views, keyed by the string they
+  // were built on, so that JSON rules on the same content share one.
+  typedef std::pair<const char*, size_t> IndexKey;
+  // The JSON/XML documents parsed for several rules at once, keyed by the
+  // string they were parsed from and the head and tail stripped from it.
+  typedef std::tuple<const char*, size_t, std::string, std::string>
+      DocumentKey;
+  // The value of a header of a head slice, by the header's name id (see
+  // RuleTree::header_ids) and whether it has been URL decoded.
+  typedef std::tuple<Slice::Type, int, bool> HeaderKey;
 
   Protocol::Type type;
   std::map<Slice::Type, Slice> slices;
+  std::map<ViewKey, View> views;
+  std::map<IndexKey, std::shared_ptr<JsonIndex> > json_indexes;
+  // The parameter indexes of the query, cookie and form body slices and
+  // views, keyed the same way, so that Param rules share one.
+  std::map<IndexKey, std::shared_ptr<ParamIndex> > param_indexes;
+  // The first header of every name id of the head slices, -1 if there's
+  // none, so that Header rules find theirs without scanning the head.
+  std::map<Slice::Type, std::vector<int> > header_tables;
+  std::map<HeaderKey, View> header_views;
+  std::map<DocumentKey, std::shared_ptr<JsonDocument> > json_documents;
+  std::map<DocumentKey, std::shared_ptr<XmlDocument> > xml_documents;
 
   Message(): type(Protocol::Type::UNKNOWN) {}
 };
 
+// Whether the HTTP heads are parsed by ParseHttpHead when they can be,
+// http_parser parses all of them otherwise. Both make the same slices.
+extern bool g_fast_http_probe;
+
+// Probes the first message of the buffer, the fields of a FHMF buffer
+// are made into one message.
 Message Probe(const char* s, size_t n);
+// Probes every transaction of the buffer, each into a message of its
+// own: the request and response fields of a FHMF buffer are paired in
+// order, a response with no request before it makes one alone, and the
+// pipelined HTTP messages of a field or of a raw request are split.
+std::vector<Message> ProbeAll(const char* s, size_t n);
 Message MakeHttpMessage(const char* up, size_t up_size,
                         const char* down, size_t down_size);
 Message::Slice& Slice(Message* msg, Message::Slice::Type type);
@@ -39,6 +39,15 @@ int main(int argc, char* argv[]) {
       std::cout << Slice(&msg, Message::Slice::Type(i)).str
           << std::endl;
     }
+    for (int i = Message::Slice::HTTP_REQ_HEAD;
+        i <= Message::Slice::HTTP_RES_HEAD; i += 2) {
+      const Message::Slice& head = Slice(&msg, Message::Slice::Type(i));
+      for (size_t j = 0; j < head.headers.size(); ++j) {
+        const Message::Slice::Header& h = head.headers[j];
+        std::cout << head.str.substr(h.name, h.name_size) << ": "
+            << head.str.substr(h.value, h.value_size) << std::endl;
+      }
+    }
     break;
   }
   case Protocol::Type::TCP:
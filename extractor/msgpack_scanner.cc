@@ -0,0 +1,340 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include "extractor/msgpack_scanner.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "extractor/key_scan.h"
+
+namespace ext {
+namespace {
+enum MpKind { NIL, BOOL, INT, UINT, FLOAT, STR, BIN, EXT, ARRAY, MAP };
+
+// The head of a value. A scalar is read whole, the `count' elements or
+// pairs of an array or map follow it.
+struct MpValue {
+  MpKind kind;
+  bool b;
+  int64_t i;
+  uint64_t u;
+  double d;
+  bool single;  // whether d was a float32
+  string_view bytes;
+  uint64_t count;
+};
+
+// Reads an n-byte big-endian unsigned integer.
+bool read_be(const char** p, const char* end, size_t n, uint64_t* v) {
+  if (static_cast<size_t>(end - *p) < n)
+    return false;
+  uint64_t r = 0;
+  for (size_t i = 0; i < n; ++i)
+    r = r << 8 | static_cast<uint8_t>((*p)[i]);
+  *p += n;
+  *v = r;
+  return true;
+}
+
+// Reads the head of the value at *p. Returns false if it's malformed.
+bool read_value(const char** p, const char* end, MpValue* v) {
+  if (*p == end)
+    return false;
+  uint8_t b = static_cast<uint8_t>(*(*p)++);
+  uint64_t n;
+  if (b <= 0x7F) {
+    v->kind = UINT;
+    v->u = b;
+    return true;
+  }
+  if (b >= 0xE0) {
+    v->kind = INT;
+    v->i = static_cast<int8_t>(b);
+    return true;
+  }
+  if (b <= 0x8F) {
+    v->kind = MAP;
+    v->count = b & 0x0F;
+    return true;
+  }
+  if (b <= 0x9F) {
+    v->kind = ARRAY;
+    v->count = b & 0x0F;
+    return true;
+  }
+  if (b <= 0xBF) {
+    v->kind = STR;
+    return read_bytes(p, end, b & 0x1F, &v->bytes);
+  }
+
+  switch (b) {
+  case 0xC0:
+    v->kind = NIL;
+    return true;
+  case 0xC2: case 0xC3:
+    v->kind = BOOL;
+    v->b = b == 0xC3;
+    return true;
+  case 0xC4: case 0xC5: case 0xC6:
+    v->kind = BIN;
+    return read_be(p, end, 1 << (b - 0xC4), &n) &&
+           read_bytes(p, end, n, &v->bytes);
+  case 0xC7: case 0xC8: case 0xC9:
+    // The type byte is kept along with the data.
+    v->kind = EXT;
+    return read_be(p, end, 1 << (b - 0xC7), &n) &&
+           read_bytes(p, end, n + 1, &v->bytes);
+  case 0xCA: {
+    float f;
+    uint32_t bits;
+    if (!read_be(p, end, 4, &n))
+      return false;
+    bits = static_cast<uint32_t>(n);
+    memcpy(&f, &bits, sizeof(f));
+    v->kind = FLOAT;
+    v->d = f;
+    v->single = true;
+    return true;
+  }
+  case 0xCB:
+    if (!read_be(p, end, 8, &n))
+      return false;
+    memcpy(&v->d, &n, sizeof(v->d));
+    v->kind = FLOAT;
+    v->single = false;
+    return true;
+  case 0xCC: case 0xCD: case 0xCE: case 0xCF:
+    v->kind = UINT;
+    return read_be(p, end, 1 << (b - 0xCC), &v->u);
+  case 0xD0:
+    v->kind = INT;
+    if (!read_be(p, end, 1, &n))
+      return false;
+    v->i = static_cast<int8_t>(n);
+    return true;
+  case 0xD1:
+    v->kind = INT;
+    if (!read_be(p, end, 2, &n))
+      return false;
+    v->i = static_cast<int16_t>(n);
+    return true;
+  case 0xD2:
+    v->kind = INT;
+    if (!read_be(p, end, 4, &n))
+      return false;
+    v->i = static_cast<int32_t>(n);
+    return true;
+  case 0xD3:
+    v->kind = INT;
+    if (!read_be(p, end, 8, &n))
+      return false;
+    v->i = static_cast<int64_t>(n);
+    return true;
+  case 0xD4: case 0xD5: case 0xD6: case 0xD7: case 0xD8:
+    v->kind = EXT;
+    return read_bytes(p, end, 1 + (1 << (b - 0xD4)), &v->bytes);
+  case 0xD9: case 0xDA: case 0xDB:
+    v->kind = STR;
+    return read_be(p, end, 1 << (b - 0xD9), &n) &&
+           read_bytes(p, end, n, &v->bytes);
+  case 0xDC: case 0xDD:
+    v->kind = ARRAY;
+    return read_be(p, end, 2 << (b - 0xDC), &v->count);
+  case 0xDE: case 0xDF:
+    v->kind = MAP;
+    return read_be(p, end, 2 << (b - 0xDE), &v->count);
+  default: return false;
+  }
+}
+
+// Skips the items of the value whose head has been read, the arrays and
+// maps in them are counted rather than recursed into.
+bool skip_items(const char** p, const char* end, const MpValue& v) {
+  uint64_t left = 0;
+  if (v.kind == ARRAY)
+    left = v.count;
+  else if (v.kind == MAP)
+    left = 2 * v.count;
+  MpValue item;
+  while (left > 0) {
+    // Every item takes a byte at least.
+    if (left > static_cast<uint64_t>(end - *p) ||
+        !read_value(p, end, &item))
+      return false;
+    --left;
+    if (item.kind == ARRAY)
+      left += item.count;
+    else if (item.kind == MAP)
+      left += 2 * item.count;
+  }
+  return true;
+}
+
+// Gets the name a map key is matched by into `name', which may point
+// into `buf'. Returns false if it can't be matched.
+bool key_name(const MpValue& k, char (&buf)[24], string_view* name) {
+  if (k.kind == STR || k.kind == BIN) {
+    *name = k.bytes;
+    return true;
+  }
+  if (k.kind != INT && k.kind != UINT)
+    return false;
+  bool negative = k.kind == INT && k.i < 0;
+  uint64_t u = k.kind == UINT ? k.u : static_cast<uint64_t>(k.i);
+  if (negative)
+    u = 0 - u;
+  char* end = buf + sizeof(buf);
+  char* s = end;
+  do {
+    *--s = static_cast<char>('0' + u % 10);
+    u /= 10;
+  } while (u);
+  if (negative)
+    *--s = '-';
+  *name = string_view(s, end - s);
+  return true;
+}
+
+typedef KeyScan<MsgPackPath, MpValue, string_view> MpScan;
+typedef MpScan::Key MpKey;
+
+const string_view* path_keys(const MsgPackPath& path) {
+  return path.keys;
+}
+
+void format_value(const MpKey& key, std::string* out) {
+  const MpValue& v = key.value;
+  switch (v.kind) {
+  case BOOL: *out = v.b ? "true" : "false"; break;
+  case INT: *out = std::to_string(v.i); break;
+  case UINT: *out = std::to_string(v.u); break;
+  case FLOAT:
+    if (v.single)
+      format_float(static_cast<float>(v.d), out);
+    else
+      format_double(v.d, out);
+    break;
+  default: out->assign(v.bytes.data(), v.bytes.size()); break;
+  }
+}
+
+// Reads the value whose head is `v' for the keys in `mask', which are
+// `depth' keys down their paths: the ones that end there take a scalar,
+// the others look into a map. Only the values on the paths are entered.
+bool collect(MpScan* scan, const char** p, const char* end,
+             const MpValue& v, size_t depth, uint64_t mask, size_t level) {
+  if (v.kind != ARRAY && v.kind != MAP) {
+    if (v.kind != NIL && v.kind != EXT)
+      scan->Found(mask, depth, v);
+    return true;
+  }
+  if (level == kMsgPackMaxNesting)
+    return false;
+
+  MpValue k, item;
+  char buf[24];
+  for (uint64_t i = 0; i < v.count; ++i) {
+    uint64_t down = mask;
+    if (v.kind == MAP) {
+      string_view name;
+      if (!read_value(p, end, &k) || !skip_items(p, end, k))
+        return false;
+      down = 0;
+      if (key_name(k, buf, &name)) {
+        for (uint64_t m = mask; m; m &= m - 1) {
+          size_t n = __builtin_ctzll(m);
+          const MsgPackPath& path = scan->keys[n].path;
+          if (path.size > depth && path.keys[depth] == name)
+            down |= 1ULL << n;
+        }
+      }
+    }
+    if (!read_value(p, end, &item))
+      return false;
+    if (!down) {
+      if (!skip_items(p, end, item))
+        return false;
+    } else if (!collect(scan, p, end, item, depth + (v.kind == MAP), down,
+                        level + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool make_record(MpScan* scan, const char** p, const char* end,
+                 const MpValue& map, size_t level) {
+  if (!collect(scan, p, end, map, scan->scope_size, scan->Begin(), level))
+    return false;
+  scan->MakeRecord(format_value);
+  return true;
+}
+
+// Walks the value whose head is `v' down to the record maps.
+bool find_records(MpScan* scan, const char** p, const char* end,
+                  const MpValue& v, size_t depth, size_t level) {
+  if (v.kind != ARRAY && v.kind != MAP)
+    return true;
+  if (level == kMsgPackMaxNesting)
+    return false;
+  if (v.kind == MAP && depth == scan->scope_size)
+    return make_record(scan, p, end, v, level);
+
+  MpValue k, item;
+  char buf[24];
+  for (uint64_t i = 0; i < v.count; ++i) {
+    bool on_path = true;
+    if (v.kind == MAP) {
+      string_view name;
+      if (!read_value(p, end, &k) || !skip_items(p, end, k))
+        return false;
+      on_path = key_name(k, buf, &name) && name == scan->scope[depth];
+    }
+    if (!read_value(p, end, &item))
+      return false;
+    if (!on_path) {
+      if (!skip_items(p, end, item))
+        return false;
+    } else if (!find_records(scan, p, end, item, depth + (v.kind == MAP),
+                             level + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+bool ParseMsgPackPath(const std::string& mapped, MsgPackPath* path) {
+  string_view s(mapped);
+  path->size = 0;
+  while (true) {
+    size_t dot = s.find('.');
+    string_view key = s.substr(0, dot);
+    if (key.empty() || path->size == kMsgPackMaxDepth)
+      return false;
+    path->keys[path->size++] = key;
+    if (dot == string_view::npos)
+      return true;
+    s.remove_prefix(dot + 1);
+  }
+}
+
+void ScanMsgPack(string_view data, const std::vector<Rule::Key>& keys,
+                 RecordSet* res) {
+  MpScan scan;
+  if (!scan.Init(keys, kMsgPackMaxKeys, ParseMsgPackPath, path_keys, res))
+    return;
+
+  const char* p = data.begin();
+  const char* end = data.end();
+  MpValue v;
+  while (p != end) {
+    if (!read_value(&p, end, &v) ||
+        !find_records(&scan, &p, end, v, 0, 0))
+      return;
+  }
+}
+
+} // namespace ext
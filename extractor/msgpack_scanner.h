@@ -0,0 +1,51 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#ifndef EXTRACTOR_MSGPACK_SCANNER_H_
+#define EXTRACTOR_MSGPACK_SCANNER_H_
+
+#include <string>
+#include <vector>
+
+#include "extractor/rule.h"
+#include "extractor/parser.h"
+#include "extractor/third_party/string_view.h"
+
+namespace ext {
+// The longest path of a MSGPACK key.
+const size_t kMsgPackMaxDepth = 16;
+// The most keys a MSGPACK rule may have.
+const size_t kMsgPackMaxKeys = 64;
+// Arrays and maps nested deeper than this on the paths make the data
+// malformed, the ones skipped may nest any deeper.
+const size_t kMsgPackMaxNesting = 64;
+
+// A MSGPACK key is mapped to a path of map keys, `user.phone' is the
+// value of `phone' in the map that's the value of `user'. A string key
+// matches its bytes, an integer one its decimal.
+struct MsgPackPath {
+  string_view keys[kMsgPackMaxDepth];
+  size_t size;
+};
+
+// Parses the path of a MSGPACK key, which points into `mapped'. Returns
+// false if it's malformed.
+bool ParseMsgPackPath(const std::string& mapped, MsgPackPath* path);
+
+// Extracts the records of the keys from MessagePack data, a value or a
+// stream of them, which is walked once without a schema.
+//
+// Arrays are looked through, every element of one is where the array
+// is. A record is made of every map at the keys the paths of the keys go
+// through in common, or of every top map if there are none. It takes
+// the last scalar value of each key inside it and needs every key:
+// integers and floats read as decimals, booleans as `true' or `false',
+// strings and binaries as their bytes, nils and extensions are ignored.
+// Values off the paths are skipped where they are, by counting rather
+// than recursion. Malformed data yields no record from the maps that
+// hold the error, nothing after it is read.
+void ScanMsgPack(string_view data, const std::vector<Rule::Key>& keys,
+                 RecordSet* res);
+
+} // namespace ext
+
+#endif // EXTRACTOR_MSGPACK_SCANNER_H_
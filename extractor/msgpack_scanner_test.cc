@@ -0,0 +1,476 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "extractor/msgpack_scanner.h"
+#include "extractor/filter.h"
+#include "extractor/scanner_test.h"
+
+using namespace ext;
+
+void BigEndian(std::string* s, uint64_t v, int size) {
+  for (int i = size - 1; i >= 0; --i)
+    s->push_back(static_cast<char>(v >> (8 * i)));
+}
+
+void Uint(std::string* s, uint64_t v) {
+  if (v < 0x80) {
+    s->push_back(static_cast<char>(v));
+  } else if (v <= 0xFF) {
+    s->push_back('\xCC');
+    BigEndian(s, v, 1);
+  } else if (v <= 0xFFFF) {
+    s->push_back('\xCD');
+    BigEndian(s, v, 2);
+  } else if (v <= 0xFFFFFFFF) {
+    s->push_back('\xCE');
+    BigEndian(s, v, 4);
+  } else {
+    s->push_back('\xCF');
+    BigEndian(s, v, 8);
+  }
+}
+
+void Int(std::string* s, int64_t v) {
+  if (v >= 0) {
+    Uint(s, v);
+  } else if (v >= -32) {
+    s->push_back(static_cast<char>(v));
+  } else if (v >= -128) {
+    s->push_back('\xD0');
+    BigEndian(s, v, 1);
+  } else if (v >= -32768) {
+    s->push_back('\xD1');
+    BigEndian(s, v, 2);
+  } else if (v >= -2147483648LL) {
+    s->push_back('\xD2');
+    BigEndian(s, v, 4);
+  } else {
+    s->push_back('\xD3');
+    BigEndian(s, v, 8);
+  }
+}
+
+void Str(std::string* s, const std::string& v) {
+  if (v.size() < 32) {
+    s->push_back(static_cast<char>(0xA0 | v.size()));
+  } else if (v.size() <= 0xFF) {
+    s->push_back('\xD9');
+    BigEndian(s, v.size(), 1);
+  } else {
+    s->push_back('\xDA');
+    BigEndian(s, v.size(), 2);
+  }
+  s->append(v);
+}
+
+void Container(std::string* s, bool map, uint64_t n) {
+  if (n < 16) {
+    s->push_back(static_cast<char>((map ? 0x80 : 0x90) | n));
+  } else if (n <= 0xFFFF) {
+    s->push_back(map ? '\xDE' : '\xDC');
+    BigEndian(s, n, 2);
+  } else {
+    s->push_back(map ? '\xDF' : '\xDD');
+    BigEndian(s, n, 4);
+  }
+}
+
+void Map(std::string* s, uint64_t n) { Container(s, true, n); }
+void Array(std::string* s, uint64_t n) { Container(s, false, n); }
+
+void TestCaseMsgPackPath() {
+  MsgPackPath path;
+  assert(ParseMsgPackPath("user.phone", &path));
+  assert(path.size == 2 && path.keys[0] == "user" &&
+         path.keys[1] == "phone");
+  assert(ParseMsgPackPath("-1", &path));
+  assert(path.size == 1 && path.keys[0] == "-1");
+  assert(ParseMsgPackPath("a.b.c.d.e.f.g.h.i.j.k.l.m.n.o.p", &path));
+
+  const char* invalid[] = {
+    "", ".", "a.", ".a", "a..b", "a.b.c.d.e.f.g.h.i.j.k.l.m.n.o.p.q",
+  };
+  for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+    assert(!ParseMsgPackPath(invalid[i], &path));
+}
+
+void TestCaseScanMsgPack() {
+  static const char* const names[] = {
+    "PHONENUM", "user.phones.number", "NICKNAME", "user.phones.name",
+  };
+  auto keys = MakeKeys(names, 4);
+
+  // {"id": 7, "user": {"x": [1, {}], "phones": [
+  //   {"name": "a", "number": "13812345678"}, {"number": "13912345678"},
+  //   {"name": "b", "number": "13712345678", "name": "c"}]}}
+  std::string data;
+  Map(&data, 2);
+  Str(&data, "id");
+  Uint(&data, 7);
+  Str(&data, "user");
+  Map(&data, 2);
+  Str(&data, "x");
+  Array(&data, 2);
+  Uint(&data, 1);
+  Map(&data, 0);
+  Str(&data, "phones");
+  Array(&data, 3);
+  Map(&data, 2);
+  Str(&data, "name");
+  Str(&data, "a");
+  Str(&data, "number");
+  Str(&data, "13812345678");
+  Map(&data, 1);
+  Str(&data, "number");
+  Str(&data, "13912345678");
+  Map(&data, 3);
+  Str(&data, "name");
+  Str(&data, "b");
+  Str(&data, "number");
+  Str(&data, "13712345678");
+  Str(&data, "name");
+  Str(&data, "c");
+
+  RecordSet res;
+  ScanMsgPack(data, keys, &res);
+  assert(res.size() == 2);
+  assert(res[0]["PHONENUM"] == "13812345678" && res[0]["NICKNAME"] == "a");
+  assert(res[1]["PHONENUM"] == "13712345678" && res[1]["NICKNAME"] == "c");
+
+  // A stream of values, each top one is looked into.
+  res.clear();
+  ScanMsgPack(data + data, keys, &res);
+  assert(res.size() == 4);
+
+  // Truncated data yields nothing from the maps holding the error.
+  res.clear();
+  ScanMsgPack(data.substr(0, data.size() - 1), keys, &res);
+  assert(res.size() == 1);
+  res.clear();
+  ScanMsgPack(data + "\xC1", keys, &res);
+  assert(res.size() == 2);
+
+  // Every kind of scalar, integer keys and values off the paths of any
+  // kind and depth.
+  static const char* const kinds[] = {
+    "A", "a", "B", "b", "C", "c", "D", "d", "E", "e", "F", "f",
+    "G", "g", "H", "-3", "I", "i", "J", "j", "K", "k",
+  };
+  keys = MakeKeys(kinds, 22);
+  double lat = 39.9042;
+  float lon = 116.4074f;
+  uint64_t lat_bits;
+  uint32_t lon_bits;
+  memcpy(&lat_bits, &lat, 8);
+  memcpy(&lon_bits, &lon, 4);
+  data.clear();
+  Map(&data, 15);
+  Str(&data, "a");
+  Uint(&data, 18446744073709551615ULL);
+  Str(&data, "b");
+  Int(&data, -5);
+  Str(&data, "c");
+  Int(&data, -40000);
+  Str(&data, "d");
+  data.push_back('\xCB');
+  BigEndian(&data, lat_bits, 8);
+  Str(&data, "e");
+  data.push_back('\xCA');
+  BigEndian(&data, lon_bits, 4);
+  Str(&data, "f");
+  data.push_back('\xC3');
+  Str(&data, "g");
+  data += std::string("\xC4\x03\x01\x02\x03", 5);
+  Int(&data, -3);
+  data.push_back('\xC2');
+  Str(&data, "i");
+  Str(&data, std::string(300, 'x'));
+  Str(&data, "j");
+  Str(&data, "1");
+  // nils and extensions don't take the place of a value
+  Str(&data, "j");
+  data.push_back('\xC0');
+  Str(&data, "j");
+  data += std::string("\xD4\x01\x02", 3);
+  Str(&data, "skipped");
+  for (int i = 0; i < 100; ++i)
+    Array(&data, 1);
+  data += std::string("\xC7\x02\x05\x01\x02", 5);
+  Str(&data, "k");
+  Array(&data, 2);
+  Str(&data, "first");
+  Array(&data, 1);
+  Str(&data, "last");
+  Uint(&data, 9);
+  Map(&data, 1);
+  Str(&data, "k");
+  Str(&data, "nested");
+  res.clear();
+  ScanMsgPack(data, keys, &res);
+  assert(res.size() == 1);
+  assert(res[0]["A"] == "18446744073709551615");
+  assert(res[0]["B"] == "-5");
+  assert(res[0]["C"] == "-40000");
+  assert(res[0]["D"] == "39.9042");
+  assert(res[0]["E"] == "116.4074");
+  assert(res[0]["F"] == "true");
+  assert(res[0]["G"] == std::string("\x01\x02\x03", 3));
+  assert(res[0]["H"] == "false");
+  assert(res[0]["I"] == std::string(300, 'x'));
+  assert(res[0]["J"] == "1");
+  assert(res[0]["K"] == "last");
+
+  // Floating point values with the fewest digits that read back to them.
+  lat = 1e300;
+  lon = 1e-7f;
+  memcpy(&lat_bits, &lat, 8);
+  memcpy(&lon_bits, &lon, 4);
+  data.clear();
+  Map(&data, 2);
+  Str(&data, "d");
+  data.push_back('\xCB');
+  BigEndian(&data, lat_bits, 8);
+  Str(&data, "e");
+  data.push_back('\xCA');
+  BigEndian(&data, lon_bits, 4);
+  keys = MakeKeys(kinds + 6, 4);
+  res.clear();
+  ScanMsgPack(data, keys, &res);
+  assert(res.size() == 1);
+  assert(res[0]["D"] == "1e+300" && res[0]["E"] == "1e-07");
+
+  // Arrays nested too deep on the way are malformed, a count larger than
+  // the data is too.
+  static const char* const deep[] = { "A", "a.b", NULL, NULL };
+  keys = MakeKeys(deep, 4);
+  data.clear();
+  for (size_t i = 0; i + 1 < kMsgPackMaxNesting; ++i)
+    Array(&data, 1);
+  Map(&data, 1);
+  Str(&data, "a");
+  Map(&data, 1);
+  Str(&data, "b");
+  Str(&data, "1");
+  res.clear();
+  ScanMsgPack(data, keys, &res);
+  assert(res.empty());
+  res.clear();
+  ScanMsgPack(data.substr(1), keys, &res);
+  assert(res.size() == 1);
+  keys = MakeKeys(kinds + 2, 2);
+  data.clear();
+  Map(&data, 2);
+  Str(&data, "b");
+  Str(&data, "1");
+  Str(&data, "x");
+  data += std::string("\xDD\xFF\xFF\xFF\xFF", 5);
+  res.clear();
+  ScanMsgPack(data, keys, &res);
+  assert(res.empty());
+  data[0] = '\x81';
+  res.clear();
+  ScanMsgPack(data.substr(0, 5), keys, &res);
+  assert(res.size() == 1);
+}
+
+// A value as a tree, the way the scanner has to see it.
+struct TestValue {
+  int kind;  // 0 unsigned, 1 negative, 2 string, 3 bool, 4 nil, 5 map,
+             // 6 array
+  uint64_t u;
+  std::string bytes;
+  std::vector<std::pair<std::string, TestValue> > pairs;
+  std::vector<TestValue> elements;
+};
+
+void Encode(const TestValue& v, std::string* s) {
+  switch (v.kind) {
+  case 0: Uint(s, v.u); break;
+  case 1: Int(s, -static_cast<int64_t>(v.u)); break;
+  case 2: Str(s, v.bytes); break;
+  case 3: s->push_back(v.u ? '\xC3' : '\xC2'); break;
+  case 4: s->push_back('\xC0'); break;
+  case 5:
+    Map(s, v.pairs.size());
+    for (size_t i = 0; i < v.pairs.size(); ++i) {
+      Str(s, v.pairs[i].first);
+      Encode(v.pairs[i].second, s);
+    }
+    break;
+  default:
+    Array(s, v.elements.size());
+    for (size_t i = 0; i < v.elements.size(); ++i)
+      Encode(v.elements[i], s);
+    break;
+  }
+}
+
+const char* const kRandomValues[] = {
+  "13812345678", "+8613912345678", "x", "", "1",
+};
+
+const char* const kRandomKeys[] = { "a", "b", "c", "d" };
+
+void RandomValue(TestValue* v, int depth) {
+  v->kind = depth > 4 ? rand() % 5 : rand() % 9;
+  v->u = 0;
+  switch (v->kind) {
+  case 0: v->u = rand() % 3 == 0 ? rand() % 100 : rand(); break;
+  case 1: v->u = 1 + rand() % 100000; break;
+  case 2: v->bytes = kRandomValues[rand() % 5]; break;
+  case 3: v->u = rand() % 2; break;
+  case 4: break;
+  case 5:
+  case 6:
+  case 7: {
+    v->kind = 5;
+    int n = rand() % 5;
+    for (int i = 0; i < n; ++i) {
+      v->pairs.push_back(std::make_pair(kRandomKeys[rand() % 4],
+                                        TestValue()));
+      RandomValue(&v->pairs.back().second, depth + 1);
+    }
+    break;
+  }
+  default: {
+    v->kind = 6;
+    int n = rand() % 4;
+    v->elements.resize(n);
+    for (int i = 0; i < n; ++i)
+      RandomValue(&v->elements[i], depth + 1);
+    break;
+  }
+  }
+}
+
+typedef TreeKey<MsgPackPath> PathKey;
+
+const string_view* Steps(const MsgPackPath& path) {
+  return path.keys;
+}
+
+void TreeCollect(const TestValue& v, size_t depth,
+                 const std::vector<size_t>& active,
+                 std::vector<PathKey>* keys) {
+  if (v.kind == 6) {
+    for (size_t i = 0; i < v.elements.size(); ++i)
+      TreeCollect(v.elements[i], depth, active, keys);
+    return;
+  }
+  if (v.kind == 5) {
+    for (size_t i = 0; i < v.pairs.size(); ++i) {
+      std::vector<size_t> down;
+      for (size_t k = 0; k < active.size(); ++k) {
+        const MsgPackPath& path = (*keys)[active[k]].path;
+        if (path.size > depth && path.keys[depth] == v.pairs[i].first)
+          down.push_back(active[k]);
+      }
+      if (!down.empty())
+        TreeCollect(v.pairs[i].second, depth + 1, down, keys);
+    }
+    return;
+  }
+  if (v.kind == 4)
+    return;
+
+  for (size_t k = 0; k < active.size(); ++k) {
+    PathKey& key = (*keys)[active[k]];
+    if (key.path.size != depth)
+      continue;
+    key.found = true;
+    switch (v.kind) {
+    case 0: key.value = std::to_string(v.u); break;
+    case 1: key.value = std::to_string(-static_cast<int64_t>(v.u)); break;
+    case 2: key.value = v.bytes; break;
+    default: key.value = v.u ? "true" : "false"; break;
+    }
+  }
+}
+
+void TreeRecords(const TestValue& v, size_t depth,
+                 const std::vector<Rule::Key>& keys,
+                 const std::vector<MsgPackPath>& paths, size_t scope,
+                 RecordSet* res) {
+  if (v.kind == 6) {
+    for (size_t i = 0; i < v.elements.size(); ++i)
+      TreeRecords(v.elements[i], depth, keys, paths, scope, res);
+    return;
+  }
+  if (v.kind != 5)
+    return;
+  if (depth < scope) {
+    for (size_t i = 0; i < v.pairs.size(); ++i) {
+      if (v.pairs[i].first == paths[0].keys[depth])
+        TreeRecords(v.pairs[i].second, depth + 1, keys, paths, scope, res);
+    }
+    return;
+  }
+
+  std::vector<PathKey> tree_keys = TreeKeys(paths);
+  std::vector<size_t> active;
+  for (size_t i = 0; i < keys.size(); ++i)
+    active.push_back(i);
+  TreeCollect(v, depth, active, &tree_keys);
+  TreeRecord(keys, tree_keys, res);
+}
+
+RecordSet ExpectedRecords(const TestValue& v,
+                          const std::vector<Rule::Key>& keys) {
+  std::vector<MsgPackPath> paths;
+  size_t scope = TreePaths(keys, ParseMsgPackPath, Steps, &paths);
+  RecordSet res;
+  TreeRecords(v, 0, keys, paths, scope, &res);
+  return res;
+}
+
+void TestCaseScanMsgPackRandom() {
+  static const char* const names[][4] = {
+    {"PHONENUM", "a.b", "NICKNAME", "a.c"},
+    {"PHONENUM", "a.b.c", NULL, NULL},
+    {"NICKNAME", "b", "APP_NAME", "d"},
+    {"NICKNAME", "d.b", "PHONENUM", "a.a.b"},
+    {"APP_NAME", "c.d", "NICKNAME", "c.c"},
+  };
+  const size_t n = sizeof(names) / sizeof(names[0]);
+  std::vector<std::vector<Rule::Key> > keys;
+  for (size_t i = 0; i < n; ++i)
+    keys.push_back(MakeKeys(names[i], 4));
+
+  srand(1);
+  size_t records = 0;
+  for (int i = 0; i < 20000; ++i) {
+    TestValue v;
+    RandomValue(&v, 0);
+    std::string data;
+    Encode(v, &data);
+    for (size_t j = 0; j < n; ++j) {
+      RecordSet res;
+      ScanMsgPack(data, keys[j], &res);
+      assert(res == ExpectedRecords(v, keys[j]));
+      records += res.size();
+    }
+
+    // broken data is read safely
+    data[rand() % data.size()] = static_cast<char>(rand());
+    data.resize(rand() % (data.size() + 1));
+    for (size_t j = 0; j < n; ++j) {
+      RecordSet res;
+      ScanMsgPack(data, keys[j], &res);
+    }
+  }
+  assert(records > 0);
+}
+
+int main() {
+  TestCaseMsgPackPath();
+  TestCaseScanMsgPack();
+  TestCaseScanMsgPackRandom();
+  return 0;
+}
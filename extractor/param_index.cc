@@ -0,0 +1,95 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include "extractor/param_index.h"
+
+#include <cstdint>
+#include <algorithm>
+
+namespace ext {
+namespace {
+// FNV-1a, names are short.
+size_t hash(string_view s) {
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < s.size(); ++i) {
+    h ^= static_cast<uint8_t>(s[i]);
+    h *= 1099511628211ULL;
+  }
+  return static_cast<size_t>(h);
+}
+
+// How many slots a name is probed for at most.
+const size_t kMaxProbes = 8;
+
+} // anonymous namespace
+
+ParamIndex::ParamIndex(string_view s, char sep): size_(0) {
+  size_t n = std::count(s.begin(), s.end(), sep) + 1;
+  size_t capacity = 8;
+  while (capacity < 2 * n)
+    capacity <<= 1;
+  table_.resize(capacity);
+
+  while (true) {
+    size_t pos = s.find(sep);
+    string_view pair = s.substr(0, pos);
+    if (sep == ';') {
+      while (!pair.empty() && pair.front() == ' ')
+        pair.remove_prefix(1);
+    }
+    size_t eq = pair.find('=');
+    if (eq != string_view::npos && eq > 0)
+      Insert(pair.substr(0, eq), pair.substr(eq + 1));
+    if (pos == string_view::npos)
+      break;
+    s.remove_prefix(pos + 1);
+  }
+}
+
+void ParamIndex::Insert(string_view name, string_view value) {
+  size_t mask = table_.size() - 1;
+  size_t i = hash(name) & mask;
+  for (size_t k = 0; k < kMaxProbes; ++k, i = (i + 1) & mask) {
+    Entry& entry = table_[i];
+    if (!entry.used) {
+      entry.name = name;
+      entry.value = value;
+      entry.used = true;
+      ++size_;
+      return;
+    }
+    if (entry.name == name)
+      return;
+  }
+
+  // The slots stay taken, so the later pairs of the name come here too
+  // and the first one is found first.
+  spill_.push_back(Entry());
+  spill_.back().name = name;
+  spill_.back().value = value;
+  spill_.back().used = true;
+  ++size_;
+}
+
+bool ParamIndex::Find(string_view name, string_view* value) const {
+  size_t mask = table_.size() - 1;
+  size_t i = hash(name) & mask;
+  for (size_t k = 0; k < kMaxProbes; ++k, i = (i + 1) & mask) {
+    const Entry& entry = table_[i];
+    if (!entry.used)
+      return false;
+    if (entry.name == name) {
+      *value = entry.value;
+      return true;
+    }
+  }
+
+  for (size_t k = 0; k < spill_.size(); ++k) {
+    if (spill_[k].name == name) {
+      *value = spill_[k].value;
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace ext
@@ -0,0 +1,60 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#ifndef EXTRACTOR_PARAM_INDEX_H_
+#define EXTRACTOR_PARAM_INDEX_H_
+
+#include <vector>
+
+#include "extractor/trivial.h"
+#include "extractor/third_party/string_view.h"
+
+namespace ext {
+// The parameters of a query, a form body or a cookie by name. The string
+// is split once into `name=value' pairs, which are looked up by hashing
+// the name, so that the Param rules on it cost one probe each. Names and
+// values point into the string, the first pair of a name is kept as the
+// first match of a Prefix step would be, and pairs without a `=' are
+// left out.
+//
+// The names come from the traffic and may be made to collide, a name is
+// probed for at a few places only, and the pairs that find no room there
+// are kept aside in order and scanned. The index is built in linear time
+// whatever the names are.
+class ParamIndex {
+public:
+  // Pairs are separated by `sep', the spaces before a name are skipped
+  // if it's the `;' of a cookie.
+  ParamIndex(string_view s, char sep);
+
+  // Returns whether there's a parameter named `name', its value is
+  // written to `value'.
+  bool Find(string_view name, string_view* value) const;
+
+  // The number of pairs kept, a name repeated when the table is crowded
+  // where it's hashed to may be kept twice, the first one is found.
+  size_t size() const { return size_; }
+
+private:
+  struct Entry {
+    string_view name;
+    string_view value;
+    bool used;
+
+    Entry(): used(false) {}
+  };
+
+  void Insert(string_view name, string_view value);
+
+  // open addressing with linear probing, a power of 2 in size and never
+  // more than half full
+  std::vector<Entry> table_;
+  // the pairs that found no room within the probes, in order
+  std::vector<Entry> spill_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParamIndex);
+};
+
+} // namespace ext
+
+#endif // EXTRACTOR_PARAM_INDEX_H_
@@ -0,0 +1,133 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "extractor/param_index.h"
+
+using namespace ext;
+
+std::string Find(const ParamIndex& index, const char* name) {
+  string_view value;
+  if (!index.Find(name, &value))
+    return "<none>";
+  return std::string(value.data(), value.size());
+}
+
+void TestCaseQuery() {
+  std::string query = "uid=13812345678&name=tom&uid=1&flag&=x&empty=&a=b=c&";
+  ParamIndex index(query, '&');
+  assert(index.size() == 4);
+  // the first one of a name wins
+  assert(Find(index, "uid") == "13812345678");
+  assert(Find(index, "name") == "tom");
+  assert(Find(index, "empty") == "");
+  assert(Find(index, "a") == "b=c");
+  // pairs without a name or a `=' are left out
+  assert(Find(index, "flag") == "<none>");
+  assert(Find(index, "") == "<none>");
+  // names are matched whole
+  assert(Find(index, "id") == "<none>");
+  assert(Find(index, "nam") == "<none>");
+
+  ParamIndex none("", '&');
+  assert(none.size() == 0 && Find(none, "uid") == "<none>");
+}
+
+void TestCaseCookie() {
+  std::string cookie = "sid=abc;  uid=42; name=a b;last=";
+  ParamIndex index(cookie, ';');
+  assert(index.size() == 4);
+  assert(Find(index, "sid") == "abc");
+  assert(Find(index, "uid") == "42");
+  assert(Find(index, "name") == "a b");
+  assert(Find(index, "last") == "");
+  assert(Find(index, " uid") == "<none>");
+
+  // spaces are kept in a query
+  ParamIndex query("a=1& b=2", '&');
+  assert(Find(query, " b") == "2" && Find(query, "b") == "<none>");
+}
+
+// Compared with a scan for the first pair of every name.
+void TestCaseRandom() {
+  const char* names[] = { "a", "b", "uid", "imei", "x1", "ab", "ba", "" };
+  srand(1);
+  for (int i = 0; i < 2000; ++i) {
+    std::string s;
+    std::vector<std::pair<std::string, std::string> > pairs;
+    int n = rand() % 200;
+    for (int j = 0; j < n; ++j) {
+      if (j > 0)
+        s.push_back('&');
+      std::string name = names[rand() % 8];
+      if (rand() % 4 == 0)
+        name += std::to_string(rand() % 100);
+      std::string value = std::to_string(rand());
+      if (rand() % 10 == 0) {
+        s += name;
+        continue;
+      }
+      s += name + "=" + value;
+      if (!name.empty())
+        pairs.push_back(std::make_pair(name, value));
+    }
+
+    ParamIndex index(s, '&');
+    for (size_t j = 0; j < pairs.size(); ++j) {
+      std::string expect;
+      for (size_t k = 0; k < pairs.size(); ++k) {
+        if (pairs[k].first == pairs[j].first) {
+          expect = pairs[k].second;
+          break;
+        }
+      }
+      assert(Find(index, pairs[j].first.c_str()) == expect);
+    }
+    assert(Find(index, "missing") == "<none>");
+  }
+}
+
+// FNV-1a as the index hashes the names.
+uint64_t Fnv1a(const std::string& s) {
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < s.size(); ++i) {
+    h ^= static_cast<uint8_t>(s[i]);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+// Names that all hash to one slot of the table.
+void TestCaseCollision() {
+  const size_t n = 2000;
+  const uint64_t mask = 4096 - 1;
+  std::vector<std::string> names;
+  for (int i = 0; names.size() < n; ++i) {
+    std::string name = "n" + std::to_string(i);
+    if ((Fnv1a(name) & mask) == 0)
+      names.push_back(name);
+  }
+
+  std::string s;
+  for (size_t i = 0; i < n; ++i)
+    s += names[i] + "=" + std::to_string(i) + "&";
+  s += names[n - 1] + "=again&" + names[0] + "=again";
+  ParamIndex index(s, '&');
+  for (size_t i = 0; i < n; ++i)
+    assert(Find(index, names[i].c_str()) == std::to_string(i));
+  assert(Find(index, "n") == "<none>");
+}
+
+int main() {
+  TestCaseQuery();
+  TestCaseCookie();
+  TestCaseRandom();
+  TestCaseCollision();
+  return 0;
+}
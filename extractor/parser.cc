@@ -2,8 +2,6 @@
 
 #include "extractor/parser.h"
 
-#include <iconv.h>
-#include <expat.h>
 #include <endian.h>
 #include <cassert>
 #include <cctype>
@@ -11,7 +9,6 @@
 #include <algorithm>
 #include <iterator>
 #include <unordered_map>
-#include <system_error>
 #include <memory>
 #include <utility>
 #include <mutex>
@@ -22,38 +19,22 @@
 #include "extractor/filter.h"
 #include "extractor/codec.h"
 #include "extractor/trivial.h"
-#include "extractor/third_party/json.h"
+#include "extractor/json_scanner.h"
+#include "extractor/xml_scanner.h"
+#include "extractor/pb_scanner.h"
+#include "extractor/msgpack_scanner.h"
+#include "extractor/thrift_scanner.h"
+#include "extractor/param_index.h"
 
 namespace ext {
 namespace {
-bool iconv_to_utf8(char* ibuf, size_t* ilen,
-                   char* obuf, size_t* olen,
-                   const std::string& from) {
-  iconv_t id = iconv_open("UTF-8", from.c_str());
-  if (id == iconv_t(-1)) {
-    throw std::system_error(errno,
-        std::system_category(), "iconv_open failed");
-  }
-  size_t ret = iconv(id, &ibuf, ilen, &obuf, olen);
-  iconv_close(id);
-  return ret == size_t(-1) ? false : true;
-}
-
 bool IconvToUtf8(std::string* s, const std::string& from) {
   assert(!s->empty());
-
-  size_t ilen = s->size();
-  char* ibuf = &((*s)[0]);
-
-  size_t olen = s->size() * 4;
-  size_t olen_remain = olen;
-  std::unique_ptr<char[]> out_buf(new char[olen]);
-  char* obuf = out_buf.get();
-
-  bool ret = iconv_to_utf8(ibuf, &ilen, obuf, &olen_remain, from);
-  if (ret)
-    s->assign(obuf, olen - olen_remain);
-  return ret;
+  static thread_local std::string buf;
+  if (CharsetToUtf8(from, s->data(), s->size(), &buf) != SUCCESS)
+    return false;
+  s->assign(buf);
+  return true;
 }
 
 string_view Skipper(string_view msg, Skip::Type type) {
@@ -146,12 +127,56 @@ string_view Splitter(string_view msg, char sep, unsigned int exp) {
   return msg;
 }
 
+// Decodes the slice with the first `n' codecs of the chain, the
+// decoded view of every prefix of the chain is cached in the message.
+// `truncated' tells whether the view has been inflated partially.
+const std::string* decode_view(Message* msg, Message::Slice::Type type,
+                               const CodecChain& chain, size_t n,
+                               size_t reach, bool* truncated, int* err) {
+  *truncated = false;
+  if (n == 0)
+    return &Slice(msg, type).str;
+
+  const std::vector<Codec::Type>& types = chain.types();
+  Message::ViewKey key(type, std::vector<Codec::Type>(types.begin(),
+                                                      types.begin() + n));
+  size_t need = chain.Need(n, reach);
+  auto iter = msg->views.find(key);
+  if (iter == msg->views.end() ||
+      (iter->second.truncated && iter->second.limit < need)) {
+    bool base_truncated = false;
+    const std::string* base = decode_view(msg, type, chain, n - 1, reach,
+                                          &base_truncated, err);
+    Message::View& view = msg->views[key];
+    view.limit = need;
+    view.truncated = false;
+    if (base) {
+      view.str = *base;
+      view.error = chain.Decode(n - 1, &view.str, need, &view.truncated);
+      view.truncated = view.truncated || base_truncated;
+      if (view.error != SUCCESS)
+        view.str.clear();
+    } else {
+      view.error = *err;
+    }
+    iter = msg->views.find(key);
+  }
+
+  if (iter->second.error != SUCCESS) {
+    *err = iter->second.error;
+    return NULL;
+  }
+  *truncated = iter->second.truncated;
+  return &iter->second.str;
+}
+
 } // anonymous namespace
 
 bool g_output_orign_lbs = false;
 bool g_extract_stat = false;
 
-void ParseUKNOnce(const Rule& rule, string_view msg, std::string* res) {
+void ParseUKNOnce(const Rule& rule, string_view msg,
+                  const ParamIndex* params, std::string* res) {
   auto const& key = rule.keys[0];
 
   for (size_t i = 0; i < rule.steps.size(); ++i) {
@@ -239,6 +264,11 @@ void ParseUKNOnce(const Rule& rule, string_view msg, std::string* res) {
       msg = Splitter(msg, step.s_split, rule.index);
       break;
     }
+    case StepLayer::Type::PARAM: {
+      if (!params || !params->Find(step.s_pattern, &msg))
+        return;
+      break;
+    }
     default: assert(false && "Unreachable code");
     }
 
@@ -246,27 +276,53 @@ void ParseUKNOnce(const Rule& rule, string_view msg, std::string* res) {
 
   if (msg.empty())
     return;
-  std::string val(msg.data(), msg.size());
 
-  if (!rule.value_encode.empty()) {
-    if (Codecode(rule.value_encode, &val) != SUCCESS)
+  // Values that need no decoding are validated straight from the message,
+  // so the common case copies the result once and allocates nothing else.
+  std::string val;
+  if (!rule.late_decode.empty() || !rule.value_encode.empty() ||
+      !rule.charset.empty()) {
+    val.assign(msg.data(), msg.size());
+
+    if (!rule.late_decode.empty()) {
+      if (rule.late_decode.Decode(&val) != SUCCESS)
+        return;
+    }
+
+    if (!rule.value_encode.empty()) {
+      if (rule.value_encode.Decode(&val) != SUCCESS)
+        return;
+    }
+
+    if (!rule.charset.empty()) {
+      if (!IconvToUtf8(&val, rule.charset))
+        return;
+    }
+
+    if (!key.validate) {
+      res->swap(val);
       return;
+    }
+    msg = val;
   }
 
-  if (!rule.charset.empty()) {
-    if (!IconvToUtf8(&val, rule.charset))
-      return;
+  if (!key.validate) {
+    res->assign(msg.data(), msg.size());
+    return;
   }
 
-  if (!key.filter || key.filter(&val))
-    res->swap(val);
+  char buf[kValidateBufferSize];
+  size_t n = Validate(key.validate, msg, buf);
+  if (n != 0)
+    res->assign(buf, n);
 }
 
-void Parser::ParseUKN(const Rule& rule, string_view msg, Record* res, RuleStat* st) {
+void Parser::ParseUKN(const Rule& rule, string_view msg,
+    const ParamIndex* params, Record* res, RuleStat* st) {
   assert(rule.type == RuleLayer::Type::UNKNOWN);
   Record record;
   std::string val;
-  ParseUKNOnce(rule, msg, &val);
+  ParseUKNOnce(rule, msg, params, &val);
   if (val.empty()) {
     ++st->fail;
     return;
@@ -277,7 +333,7 @@ void Parser::ParseUKN(const Rule& rule, string_view msg, Record* res, RuleStat*
     auto const& sub_rules = rule.sub_rules;
     for (size_t i = 0; i < sub_rules.size(); ++i) {
       val.clear();
-      ParseUKNOnce(sub_rules[i], msg, &val);
+      ParseUKNOnce(sub_rules[i], msg, params, &val);
       if (val.empty()) {
         ++st->fail;
         return;
@@ -312,75 +368,6 @@ void Parser::ParseUKN(const Rule& rule, string_view msg, Record* res, RuleStat*
 }
 
 namespace {
-Record read_json_object(const AJson::Value& root,
-                        const std::vector<Rule::Key>& keys) {
-  assert(root.type() == AJson::objectValue);
-  Record records;
-  for (size_t i = 0; i < keys.size(); ++i) {
-    auto const&key = keys[i];
-    if (root.isMember(key.mapped)) {
-      if (root[key.mapped].type() == AJson::arrayValue
-          || root[key.mapped].type() == AJson::objectValue) {
-        continue;
-      }
-      auto value = root[key.mapped].asString();
-      if (value.empty() || value == "null")
-        continue;
-
-      const auto&key = keys[i];
-      if (!key.filter || key.filter(&value))
-        records[key.key] = value;
-    }
-  }
-  return records;
-}
-
-void parse_json_recursively(const AJson::Value& root,
-                            const std::vector<Rule::Key>& keys,
-                            RecordSet* res,
-                            bool complete) {
-  switch (root.type()) {
-  case AJson::nullValue: break;
-  case AJson::arrayValue: {
-    for (auto iter = root.begin(); iter != root.end(); ++iter) {
-      if (iter->type() != AJson::arrayValue
-          && iter->type() != AJson::objectValue) {
-        break;
-      }
-      parse_json_recursively(*iter, keys, res, complete);
-    }
-    break;
-  }
-  case AJson::objectValue: {
-    Record records = read_json_object(root, keys);
-    if (!records.empty()) {
-      if (complete || res->empty()) {
-        // first extract
-        res->push_back(records);
-      } else {
-        res->back().insert(records.begin(), records.end());
-        complete = false;
-      }
-    }
-
-    for (auto iter = root.begin(); iter != root.end(); ++iter) {
-      if (iter->type() == AJson::arrayValue
-          || iter->type() == AJson::objectValue) {
-        parse_json_recursively(*iter, keys, res, complete);
-      }
-    }
-
-    // check numbers of record from back.
-    if (complete && !res->empty()) {
-      if (res->back().size() != keys.size())
-        res->pop_back();
-    }
-  }
-  break;
-  default: break;
-  }
-}
-
 string_view strip(string_view view,
                   const std::string& prefix,
                   const std::string& suffix) {
@@ -401,6 +388,52 @@ string_view strip(string_view view,
   return view;
 }
 
+// Finds a separator of an F0 rule, a single byte with memchr and longer
+// ones with memchr on their first byte and memcmp.
+size_t find_split(string_view view, const std::string& split) {
+  return split.size() == 1 ? view.find(split[0]) : view.find(split);
+}
+
+// Splits a group of an F0 rule into one word per key, a separator at its
+// end is allowed. Returns false if the number of words doesn't match.
+bool split_words(string_view group, const std::string& split,
+                 std::vector<string_view>* words) {
+  size_t n = 0;
+  while (!group.empty()) {
+    if (n == words->size())
+      return false;
+    size_t pos = find_split(group, split);
+    (*words)[n++] = group.substr(0, pos);
+    if (pos == string_view::npos)
+      break;
+    group.remove_prefix(pos + split.size());
+  }
+  return n == words->size();
+}
+
+bool is_digit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// Puts the value of the key into the record if it's valid, only a valid
+// value is copied out of the message. Keys without a validator are
+// filtered the legacy way.
+bool add_value(const Rule::Key& key, string_view value, Record* record) {
+  if (key.validate) {
+    char buf[kValidateBufferSize];
+    size_t n = Validate(key.validate, value, buf);
+    if (n == 0)
+      return false;
+    (*record)[key.key].assign(buf, n);
+    return true;
+  }
+  std::string s(value.data(), value.size());
+  if (key.filter && !key.filter(&s))
+    return false;
+  (*record)[key.key].swap(s);
+  return true;
+}
+
 std::mutex g_rule_stat_lock;
 RuleStats g_rule_stat;
 } // anonymous namespace
@@ -424,105 +457,85 @@ RuleStats GetRuleStats() {
   return ret;
 }
 
-void Parser::ParseJSON(const Rule& rule, string_view msg,
-    RecordSet* res, RuleStat* st) {
-  assert(rule.type == RuleLayer::Type::JSON);
-  static auto const features = AJson::Features::all();
-  AJson::Value root;
-  AJson::Reader reader(features);
-
-  msg = strip(msg, rule.head, "");
-  if (!msg.empty()) {
-    auto ret = reader.parse(msg.begin(), msg.end(), root, false);
-    (void)ret;
-    auto const& keys = rule.keys;
-    size_t size = res->size();
-    parse_json_recursively(root, keys, res, true);
-    if (res->size() > size) {
-      ++st->hit;
-    } else {
-      ++st->fail;
-    }
-  } else {
-    ++st->fail;
-  }
-}
-
 namespace {
-struct XmlOpaque {
-  const Rule* rule;
-  std::vector<Record>* records;
-  Record tmp;
-};
-
-void elem_begin(void* data, const char*, const char** array) {
-  XmlOpaque* op = reinterpret_cast<XmlOpaque*>(data);
-  Record& tmp = op->tmp;
-
-  for (int i = 0; array[i]; i += 2) {
-    const char* key = array[i];
-    const char* value = array[i + 1];
-    if (key && value) {
-      tmp.insert({key, value});
-    }
-  }
+// Returns the key sets of the rules that share the document with the rule.
+std::vector<const std::vector<Rule::Key>*> doc_key_sets(const Category& cate,
+                                                        const Rule& rule) {
+  std::vector<const std::vector<Rule::Key>*> key_sets;
+  for (size_t i = 0; i < rule.doc_rules.size(); ++i)
+    key_sets.push_back(&cate.rules[rule.doc_rules[i]].keys);
+  return key_sets;
 }
 
-void elem_end(void* data, const char*) {
-  XmlOpaque* op = reinterpret_cast<XmlOpaque*>(data);
-  const Rule* rule = op->rule;
-  const auto& keys = rule->keys;
-  Record& tmp = op->tmp;
-  Record records;
-
-  if (tmp.empty())
-    return;
+} // anonymous namespace
 
-  for (size_t i = 0; i < keys.size(); ++i) {
-    auto iter = tmp.find(keys[i].mapped);
-    if (iter != tmp.end()) {
-      if (iter->second.empty()) {
-        records.clear();
-        break;
+void Parser::ParseJSON(const Category& cate, const Rule& rule, Message* msg,
+    const std::string& view, RecordSet* res, RuleStat* st) {
+  assert(rule.type == RuleLayer::Type::JSON);
+  size_t size = res->size();
+  std::shared_ptr<JsonDocument>* document = NULL;
+  size_t set = 0;
+  if (!rule.doc_rules.empty()) {
+    Message::DocumentKey key(view.data(), view.size(), rule.head, "");
+    document = &msg->json_documents[key];
+    if (*document && !(*document)->FindKeySet(rule.keys, &set))
+      document->reset();
+  }
+
+  // The view is stripped and scanned unless it's done for the document.
+  if (!document || !*document) {
+    string_view doc = strip(view, rule.head, "");
+    if (!doc.empty()) {
+      const JsonIndex* index = IndexJSON(msg, view);
+      if (index && !index->Covers(doc))
+        index = NULL;
+      if (!document) {
+        ScanJson(doc, rule.keys, index, res);
+      } else {
+        *document = std::make_shared<JsonDocument>(
+            doc, doc_key_sets(cate, rule), index);
+        (*document)->FindKeySet(rule.keys, &set);
       }
-
-      auto& value = iter->second;
-      const auto& key = keys[i];
-      if (!key.filter || key.filter(&value))
-        records[key.key] = iter->second;
     }
   }
+  if (document && *document)
+    (*document)->Extract(set, res);
 
-  if (records.size() == keys.size())
-    op->records->push_back(records);
-  tmp.clear();
-}
-
-} // anonymous namespace
-
-void Parser::ParseXML(const Rule& rule, string_view msg,
-    RecordSet* res, RuleStat* st) {
-  assert(rule.type == RuleLayer::Type::XML);
-  msg = strip(msg, rule.head, rule.tail);
-  if (msg.empty()) {
+  if (res->size() > size) {
+    ++st->hit;
+  } else {
     ++st->fail;
-    return;
   }
+}
 
-  XML_Parser parser = XML_ParserCreate("utf-8");
-  XML_SetElementHandler(parser, elem_begin, elem_end);
-  XmlOpaque opaque;
-  opaque.rule = &rule;
-  opaque.records = res;
+void Parser::ParseXML(const Category& cate, const Rule& rule, Message* msg,
+    const std::string& view, RecordSet* res, RuleStat* st) {
+  assert(rule.type == RuleLayer::Type::XML);
   size_t size = res->size();
-  XML_SetUserData(parser, &opaque);
-  XML_Status ret = XML_Parse(parser, msg.data(), msg.size(), XML_TRUE);
-  if (ret != XML_STATUS_OK) {
-    XML_Error err = XML_GetErrorCode(parser);
-    if (err == XML_ERROR_ABORTED) {
-      // broken xml, but do nothings
+  std::shared_ptr<XmlDocument>* document = NULL;
+  size_t set = 0;
+  if (!rule.doc_rules.empty()) {
+    Message::DocumentKey key(view.data(), view.size(), rule.head, rule.tail);
+    document = &msg->xml_documents[key];
+    if (*document && !(*document)->FindKeySet(rule.keys, &set))
+      document->reset();
+  }
+
+  // The view is stripped and parsed unless it's done for the document.
+  if (!document || !*document) {
+    string_view doc = strip(view, rule.head, rule.tail);
+    if (!doc.empty()) {
+      if (!document) {
+        ScanXml(doc, rule.keys, res);
+      } else {
+        *document = std::make_shared<XmlDocument>(doc,
+                                                  doc_key_sets(cate, rule));
+        (*document)->FindKeySet(rule.keys, &set);
+      }
     }
   }
+  if (document && *document)
+    (*document)->Extract(set, res);
 
   if (res->size() > size) {
     ++st->hit;
@@ -534,7 +547,6 @@ void Parser::ParseXML(const Rule& rule, string_view msg,
 void Parser::ParseF0(const Rule& rule, string_view msg,
     RecordSet* res, RuleStat* st) {
   assert(rule.type == RuleLayer::Type::F0);
-  ++st->appear;
   msg = strip(msg, rule.head, rule.tail);
   if (msg.empty()) {
     ++st->fail;
@@ -543,31 +555,25 @@ void Parser::ParseF0(const Rule& rule, string_view msg,
 
   size_t size = res->size();
 
+  // Groups without a word for every key are dropped before any value is
+  // validated, and a group stops at its first invalid word.
   const auto& keys = rule.keys;
-  std::vector<std::string> group;
-  std::string buf;
-  for (size_t i = 0; i < msg.size(); ++i) {
-    if (msg[i] == rule.word_split[0]) {
-      group.push_back(buf);
-      buf.clear();
-    } else if (msg[i] == rule.group_split[0]) {
-      if (group.size() != keys.size())
-        continue;
-      Record records;
-      for (size_t j = 0; j < keys.size(); ++j) {
-        std::string& value = group[j];
-        if (!value.empty()) {
-          const auto& key = keys[i];
-          if (!key.filter || key.filter(&value))
-            records[key.key] = value;
-        }
-      }
-      if (records.size() == keys.size())
-        res->push_back(records);
-      group.clear();
-    } else {
-      buf.push_back(msg[i]);
+  std::vector<string_view> words(keys.size());
+  while (!msg.empty()) {
+    size_t pos = find_split(msg, rule.group_split);
+    string_view group = msg.substr(0, pos);
+    msg.remove_prefix(pos == string_view::npos ?
+                      msg.size() : pos + rule.group_split.size());
+    if (!split_words(group, rule.word_split, &words))
+      continue;
+
+    Record records;
+    for (size_t j = 0; j < keys.size(); ++j) {
+      if (words[j].empty() || !add_value(keys[j], words[j], &records))
+        break;
     }
+    if (records.size() == keys.size())
+      res->push_back(records);
   }
 
   if (res->size() > size) {
@@ -588,39 +594,28 @@ void Parser::ParseF1(const Rule& rule, string_view msg,
 
   size_t size = res->size();
 
+  // The text before a run of digits and the digits are a pair of values.
   const auto& keys = rule.keys;
-  const char* begin = msg.begin();
-  const char* pos;
-  const char* end;
-  while (begin < msg.end()) {
-    pos = begin;
-    while (!(*pos >= '0' && *pos <= '9')) {
-      if (pos >= msg.end())
-        return;
-      ++pos;
-    }
-
-    end = pos;
-    while ((*pos >= '0' && *pos <= '9')) {
-      if (end >= msg.end())
-        return;
-      ++end;
-    }
-
-    std::string values[] = {
-        std::string(begin, pos),
-        std::string(pos, end)
+  size_t n = std::min<size_t>(keys.size(), 2);
+  const char* p = msg.begin();
+  const char* end = msg.end();
+  while (p != end) {
+    const char* digits = std::find_if(p, end, is_digit);
+    if (digits == end)
+      break;
+    const char* next = std::find_if_not(digits, end, is_digit);
+    string_view values[] = {
+      string_view(p, digits - p),
+      string_view(digits, next - digits),
     };
-    begin = end;
-    if (values[0].empty() || values[1].empty())
+    p = next;
+    if (values[0].empty())
       continue;
 
     Record records;
-    for (size_t i = 0; i < 2; ++i) {
-      const auto& key = keys[i];
-      auto& value = values[i];
-      if (!key.filter || key.filter(&value))
-        records[key.key] = value;
+    for (size_t i = 0; i < n; ++i) {
+      if (!add_value(keys[i], values[i], &records))
+        break;
     }
     if (records.size() == keys.size())
       res->push_back(records);
@@ -633,6 +628,117 @@ void Parser::ParseF1(const Rule& rule, string_view msg,
   }
 }
 
+void Parser::ParsePB(const Rule& rule, string_view msg,
+    RecordSet* res, RuleStat* st) {
+  assert(rule.type == RuleLayer::Type::PB);
+  size_t size = res->size();
+  ScanProtobuf(msg, rule.keys, res);
+
+  if (res->size() > size) {
+    ++st->hit;
+  } else {
+    ++st->fail;
+  }
+}
+
+void Parser::ParseMSGPACK(const Rule& rule, string_view msg,
+    RecordSet* res, RuleStat* st) {
+  assert(rule.type == RuleLayer::Type::MSGPACK);
+  size_t size = res->size();
+  ScanMsgPack(msg, rule.keys, res);
+
+  if (res->size() > size) {
+    ++st->hit;
+  } else {
+    ++st->fail;
+  }
+}
+
+void Parser::ParseTHRIFT(const Rule& rule, string_view msg,
+    RecordSet* res, RuleStat* st) {
+  assert(rule.type == RuleLayer::Type::THRIFT);
+  size_t size = res->size();
+  ScanThrift(msg, rule.keys, res);
+
+  if (res->size() > size) {
+    ++st->hit;
+  } else {
+    ++st->fail;
+  }
+}
+
+const std::string* Parser::Decode(Message* msg, Message::Slice::Type type,
+                                  const CodecChain& codec, size_t reach,
+                                  int* err) {
+  bool truncated = false;
+  return decode_view(msg, type, codec, codec.size(), reach, &truncated, err);
+}
+
+const JsonIndex* Parser::IndexJSON(Message* msg, const std::string& view) {
+  if (view.size() < kJsonIndexMinSize)
+    return NULL;
+  Message::IndexKey key(view.data(), view.size());
+  auto& index = msg->json_indexes[key];
+  if (!index)
+    index = std::make_shared<JsonIndex>(view);
+  return index.get();
+}
+
+const ParamIndex* Parser::IndexParams(Message* msg, const std::string& view,
+                                      DataSource::Type src) {
+  assert(src == DataSource::Type::URL || src == DataSource::Type::COOKIE ||
+         src == DataSource::Type::REQ_CONTENT);
+  Message::IndexKey key(view.data(), view.size());
+  auto& index = msg->param_indexes[key];
+  if (!index)
+    index = std::make_shared<ParamIndex>(
+        view, src == DataSource::Type::COOKIE ? ';' : '&');
+  return index.get();
+}
+
+const std::string* Parser::DecodeHeader(Message* msg,
+                                        Message::Slice::Type type,
+                                        int header, const CodecChain& codec,
+                                        int* err) {
+  const Message::Slice& slice = Slice(msg, type);
+  std::vector<int>& table = msg->header_tables[type];
+  if (table.empty()) {
+    // The names are looked up once for all the rules on the head.
+    table.assign(rt_->header_ids.size(), -1);
+    std::string name;
+    for (size_t i = 0; i < slice.headers.size(); ++i) {
+      const Message::Slice::Header& h = slice.headers[i];
+      name.assign(slice.str, h.name, h.name_size);
+      for (size_t j = 0; j < name.size(); ++j)
+        name[j] = std::tolower(static_cast<unsigned char>(name[j]));
+      auto iter = rt_->header_ids.find(name);
+      if (iter != rt_->header_ids.end() && table[iter->second] < 0)
+        table[iter->second] = i;
+    }
+  }
+  assert(header >= 0 && static_cast<size_t>(header) < table.size());
+  if (table[header] < 0)
+    return NULL;
+
+  Message::HeaderKey key(type, header, !codec.empty());
+  auto iter = msg->header_views.find(key);
+  if (iter == msg->header_views.end()) {
+    const Message::Slice::Header& h = slice.headers[table[header]];
+    Message::View& view = msg->header_views[key];
+    view.str.assign(slice.str, h.value, h.value_size);
+    view.error = codec.Decode(&view.str);
+    if (view.error != SUCCESS)
+      view.str.clear();
+    iter = msg->header_views.find(key);
+  }
+
+  if (iter->second.error != SUCCESS) {
+    *err = iter->second.error;
+    return NULL;
+  }
+  return &iter->second.str;
+}
+
 Parser::Parser(const RuleTree* rt): rt_(rt) {}
 Parser::~Parser() {}
 
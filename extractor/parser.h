@@ -53,14 +53,54 @@ public:
   virtual int Parse(Message* msg, RecordSet* res, Record* attrib) = 0;
 
 protected:
+  // Returns the slice decoded with the codec chain. Every distinct chain
+  // (and its prefixes) is decoded at most once per message, the raw slice
+  // is available to other chains. Only the first `reach' bytes of the
+  // result are guaranteed, the compressed content is inflated as far as
+  // they need.
+  // On error, NULL is returned and the error code is written to `err'.
+  static const std::string* Decode(Message* msg, Message::Slice::Type type,
+                                   const CodecChain& codec, size_t reach,
+                                   int* err);
+
+  // Returns the JSON index of a slice or view of the message, it's built
+  // at most once per string. NULL if the string is too short to need one.
+  static const JsonIndex* IndexJSON(Message* msg, const std::string& view);
+
+  // Returns the parameter index of a query, cookie or form body slice or
+  // view of the message, it's built at most once per string.
+  static const ParamIndex* IndexParams(Message* msg, const std::string& view,
+                                       DataSource::Type src);
+
+  // Returns the value of the header of a head slice decoded with the
+  // codec chain, the header is given by its id in RuleTree::header_ids.
+  // Only the value is decoded, at most once per message and chain.
+  // NULL is returned if the head has no such header, or on error, when
+  // the error code is written to `err'.
+  const std::string* DecodeHeader(Message* msg, Message::Slice::Type type,
+                                  int header, const CodecChain& codec,
+                                  int* err);
+
   // all types of rule parser that used to every parser of the protocol,
   // it's ensured on success, the result should be pushed to res,
   // otherwise no anything changed.
-  void ParseUKN(const Rule& rule, string_view msg, Record* res, RuleStat* st);
-  void ParseJSON(const Rule& rule, string_view msg, RecordSet* res, RuleStat* st);
-  void ParseXML(const Rule& rule, string_view msg, RecordSet* res, RuleStat* st);
+  // `params' indexes `msg' if the rule has Rule::params, NULL otherwise.
+  void ParseUKN(const Rule& rule, string_view msg, const ParamIndex* params,
+                Record* res, RuleStat* st);
+  // The JSON/XML rules of a category that share a document (see
+  // Rule::doc_rules) extract from the one parsed for all of them, which
+  // is kept in the message along with the view it was parsed from.
+  void ParseJSON(const Category& cate, const Rule& rule, Message* msg,
+                 const std::string& view, RecordSet* res, RuleStat* st);
+  void ParseXML(const Category& cate, const Rule& rule, Message* msg,
+                const std::string& view, RecordSet* res, RuleStat* st);
   void ParseF0(const Rule& rule, string_view msg, RecordSet* res, RuleStat* st);
   void ParseF1(const Rule& rule, string_view msg, RecordSet* res, RuleStat* st);
+  void ParsePB(const Rule& rule, string_view msg, RecordSet* res, RuleStat* st);
+  void ParseMSGPACK(const Rule& rule, string_view msg, RecordSet* res,
+                    RuleStat* st);
+  void ParseTHRIFT(const Rule& rule, string_view msg, RecordSet* res,
+                   RuleStat* st);
 
   const RuleTree* rt_;
 };
@@ -0,0 +1,463 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include <cassert>
+#include <cstring>
+#include <zlib.h>
+#include <string>
+
+#include "extractor/rule.h"
+#include "extractor/message.h"
+#include "extractor/http_parser1.h"
+#include "extractor/binary_parser.h"
+
+using namespace ext;
+
+// A rule tree of one HTTP category at parser.example.com/parser with the
+// attributes and the rules given.
+static RuleTree MakeTree(const std::string& rules, const char* attrs = "") {
+  std::string s =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+      "<pIE_RULES>"
+      "  <HOST HostId=\"20000007937\"  Host=\"parser.example.com\"  >"
+      "    <URL UrlId=\"2000000793700000\"  Url=\"/parser\"  \n"
+      "          AppName=\"parser\"  Action=\"TEST\"  ";
+  s += attrs;
+  s += "  >";
+  s += rules;
+  s += "    </URL>"
+       "  </HOST>"
+       "</pIE_RULES>";
+  return MakeRuleTree(s.data(), s.size());
+}
+
+// Extracts from the request and the response with the tree.
+static RecordSet Extract(const RuleTree& rt, const std::string& up,
+                         const std::string& down) {
+  Message msg = MakeHttpMessage(up.data(), up.size(),
+                                down.data(), down.size());
+  RecordSet res;
+  Record attrib;
+  int ret = HttpParser(&rt).Parse(&msg, &res, &attrib);
+  assert(ret == SUCCESS);
+  return res;
+}
+
+// The response content of a rule of `type' with the steps.
+static RecordSet ExtractContent(const char* type, const std::string& steps,
+                                const std::string& content) {
+  std::string rule =
+      "<RULE RuleId=\"1000000793700000000\"  Key=\"";
+  rule += type;
+  rule += "-RELATIONSHIP\"  DataSource=\"RESPONSECONTENT\"  >";
+  rule += steps;
+  rule += "</RULE>";
+  std::string up = "GET /parser HTTP/1.1\r\n"
+                   "Host: parser.example.com\r\n\r\n";
+  std::string down = "HTTP/1.1 200 OK\r\nContent-Length: " +
+                     std::to_string(content.size()) + "\r\n\r\n" + content;
+  return Extract(MakeTree(rule), up, down);
+}
+
+// Whether the i-th record is the name and phone number.
+static bool Contact(const RecordSet& res, size_t i, const char* name,
+                    const char* phone) {
+  if (i >= res.size() || res[i].size() != 2)
+    return false;
+  return SafeFind(res[i], "RELATIONSHIP_NAME") == name &&
+         SafeFind(res[i], "RELATIONSHIP_MOBILEPHONE") == phone;
+}
+
+// A TCP rule tree of one host at 10.0.0.1:8000 with the categories, the
+// payloads of the host have the feature in them.
+static RuleTree MakeBinaryTree(const std::string& cates,
+                               const char* feature =
+                                   "PlaintextFeature=\"nick\"") {
+  std::string s =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+      "<pIE_RULES>"
+      "  <HOST HostId=\"20000007938\"  Protocol=\"TCP\"  \n"
+      "        Ip=\"10.0.0.1\"  Port=\"8000\"  ";
+  s += feature;
+  s += "  >";
+  s += cates;
+  s += "  </HOST>"
+       "</pIE_RULES>";
+  return MakeRuleTree(s.data(), s.size());
+}
+
+// A category with the attributes and a rule of `key' on the data source
+// with the steps.
+static std::string BinaryCate(const char* id, const char* attrs,
+                              const char* key, const char* src,
+                              const char* steps) {
+  std::string s = "<URL UrlId=\"";
+  s += id;
+  s += "\"  AppName=\"binary\"  Action=\"TEST\"  Url=\"u\"  ";
+  s += attrs;
+  s += "  ><RULE RuleId=\"";
+  s += id;
+  s += "1\"  Key=\"";
+  s += key;
+  s += "\"  DataSource=\"";
+  s += src;
+  s += "\"  >";
+  s += steps;
+  s += "</RULE></URL>";
+  return s;
+}
+
+static Message MakeBinaryMessage(const std::string& up,
+                                 const std::string& down) {
+  Message msg;
+  msg.type = Protocol::Type::TCP;
+  Slice(&msg, Message::Slice::BIN_SERV_IP).str = "10.0.0.1";
+  Slice(&msg, Message::Slice::BIN_SERV_PORT).str = "8000";
+  Slice(&msg, Message::Slice::BIN_REQ).str = up;
+  Slice(&msg, Message::Slice::BIN_RES).str = down;
+  return msg;
+}
+
+// Extracts from the message with the tree, returns the id of the
+// category extracted, empty if none.
+static std::string ExtractBinary(const RuleTree& rt, Message* msg,
+                                 RecordSet* res) {
+  Record attrib;
+  int ret = BinaryParser(&rt).Parse(msg, res, &attrib);
+  assert(ret == SUCCESS || (ret == NOT_FOUND_RULE && res->empty()));
+  return res->empty() ? "" : SafeFind(attrib, "URL_ID");
+}
+
+static std::string ExtractBinary(const RuleTree& rt, const std::string& up,
+                                 const std::string& down) {
+  Message msg = MakeBinaryMessage(up, down);
+  RecordSet res;
+  return ExtractBinary(rt, &msg, &res);
+}
+
+// Compresses s to the gzip format.
+static std::string Gzip(const std::string& s) {
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  int ret = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                         MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+  assert(ret == Z_OK);
+  std::string out(deflateBound(&strm, s.size()), '\0');
+  strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(s.data()));
+  strm.avail_in = s.size();
+  strm.next_out = reinterpret_cast<Bytef*>(&out[0]);
+  strm.avail_out = out.size();
+  ret = deflate(&strm, Z_FINISH);
+  assert(ret == Z_STREAM_END);
+  out.resize(strm.total_out);
+  deflateEnd(&strm);
+  return out;
+}
+
+static void F0TestCase() {
+  const char* steps = "<STEP GroupSplit=\";\"  /><STEP WordSplit=\",\"  />";
+
+  // Every word is filtered by its own key, the phone number of carol is
+  // not one, and the name of the last is not filtered as one.
+  RecordSet res = ExtractContent("F0", steps,
+      "alice,13812345678;carol,12345;13912345678,13712345678");
+  assert(res.size() == 2);
+  assert(Contact(res, 0, "alice", "13812345678"));
+  assert(Contact(res, 1, "13912345678", "13712345678"));
+
+  // A group with the wrong number of words is dropped, the later ones
+  // are not.
+  res = ExtractContent("F0", steps,
+      "alice;bob,13912345678,x;carol,13712345678");
+  assert(res.size() == 1 && Contact(res, 0, "carol", "13712345678"));
+
+  // A trailing word separator is allowed, and the last group needs no
+  // group separator.
+  res = ExtractContent("F0", steps, "alice,13812345678,;bob,13912345678");
+  assert(res.size() == 2);
+  assert(Contact(res, 0, "alice", "13812345678"));
+  assert(Contact(res, 1, "bob", "13912345678"));
+
+  // The whole separators are honoured, not their first bytes.
+  res = ExtractContent("F0",
+      "<STEP GroupSplit=\"||\"  /><STEP WordSplit=\"::\"  />",
+      "a:b::13812345678||c|d::13912345678||");
+  assert(res.size() == 2);
+  assert(Contact(res, 0, "a:b", "13812345678"));
+  assert(Contact(res, 1, "c|d", "13912345678"));
+
+  // The values are the formatted ones of the validators.
+  res = ExtractContent("F0", steps, "alice,+86 138-1234-5678");
+  assert(res.size() == 1 && Contact(res, 0, "alice", "13812345678"));
+
+  // Nothing but separators.
+  res = ExtractContent("F0", steps, ";;,;");
+  assert(res.empty());
+}
+
+static void F1TestCase() {
+  // A name before every run of digits, the message may end in one, and
+  // text after the last run is dropped.
+  RecordSet res = ExtractContent("F1", "",
+      "alice13812345678bob13912345678carol");
+  assert(res.size() == 2);
+  assert(Contact(res, 0, "alice", "13812345678"));
+  assert(Contact(res, 1, "bob", "13912345678"));
+
+  res = ExtractContent("F1", "", "alice13812345678bob13912345678");
+  assert(res.size() == 2 && Contact(res, 1, "bob", "13912345678"));
+
+  res = ExtractContent("F1", "", "alice8613812345678");
+  assert(res.size() == 1 && Contact(res, 0, "alice", "13812345678"));
+
+  // Digits with no name before them, and numbers that aren't phones.
+  res = ExtractContent("F1", "", "13812345678bob123carol13712345678");
+  assert(res.size() == 1 && Contact(res, 0, "carol", "13712345678"));
+
+  // Only from the head on to the tail.
+  res = ExtractContent("F1", "<STEP Head=\"[\"  /><STEP Tail=\"]\"  />",
+      "x13812345678[bob13912345678]y13712345678");
+  assert(res.size() == 1 && Contact(res, 0, "[bob", "13912345678"));
+}
+
+// A rule of `key' on the request header `name' with the prefix.
+static std::string HeaderRule(const char* id, const char* key,
+                              const char* name, const char* prefix,
+                              bool late) {
+  std::string rule = "<RULE RuleId=\"";
+  rule += id;
+  rule += "\"  Key=\"";
+  rule += key;
+  rule += "\"  DataSource=\"REQUESTHEAD\"  Header=\"";
+  rule += name;
+  rule += late ? "\"  LateDecode=\"1\"  >" : "\"  >";
+  rule += "<STEP Prefix=\"1-";
+  rule += prefix;
+  rule += "\"  /></RULE>";
+  return rule;
+}
+
+static void HeaderTestCase() {
+  RuleTree rt = MakeTree(
+      HeaderRule("1000000793700000001", "NICKNAME", "x-device-id", "n=",
+                 false) +
+      HeaderRule("1000000793700000002", "USERNAME", "X-Missing", "u=",
+                 false) +
+      HeaderRule("1000000793700000003", "TO_NICKNAME", "X-Dup", "d=",
+                 false) +
+      // The raw and the decoded values of a header are kept apart,
+      // whichever is asked for first.
+      HeaderRule("1000000793700000004", "FROM_NICKNAME", "X-Tag", "a",
+                 true) +
+      HeaderRule("1000000793700000005", "MANAGER_NICKNAME", "x-tag", "a=",
+                 false) +
+      HeaderRule("1000000793700000006", "GROUPOWNER_NICKNAME", "X-TAG", "a",
+                 true));
+  assert(rt.header_ids.size() == 4);
+
+  RecordSet res = Extract(rt,
+      "GET /parser HTTP/1.1\r\n"
+      "Host: parser.example.com\r\n"
+      "X-DEVICE-ID: n=bob\r\n"
+      "X-Dup: d=first\r\n"
+      "X-Tag: a%3Db%253D\r\n"
+      "x-dup: d=second\r\n\r\n",
+      "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+  // The names are case-insensitive, an absent header skips its rule
+  // only, and the first of repeated headers is taken.
+  assert(res.size() == 1 && res[0].size() == 5);
+  assert(SafeFind(res[0], "NICKNAME") == "bob");
+  assert(res[0].find("USERNAME") == res[0].end());
+  assert(SafeFind(res[0], "TO_NICKNAME") == "first");
+  assert(SafeFind(res[0], "FROM_NICKNAME") == "=b%3D");
+  assert(SafeFind(res[0], "MANAGER_NICKNAME") == "b%3D");
+  assert(SafeFind(res[0], "GROUPOWNER_NICKNAME") == "=b%3D");
+}
+
+static void HeaderTableTestCase() {
+  // The header ids are numbered across the hosts, a host loaded before
+  // the others were has lower ones, but its tables cover them all.
+  std::string s =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+      "<pIE_RULES>"
+      "  <HOST HostId=\"20000007936\"  Host=\"first.example.com\"  >"
+      "    <URL UrlId=\"2000000793600000\"  Url=\"/parser\"  \n"
+      "          AppName=\"first\"  Action=\"TEST\"  >" +
+      HeaderRule("1000000793600000001", "NICKNAME", "X-A", "n=", false) +
+      "    </URL>"
+      "  </HOST>"
+      "  <HOST HostId=\"20000007937\"  Host=\"parser.example.com\"  >"
+      "    <URL UrlId=\"2000000793700000\"  Url=\"/parser\"  \n"
+      "          AppName=\"parser\"  Action=\"TEST\"  >" +
+      HeaderRule("1000000793700000001", "NICKNAME", "X-B", "n=", false) +
+      HeaderRule("1000000793700000002", "USERNAME", "X-C", "u=", false) +
+      "    </URL>"
+      "  </HOST>"
+      "</pIE_RULES>";
+  RuleTree rt = MakeRuleTree(s.data(), s.size());
+  assert(rt.header_ids.size() == 3);
+
+  const char* hosts[] = {"first.example.com", "parser.example.com"};
+  for (size_t i = 0; i < 2; ++i) {
+    std::string up = "GET /parser HTTP/1.1\r\nHost: ";
+    up += hosts[i];
+    up += "\r\nX-A: n=a\r\nX-C: u=c\r\n\r\n";
+    std::string down = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+    Message msg = MakeHttpMessage(up.data(), up.size(),
+                                  down.data(), down.size());
+    RecordSet res;
+    Record attrib;
+    assert(HttpParser(&rt).Parse(&msg, &res, &attrib) == SUCCESS);
+    assert(msg.header_tables[Message::Slice::HTTP_REQ_HEAD].size() == 3);
+    assert(res.size() == 1 && res[0].size() == 1);
+    if (i == 0)
+      assert(SafeFind(res[0], "NICKNAME") == "a");
+    else
+      assert(SafeFind(res[0], "USERNAME") == "c");
+  }
+}
+
+// A rule of `key' on the data source with the steps.
+static std::string ParamRule(const char* id, const char* key, const char* src,
+                             const char* steps) {
+  std::string rule = "<RULE RuleId=\"";
+  rule += id;
+  rule += "\"  Key=\"";
+  rule += key;
+  rule += "\"  DataSource=\"";
+  rule += src;
+  rule += "\"  >";
+  rule += steps;
+  rule += "</RULE>";
+  return rule;
+}
+
+static void ParamTestCase() {
+  RuleTree rt = MakeTree(
+      ParamRule("1000000793700000001", "PHONENUM", "URI",
+                "<STEP Param=\"uid\"  />") +
+      ParamRule("1000000793700000002", "FROM_NICKNAME", "URI",
+                "<STEP Param=\"tag\"  /><STEP Suffix=\"1-|\"  />") +
+      ParamRule("1000000793700000003", "TO_NICKNAME", "URI",
+                "<STEP Param=\"missing\"  />") +
+      ParamRule("1000000793700000004", "NICKNAME", "COOKIE",
+                "<STEP Param=\"nick\"  />") +
+      ParamRule("1000000793700000005", "USERNAME", "REQUESTCONTENT",
+                "<STEP Param=\"user\"  />"),
+      "ReqCntEncode=\"URL\"");
+
+  // The first parameter of a name is taken, the later steps go on from
+  // its value, and a missing one skips its rule only.
+  std::string body = "name=x&user=al%69ce&user=eve";
+  RecordSet res = Extract(rt,
+      "POST /parser?a=1&uid=13812345678&tag=x|y&uid=13912345678 HTTP/1.1\r\n"
+      "Host: parser.example.com\r\n"
+      "Cookie: sid=abc; nick=bob; nick=eve\r\n"
+      "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body,
+      "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+  assert(res.size() == 1 && res[0].size() == 4);
+  assert(SafeFind(res[0], "PHONENUM") == "13812345678");
+  assert(SafeFind(res[0], "FROM_NICKNAME") == "x");
+  assert(SafeFind(res[0], "NICKNAME") == "bob");
+  assert(SafeFind(res[0], "USERNAME") == "alice");
+}
+
+static void SignatureTestCase() {
+  const char* nick = "<STEP Prefix=\"1-nick=\"  /><STEP Suffix=\"1-;\"  />";
+  RuleTree rt = MakeBinaryTree(
+      BinaryCate("11", "Signature=\"2:0101\"", "NICKNAME", "UP", nick) +
+      BinaryCate("15", "Signature=\"9:3B\"", "TO_NICKNAME", "UP", nick) +
+      BinaryCate("12", "", "USERNAME", "UP",
+                 "<STEP Prefix=\"1-user=\"  /><STEP Suffix=\"1-;\"  />") +
+      BinaryCate("13", "", "USERNAME", "UP", nick) +
+      BinaryCate("14", "Signature=\"0:FF00:0200\"", "NICKNAME", "DOWN",
+                 nick));
+
+  // The signed category goes before the later unsigned ones.
+  std::string up("ab\x01\x01nick=bob;user=al;", 21);
+  assert(ExtractBinary(rt, up, "") == "11");
+  // It's skipped if the signature doesn't match, and the unsigned ones
+  // are tried in declaration order.
+  up[3] = '\x02';
+  assert(ExtractBinary(rt, up, "") == "12");
+  assert(ExtractBinary(rt, "abcdnick=bob;", "") == "13");
+
+  // The response is looked at only without a request.
+  std::string down("\x02\x55nick=bob;", 11);
+  assert(ExtractBinary(rt, "", down) == "14");
+  assert(ExtractBinary(rt, "abcd", down) == "");
+
+  // Payloads too short for a signature skip its category.
+  assert(ExtractBinary(rt, "nick=bob;", "") == "13");
+  assert(ExtractBinary(rt, "nick=bob;;", "") == "15");
+  assert(ExtractBinary(rt, "\x01", "") == "");
+}
+
+static void DecodeViewTestCase() {
+  const char* nick = "<STEP Prefix=\"1-nick=\"  /><STEP Suffix=\"1-;\"  />";
+  RuleTree rt = MakeBinaryTree(
+      BinaryCate("21", "ReqCntEncode=\"ESCAPE\"", "PHONENUM", "UP", nick) +
+      BinaryCate("22", "ReqCntEncode=\"URL\"", "PHONENUM", "UP", nick) +
+      BinaryCate("23", "ReqCntEncode=\"URL\"", "NICKNAME", "UP", nick));
+
+  // Every category sees the payload decoded with its own codecs, the
+  // raw payload is left as it is, and the categories with the same
+  // codecs share one view.
+  const char* up = "nick\\u003dal;nick%3Dbob%3B";
+  Message msg = MakeBinaryMessage(up, "");
+  RecordSet res;
+  assert(ExtractBinary(rt, &msg, &res) == "23");
+  assert(res.size() == 1 && SafeFind(res[0], "NICKNAME") == "bob");
+  assert(Slice(&msg, Message::Slice::BIN_REQ).str == up);
+  assert(msg.views.size() == 2);
+  Message::ViewKey escape(Message::Slice::BIN_REQ,
+                          std::vector<Codec::Type>(1, Codec::Type::ESCAPE));
+  Message::ViewKey url(Message::Slice::BIN_REQ,
+                       std::vector<Codec::Type>(1, Codec::Type::URL));
+  assert(msg.views[escape].str == "nick=al;nick%3Dbob%3B");
+  assert(msg.views[url].str == "nick\\u003dal;nick=bob;");
+}
+
+static void ReachTestCase() {
+  std::string src;
+  for (int i = 0; src.size() < (1 << 20); ++i)
+    src.append(std::to_string(i * 104729)).push_back(',');
+  src += "nick=bob;";
+  const std::string up = Gzip(src);
+  const char* feature = "CipherKey=\"1F8B\"";
+  std::string pos = BinaryCate("31", "ReqCntCompress=\"GZIP\"", "PHONENUM",
+      "UP", "<STEP StartPos=\"5\"  /><STEP EndPos=\"11\"  />");
+  Message::ViewKey key(Message::Slice::BIN_REQ,
+                       std::vector<Codec::Type>(1, Codec::Type::GZIP));
+
+  // The category of a rule at fixed positions inflates the payload only
+  // as far as the rule reaches.
+  RuleTree rt = MakeBinaryTree(pos, feature);
+  Message msg = MakeBinaryMessage(up, "");
+  RecordSet res;
+  assert(ExtractBinary(rt, &msg, &res) == "");
+  assert(msg.views[key].truncated && msg.views[key].str == src.substr(0, 17));
+
+  // A later category that reaches further inflates it again, as a whole.
+  rt = MakeBinaryTree(pos + BinaryCate("32", "ReqCntCompress=\"GZIP\"",
+                                       "NICKNAME", "UP",
+                                       "<STEP Prefix=\"1-nick=\"  />"
+                                       "<STEP Suffix=\"1-;\"  />"),
+                      feature);
+  msg = MakeBinaryMessage(up, "");
+  assert(ExtractBinary(rt, &msg, &res) == "32");
+  assert(res.size() == 1 && SafeFind(res[0], "NICKNAME") == "bob");
+  assert(!msg.views[key].truncated && msg.views[key].str == src);
+  assert(Slice(&msg, Message::Slice::BIN_REQ).str == up);
+}
+
+int main() {
+  F0TestCase();
+  F1TestCase();
+  HeaderTestCase();
+  HeaderTableTestCase();
+  ParamTestCase();
+  SignatureTestCase();
+  DecodeViewTestCase();
+  ReachTestCase();
+  return 0;
+}
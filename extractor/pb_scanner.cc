@@ -0,0 +1,289 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include "extractor/pb_scanner.h"
+
+#include <endian.h>
+#include <cassert>
+#include <cstring>
+#include <string>
+
+#include "extractor/key_scan.h"
+
+namespace ext {
+namespace {
+enum WireType {
+  VARINT  = 0,
+  FIXED64 = 1,
+  BYTES   = 2,
+  SGROUP  = 3,
+  EGROUP  = 4,
+  FIXED32 = 5,
+};
+
+// A field of a message, `value' holds a varint or a fixed value and
+// `bytes' a length-delimited one.
+struct PbField {
+  uint32_t number;
+  int wire;
+  uint64_t value;
+  string_view bytes;
+};
+
+bool read_tag(const char** p, const char* end, uint32_t* number,
+              int* wire) {
+  uint64_t tag;
+  if (!read_varint(p, end, &tag))
+    return false;
+  *number = static_cast<uint32_t>(tag >> 3);
+  *wire = static_cast<int>(tag & 7);
+  return *number != 0 && (tag >> 32) == 0;
+}
+
+bool skip_bytes(const char** p, const char* end, uint64_t n) {
+  if (n > static_cast<uint64_t>(end - *p))
+    return false;
+  *p += n;
+  return true;
+}
+
+// Skips a group whose start has been read, the groups in it are counted
+// rather than recursed into.
+bool skip_group(const char** p, const char* end, uint32_t number) {
+  uint32_t open[kPbMaxDepth];
+  size_t depth = 0;
+  open[depth++] = number;
+  while (depth > 0) {
+    int wire;
+    uint64_t v;
+    if (!read_tag(p, end, &number, &wire))
+      return false;
+    switch (wire) {
+    case VARINT:
+      if (!read_varint(p, end, &v))
+        return false;
+      break;
+    case FIXED64:
+      if (!skip_bytes(p, end, 8))
+        return false;
+      break;
+    case FIXED32:
+      if (!skip_bytes(p, end, 4))
+        return false;
+      break;
+    case BYTES:
+      if (!read_varint(p, end, &v) || !skip_bytes(p, end, v))
+        return false;
+      break;
+    case SGROUP:
+      if (depth == kPbMaxDepth)
+        return false;
+      open[depth++] = number;
+      break;
+    case EGROUP:
+      if (open[--depth] != number)
+        return false;
+      break;
+    default: return false;
+    }
+  }
+  return true;
+}
+
+// Reads the field at *p, a group is skipped. Returns false if it's
+// malformed.
+bool read_field(const char** p, const char* end, PbField* f) {
+  if (!read_tag(p, end, &f->number, &f->wire))
+    return false;
+  switch (f->wire) {
+  case VARINT:
+    return read_varint(p, end, &f->value);
+  case FIXED64: {
+    uint64_t v;
+    if (end - *p < 8)
+      return false;
+    memcpy(&v, *p, 8);
+    f->value = le64toh(v);
+    *p += 8;
+    return true;
+  }
+  case FIXED32: {
+    uint32_t v;
+    if (end - *p < 4)
+      return false;
+    memcpy(&v, *p, 4);
+    f->value = le32toh(v);
+    *p += 4;
+    return true;
+  }
+  case BYTES: {
+    uint64_t n;
+    if (!read_varint(p, end, &n) || n > static_cast<uint64_t>(end - *p))
+      return false;
+    f->bytes = string_view(*p, n);
+    *p += n;
+    return true;
+  }
+  case SGROUP:
+    return skip_group(p, end, f->number);
+  default: return false;
+  }
+}
+
+typedef KeyScan<PbPath, PbField, uint32_t> PbScan;
+typedef PbScan::Key PbKey;
+
+const uint32_t* path_fields(const PbPath& path) {
+  return path.fields;
+}
+
+void format_value(const PbKey& key, std::string* out) {
+  const PbField& f = key.value;
+  PbPath::Format format = key.path.format;
+  switch (f.wire) {
+  case VARINT:
+    if (format == PbPath::SINT) {
+      *out = std::to_string(static_cast<int64_t>(f.value >> 1) ^
+                            -static_cast<int64_t>(f.value & 1));
+    } else if (format == PbPath::INT) {
+      *out = std::to_string(static_cast<int64_t>(f.value));
+    } else {
+      *out = std::to_string(f.value);
+    }
+    break;
+  case FIXED64:
+    if (format == PbPath::DOUBLE) {
+      double d;
+      memcpy(&d, &f.value, sizeof(d));
+      format_double(d, out);
+    } else if (format == PbPath::INT) {
+      *out = std::to_string(static_cast<int64_t>(f.value));
+    } else {
+      *out = std::to_string(f.value);
+    }
+    break;
+  case FIXED32: {
+    uint32_t v = static_cast<uint32_t>(f.value);
+    if (format == PbPath::FLOAT) {
+      float d;
+      memcpy(&d, &v, sizeof(d));
+      format_float(d, out);
+    } else if (format == PbPath::INT) {
+      *out = std::to_string(static_cast<int32_t>(v));
+    } else {
+      *out = std::to_string(v);
+    }
+    break;
+  }
+  default:
+    out->assign(f.bytes.data(), f.bytes.size());
+    break;
+  }
+}
+
+// Reads the values of the keys in `mask' from a message that's `depth'
+// fields down their paths. Only the fields on the paths are entered.
+bool collect(PbScan* scan, string_view msg, size_t depth, uint64_t mask) {
+  const char* p = msg.begin();
+  const char* end = msg.end();
+  PbField f;
+  while (p != end) {
+    if (!read_field(&p, end, &f))
+      return false;
+    if (f.wire == SGROUP)
+      continue;
+
+    uint64_t down = 0;
+    for (uint64_t m = mask; m; m &= m - 1) {
+      size_t k = __builtin_ctzll(m);
+      PbKey& key = scan->keys[k];
+      if (key.path.fields[depth] != f.number)
+        continue;
+      if (depth + 1 == key.path.size) {
+        key.value = f;
+        key.found = true;
+      } else if (f.wire == BYTES) {
+        down |= 1ULL << k;
+      }
+    }
+    // Bytes on the way may be a string rather than a message, they're
+    // given up on at their first malformed field.
+    if (down)
+      collect(scan, f.bytes, depth + 1, down);
+  }
+  return true;
+}
+
+void make_record(PbScan* scan, string_view msg) {
+  if (collect(scan, msg, scan->scope_size, scan->Begin()))
+    scan->MakeRecord(format_value);
+}
+
+// Walks down to the record messages.
+bool find_records(PbScan* scan, string_view msg, size_t depth) {
+  if (depth == scan->scope_size) {
+    make_record(scan, msg);
+    return true;
+  }
+
+  const char* p = msg.begin();
+  const char* end = msg.end();
+  PbField f;
+  while (p != end) {
+    if (!read_field(&p, end, &f))
+      return false;
+    if (f.wire == BYTES && f.number == scan->scope[depth])
+      find_records(scan, f.bytes, depth + 1);
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+bool ParsePbPath(const std::string& mapped, PbPath* path) {
+  string_view s(mapped);
+  path->format = PbPath::DEFAULT;
+  size_t colon = s.find(':');
+  if (colon != string_view::npos) {
+    string_view format = s.substr(colon + 1);
+    if (format == "int")
+      path->format = PbPath::INT;
+    else if (format == "sint")
+      path->format = PbPath::SINT;
+    else if (format == "float")
+      path->format = PbPath::FLOAT;
+    else if (format == "double")
+      path->format = PbPath::DOUBLE;
+    else
+      return false;
+    s = s.substr(0, colon);
+  }
+
+  // Field numbers run from 1 to 2^29 - 1.
+  path->size = 0;
+  while (true) {
+    uint32_t number = 0;
+    size_t i = 0;
+    for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i) {
+      number = number * 10 + (s[i] - '0');
+      if (number >= (1U << 29))
+        return false;
+    }
+    if (i == 0 || number == 0 || path->size == kPbMaxDepth)
+      return false;
+    path->fields[path->size++] = number;
+    if (i == s.size())
+      return true;
+    if (s[i] != '.')
+      return false;
+    s.remove_prefix(i + 1);
+  }
+}
+
+void ScanProtobuf(string_view msg, const std::vector<Rule::Key>& keys,
+                  RecordSet* res) {
+  PbScan scan;
+  if (scan.Init(keys, kPbMaxKeys, ParsePbPath, path_fields, res))
+    find_records(&scan, msg, 0);
+}
+
+} // namespace ext
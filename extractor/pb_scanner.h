@@ -0,0 +1,53 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#ifndef EXTRACTOR_PB_SCANNER_H_
+#define EXTRACTOR_PB_SCANNER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "extractor/rule.h"
+#include "extractor/parser.h"
+#include "extractor/third_party/string_view.h"
+
+namespace ext {
+// The longest path of a PB key, which bounds how deep nested messages
+// are looked into.
+const size_t kPbMaxDepth = 16;
+// The most keys a PB rule may have.
+const size_t kPbMaxKeys = 64;
+
+// A PB key is mapped to a path of field numbers, `1.3.2' is the field 2
+// of the message in the field 3 of the message in the field 1. Varints
+// and fixed values read as unsigned decimals unless the path ends with
+// a format: `:int' for two's complement and `:sint' for zigzag integers,
+// `:float' or `:double' for fixed32 or fixed64 floating points.
+// Length-delimited values are their bytes.
+struct PbPath {
+  enum Format { DEFAULT, INT, SINT, FLOAT, DOUBLE };
+
+  uint32_t fields[kPbMaxDepth];
+  size_t size;
+  Format format;
+};
+
+// Parses the path of a PB key. Returns false if it's malformed.
+bool ParsePbPath(const std::string& mapped, PbPath* path);
+
+// Extracts the records of the keys from a protobuf message, which is
+// walked once without its schema.
+//
+// A record is made of every message at the fields the paths of the keys
+// lead through in common, or of the message itself if there are none.
+// It takes the last value of each key inside it, as a parser takes the
+// last one of a singular field, and needs every key. Fields off the
+// paths are skipped where they are, groups included. A message that
+// turns out to be malformed yields no record, nothing after the error
+// is read.
+void ScanProtobuf(string_view msg, const std::vector<Rule::Key>& keys,
+                  RecordSet* res);
+
+} // namespace ext
+
+#endif // EXTRACTOR_PB_SCANNER_H_
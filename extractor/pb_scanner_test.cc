@@ -0,0 +1,367 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "extractor/pb_scanner.h"
+#include "extractor/filter.h"
+#include "extractor/scanner_test.h"
+
+using namespace ext;
+
+void Varint(std::string* s, uint64_t v) {
+  while (v >= 0x80) {
+    s->push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  s->push_back(static_cast<char>(v));
+}
+
+void Tag(std::string* s, uint32_t number, int wire) {
+  Varint(s, (static_cast<uint64_t>(number) << 3) | wire);
+}
+
+void VarintField(std::string* s, uint32_t number, uint64_t v) {
+  Tag(s, number, 0);
+  Varint(s, v);
+}
+
+void BytesField(std::string* s, uint32_t number, const std::string& v) {
+  Tag(s, number, 2);
+  Varint(s, v.size());
+  s->append(v);
+}
+
+void FixedField(std::string* s, uint32_t number, uint64_t v, int size) {
+  Tag(s, number, size == 8 ? 1 : 5);
+  for (int i = 0; i < size; ++i)
+    s->push_back(static_cast<char>(v >> (8 * i)));
+}
+
+void TestCasePbPath() {
+  PbPath path;
+  assert(ParsePbPath("1.3.2", &path));
+  assert(path.size == 3 && path.fields[0] == 1 && path.fields[1] == 3 &&
+         path.fields[2] == 2 && path.format == PbPath::DEFAULT);
+  assert(ParsePbPath("536870911:sint", &path));
+  assert(path.size == 1 && path.format == PbPath::SINT);
+  assert(ParsePbPath("1.1.1.1.1.1.1.1.1.1.1.1.1.1.1.1", &path));
+
+  const char* invalid[] = {
+    "", "0", "1.", ".1", "1..2", "1.a", "536870912", "1:", "1:bool",
+    "1.1.1.1.1.1.1.1.1.1.1.1.1.1.1.1.1", "-1",
+  };
+  for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+    assert(!ParsePbPath(invalid[i], &path));
+}
+
+void TestCaseScanProtobuf() {
+  static const char* const names[] = {
+    "PHONENUM", "1.3.2", "NICKNAME", "1.3.1",
+  };
+  auto keys = MakeKeys(names, 4);
+
+  // {1: {2: "x", 3: {1: "a", 2: "13812345678"}, 3: {2: ...}, 3: {...}}}
+  std::string user, inner;
+  VarintField(&user, 7, 12);
+  BytesField(&user, 2, "x");
+  BytesField(&inner, 1, "a");
+  BytesField(&inner, 2, "13812345678");
+  BytesField(&user, 3, inner);
+  inner.clear();
+  BytesField(&inner, 2, "13912345678");
+  BytesField(&user, 3, inner);
+  inner.clear();
+  // the last value of a singular field wins
+  BytesField(&inner, 1, "b");
+  BytesField(&inner, 2, "13712345678");
+  BytesField(&inner, 1, "c");
+  FixedField(&inner, 9, 1, 8);
+  BytesField(&user, 3, inner);
+  std::string msg;
+  BytesField(&msg, 1, user);
+
+  RecordSet res;
+  ScanProtobuf(msg, keys, &res);
+  assert(res.size() == 2);
+  assert(res[0]["PHONENUM"] == "13812345678" && res[0]["NICKNAME"] == "a");
+  assert(res[1]["PHONENUM"] == "13712345678" && res[1]["NICKNAME"] == "c");
+
+  // A malformed message yields nothing, the ones before it still do.
+  res.clear();
+  ScanProtobuf(msg.substr(0, msg.size() - 1), keys, &res);
+  assert(res.empty());
+  res.clear();
+  std::string broken = user;
+  BytesField(&broken, 3, std::string("\x0a\x05", 2));
+  msg.clear();
+  BytesField(&msg, 1, broken);
+  ScanProtobuf(msg, keys, &res);
+  assert(res.size() == 2);
+
+  // Formats, and groups skipped with whatever is inside them.
+  static const char* const formats[] = {
+    "A", "1", "B", "2:sint", "C", "3:int", "D", "4:double", "E", "5:float",
+    "F", "6:int",
+  };
+  keys = MakeKeys(formats, 12);
+  double lat = 39.9042;
+  float lon = 116.4074f;
+  uint64_t lat_bits;
+  uint32_t lon_bits;
+  memcpy(&lat_bits, &lat, 8);
+  memcpy(&lon_bits, &lon, 4);
+  msg.clear();
+  VarintField(&msg, 1, 18446744073709551615ULL);
+  VarintField(&msg, 2, 3);
+  Tag(&msg, 7, 3);
+  VarintField(&msg, 2, 4);
+  Tag(&msg, 8, 3);
+  BytesField(&msg, 1, "x");
+  Tag(&msg, 8, 4);
+  Tag(&msg, 7, 4);
+  VarintField(&msg, 3, static_cast<uint64_t>(-5));
+  FixedField(&msg, 4, lat_bits, 8);
+  FixedField(&msg, 5, lon_bits, 4);
+  FixedField(&msg, 6, 0xFFFFFFFE, 4);
+  res.clear();
+  ScanProtobuf(msg, keys, &res);
+  assert(res.size() == 1);
+  assert(res[0]["A"] == "18446744073709551615");
+  assert(res[0]["B"] == "-2");
+  assert(res[0]["C"] == "-5");
+  assert(res[0]["D"] == "39.9042");
+  assert(res[0]["E"] == "116.4074");
+  assert(res[0]["F"] == "-2");
+
+  // Floating point values with the fewest digits that read back to them.
+  static const char* const reals[] = { "D", "1:double", "E", "2:float" };
+  keys = MakeKeys(reals, 4);
+  const double doubles[] = { 1e-7, 1e300, 0.1, 1.0 / 3 };
+  const float floats[] = { 1e-7f, 3.4e38f, 0.1f, 1.0f / 3 };
+  const char* const strs[][2] = {
+    { "1e-07", "1e-07" }, { "1e+300", "3.4e+38" }, { "0.1", "0.1" },
+    { "0.3333333333333333", "0.33333334" },
+  };
+  for (size_t i = 0; i < sizeof(doubles) / sizeof(doubles[0]); ++i) {
+    memcpy(&lat_bits, &doubles[i], 8);
+    memcpy(&lon_bits, &floats[i], 4);
+    msg.clear();
+    FixedField(&msg, 1, lat_bits, 8);
+    FixedField(&msg, 2, lon_bits, 4);
+    res.clear();
+    ScanProtobuf(msg, keys, &res);
+    assert(res.size() == 1);
+    assert(res[0]["D"] == strs[i][0] && res[0]["E"] == strs[i][1]);
+  }
+
+  // a group that isn't closed by its own number
+  msg.clear();
+  VarintField(&msg, 1, 1);
+  Tag(&msg, 7, 3);
+  Tag(&msg, 8, 4);
+  res.clear();
+  ScanProtobuf(msg, keys, &res);
+  assert(res.empty());
+}
+
+// A message as a tree, the way the scanner has to see it.
+struct TestField {
+  uint32_t number;
+  int kind;  // 0 varint, 1 string, 2 message, 3 fixed64, 4 group
+  uint64_t value;
+  std::string bytes;
+  std::vector<TestField> children;
+};
+
+std::string Encode(const std::vector<TestField>& fields) {
+  std::string s;
+  for (size_t i = 0; i < fields.size(); ++i) {
+    const TestField& f = fields[i];
+    switch (f.kind) {
+    case 0: VarintField(&s, f.number, f.value); break;
+    case 1: BytesField(&s, f.number, f.bytes); break;
+    case 2: BytesField(&s, f.number, Encode(f.children)); break;
+    case 3: FixedField(&s, f.number, f.value, 8); break;
+    default:
+      Tag(&s, f.number, 3);
+      s += Encode(f.children);
+      Tag(&s, f.number, 4);
+      break;
+    }
+  }
+  return s;
+}
+
+const char* const kRandomValues[] = {
+  "13812345678", "+8613912345678", "x", "", "1",
+};
+
+// Strings go to the fields 1 and 2, messages to 3 and 4, so that a path
+// never runs into a string.
+void RandomMessage(std::vector<TestField>* fields, int depth) {
+  int n = rand() % 6;
+  for (int i = 0; i < n; ++i) {
+    TestField f;
+    f.value = 0;
+    int kind = depth > 4 ? rand() % 2 : rand() % 6;
+    switch (kind) {
+    case 0:
+      f.kind = 0;
+      f.number = 5;
+      f.value = rand() % 3 == 0 ? static_cast<uint64_t>(-rand()) : rand();
+      break;
+    case 1:
+      f.kind = 1;
+      f.number = 1 + rand() % 2;
+      f.bytes = kRandomValues[rand() % 5];
+      break;
+    case 2:
+    case 3:
+      f.kind = 2;
+      f.number = 3 + rand() % 2;
+      RandomMessage(&f.children, depth + 1);
+      break;
+    case 4:
+      f.kind = 3;
+      f.number = 5;
+      f.value = rand();
+      break;
+    default:
+      // a group with the fields of the keys in it
+      f.kind = 4;
+      f.number = 3 + rand() % 2;
+      RandomMessage(&f.children, depth + 1);
+      break;
+    }
+    fields->push_back(f);
+  }
+}
+
+typedef TreeKey<PbPath> PathKey;
+
+const uint32_t* Steps(const PbPath& path) {
+  return path.fields;
+}
+
+void TreeCollect(const std::vector<TestField>& fields, size_t depth,
+                 std::vector<PathKey>* keys) {
+  for (size_t i = 0; i < fields.size(); ++i) {
+    const TestField& f = fields[i];
+    if (f.kind == 4)
+      continue;
+    bool down = false;
+    for (size_t k = 0; k < keys->size(); ++k) {
+      PathKey& key = (*keys)[k];
+      if (depth >= key.path.size || key.path.fields[depth] != f.number)
+        continue;
+      if (depth + 1 < key.path.size) {
+        down = down || f.kind == 2;
+        continue;
+      }
+      key.found = true;
+      if (f.kind == 1) {
+        key.value = f.bytes;
+      } else if (f.kind == 2) {
+        key.value = Encode(f.children);
+      } else if (key.path.format == PbPath::SINT && f.kind == 0) {
+        key.value = std::to_string(static_cast<int64_t>(f.value >> 1) ^
+                                   -static_cast<int64_t>(f.value & 1));
+      } else {
+        key.value = std::to_string(f.value);
+      }
+    }
+    if (down) {
+      // only the keys going this way look into the message
+      std::vector<PathKey> sub(*keys);
+      for (size_t k = 0; k < sub.size(); ++k) {
+        if (sub[k].path.fields[depth] != f.number ||
+            depth + 1 >= sub[k].path.size)
+          sub[k].path.size = 0;
+      }
+      TreeCollect(f.children, depth + 1, &sub);
+      for (size_t k = 0; k < sub.size(); ++k) {
+        if (sub[k].path.size != 0 && sub[k].found) {
+          (*keys)[k].found = true;
+          (*keys)[k].value = sub[k].value;
+        }
+      }
+    }
+  }
+}
+
+void TreeRecords(const std::vector<TestField>& fields, size_t depth,
+                 const std::vector<Rule::Key>& keys,
+                 const std::vector<PbPath>& paths, size_t scope,
+                 RecordSet* res) {
+  if (depth < scope) {
+    for (size_t i = 0; i < fields.size(); ++i) {
+      if (fields[i].kind == 2 && fields[i].number == paths[0].fields[depth])
+        TreeRecords(fields[i].children, depth + 1, keys, paths, scope, res);
+    }
+    return;
+  }
+
+  std::vector<PathKey> tree_keys = TreeKeys(paths);
+  TreeCollect(fields, depth, &tree_keys);
+  TreeRecord(keys, tree_keys, res);
+}
+
+RecordSet ExpectedRecords(const std::vector<TestField>& fields,
+                          const std::vector<Rule::Key>& keys) {
+  std::vector<PbPath> paths;
+  size_t scope = TreePaths(keys, ParsePbPath, Steps, &paths);
+  RecordSet res;
+  TreeRecords(fields, 0, keys, paths, scope, &res);
+  return res;
+}
+
+void TestCaseScanProtobufRandom() {
+  static const char* const names[][4] = {
+    {"PHONENUM", "3.1", "NICKNAME", "3.2"},
+    {"PHONENUM", "3.4.1", NULL, NULL},
+    {"NICKNAME", "2", "APP_NAME", "5"},
+    {"NICKNAME", "4.2", "PHONENUM", "3.3.1"},
+    {"APP_NAME", "3.5:sint", "NICKNAME", "3.4"},
+  };
+  const size_t n = sizeof(names) / sizeof(names[0]);
+  std::vector<std::vector<Rule::Key> > keys;
+  for (size_t i = 0; i < n; ++i)
+    keys.push_back(MakeKeys(names[i], 4));
+
+  srand(1);
+  size_t records = 0;
+  for (int i = 0; i < 20000; ++i) {
+    std::vector<TestField> fields;
+    RandomMessage(&fields, 0);
+    std::string msg = Encode(fields);
+    for (size_t j = 0; j < n; ++j) {
+      RecordSet res;
+      ScanProtobuf(msg, keys[j], &res);
+      assert(res == ExpectedRecords(fields, keys[j]));
+      records += res.size();
+    }
+
+    // broken messages are read safely
+    if (!msg.empty()) {
+      msg[rand() % msg.size()] = static_cast<char>(rand());
+      msg.resize(rand() % (msg.size() + 1));
+      for (size_t j = 0; j < n; ++j) {
+        RecordSet res;
+        ScanProtobuf(msg, keys[j], &res);
+      }
+    }
+  }
+  assert(records > 0);
+}
+
+int main() {
+  TestCasePbPath();
+  TestCaseScanProtobuf();
+  TestCaseScanProtobufRandom();
+  return 0;
+}
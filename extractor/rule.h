@@ -9,18 +9,21 @@
 #include <unordered_map>
 
 #include "extractor/rule_define.h"
+#include "extractor/codec.h"
+#include "extractor/third_party/string_view.h"
 
 namespace ext {
 // Filter that format and checkout extraction value has valid,
 // it's declared in filter.h
 typedef bool (*Filter)(std::string*);
+typedef size_t (*Validator)(string_view in, char* out);
 
 struct Step {
   unsigned int type;
 
   int step;               // PREFIX/SUFFIX
   struct {
-    std::string pattern;  // PREFIX/SUFFIX
+    std::string pattern;  // PREFIX/SUFFIX, the name of PARAM
     int offset;           // START_POS/END_POS
     Skip::Type skip;      // SKIP/RSKIP
     int length_len;       // LEN_LENGTH
@@ -37,10 +40,11 @@ struct Step {
 struct Rule {
   struct Key {
     std::string key;    // extraction results key
-    std::string mapped; // JSON/XML attribute name
+    std::string mapped; // JSON/XML attribute name, PB/MSGPACK/THRIFT path
     int type;           // temporary value in internal declared,
                         // it has be used to get filter
     Filter filter;      // format and checkout extraction result
+    Validator validate; // same as filter, writes into a caller's buffer
   };
 
   RuleLayer::Type type;
@@ -61,13 +65,29 @@ struct Rule {
   int index;            // TYPE_LENGTH/LEN_LENGTH
   std::string tlv_type; // TYPE_LENGTH/LEN_LENGTH
   int type_len;         // TYPE_LENGTH
-  std::vector<Codec::Type> value_encode;
+  CodecChain value_encode;
+  // The codecs of the slice which are applied to the extracted value
+  // rather than the slice, see RuleLayer::kLateDecode.
+  CodecChain late_decode;
 
   // all special rule operators
   std::string head;         // JSON/XML/F0/F1 rule
   std::string tail;         // JSON/XML/F0/F1 rule
-  std::string group_split;  // F1 rule
-  std::string word_split;   // F1 rule
+  std::string group_split;  // F0 rule
+  std::string word_split;   // F0 rule
+
+  // The JSON/XML rules of the category, this one included, that parse the
+  // same content with the same head and tail, the document is parsed once
+  // for all of them. Empty if the rule shares it with none.
+  std::vector<int> doc_rules;
+
+  // Whether the rule or one of its sub rules starts with a PARAM step,
+  // the parameters of its content are indexed then.
+  bool params;
+
+  // The name id of RuleLayer::kHeader in RuleTree::header_ids, -1 if the
+  // rule is extracted from the whole head or isn't a head rule.
+  int header;
 
   Rule(): type(RuleLayer::UNKNOWN),
           gid(-1),
@@ -77,15 +97,45 @@ struct Rule {
           priority(1),
           big_endian(false),
           index(0),
-          type_len(0) {}
+          type_len(0),
+          params(false),
+          header(-1) {}
+};
+
+// Byte signature of the binary category, see BinaryAttributes::kSignature.
+struct Signature {
+  size_t offset;
+  std::string mask;   // same length as value
+  std::string value;  // has been masked
+
+  Signature(): offset(0) {}
 };
 
 struct Category {
   std::unordered_map<std::string, std::string> attribute;
   std::vector<Rule> rules;
   std::unordered_map<int /* GID */, int /* rule */> gids;
-  std::vector<Codec::Type> req_codec;
-  std::vector<Codec::Type> res_codec;
+  CodecChain req_codec;
+  CodecChain res_codec;
+  // How many leading bytes of the decoded content the rules can reach,
+  // std::string::npos if some rule may look at the whole content.
+  size_t req_reach;
+  size_t res_reach;
+  bool has_signature;
+  Signature signature;
+
+  Category(): req_reach(0), res_reach(0), has_signature(false) {}
+};
+
+// Categories of the binary application that have the same signature
+// offset and mask, the masked bytes of the payload is used to find out
+// categories directly instead of probing them one by one.
+struct Dispatch {
+  size_t offset;
+  std::string mask;
+  std::unordered_map<std::string, std::vector<int> /* cate */> table;
+
+  Dispatch(): offset(0) {}
 };
 
 struct Application {
@@ -94,12 +144,19 @@ struct Application {
   std::unordered_map<std::string, int> index;
   std::vector<int> wild_index;
   std::vector<Category> cates;
+
+  // TCP/UDP protocol only
+  std::vector<Dispatch> dispatch;
+  std::vector<int> unsigned_cates; // categories without signature
 };
 
 struct RuleTree {
   std::unordered_map<std::string, int> index;
   std::vector<int> wild_index;
   std::vector<Application> apps;
+  // The lowercase header names of the Header rules by their ids, which
+  // count from zero.
+  std::unordered_map<std::string, int> header_ids;
 };
 
 // Make an rule tree with buffer that who is shows
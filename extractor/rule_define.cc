@@ -143,12 +143,16 @@ const char* StepLayer::kIndex         = "Index";
 const char* StepLayer::kType          = "Type";
 const char* StepLayer::kSplit         = "Split";
 const char* StepLayer::kFormat        = "Format";
+const char* StepLayer::kParam         = "Param";
 const char* StepLayer::kKey           = "Key";
 const char* StepLayer::kJson          = "Json";
 const char* StepLayer::kJsonHead      = "JsonHead";
 const char* StepLayer::kXml           = "Xml";
 const char* StepLayer::kXmlHead       = "XmlHead";
 const char* StepLayer::kXmlEnd        = "XmlEnd";
+const char* StepLayer::kPb            = "Pb";
+const char* StepLayer::kMsgPack       = "MsgPack";
+const char* StepLayer::kThrift        = "Thrift";
 const char* StepLayer::kHead          = "Head";
 const char* StepLayer::kTail          = "Tail";
 const char* StepLayer::kGroupSplit    = "GroupSplit";
@@ -171,6 +175,7 @@ StepLayer::Type StepLayer::Mapped(const std::string& s) {
       { StepLayer::kType,         StepLayer::Type::TYPE         },
       { StepLayer::kSplit,        StepLayer::Type::SPLIT        },
       { StepLayer::kFormat,       StepLayer::Type::FORMAT       },
+      { StepLayer::kParam,        StepLayer::Type::PARAM        },
       { StepLayer::kUnify,        StepLayer::Type::UNIFY        },
       { StepLayer::kKey,          StepLayer::Type::KEY          },
       { StepLayer::kJson,         StepLayer::Type::JSON         },
@@ -178,6 +183,9 @@ StepLayer::Type StepLayer::Mapped(const std::string& s) {
       { StepLayer::kXml,          StepLayer::Type::XML          },
       { StepLayer::kXmlHead,      StepLayer::Type::XML_HEAD     },
       { StepLayer::kXmlEnd,       StepLayer::Type::XML_END      },
+      { StepLayer::kPb,           StepLayer::Type::PB           },
+      { StepLayer::kMsgPack,      StepLayer::Type::MSGPACK      },
+      { StepLayer::kThrift,       StepLayer::Type::THRIFT       },
       { StepLayer::kHead,         StepLayer::Type::HEAD         },
       { StepLayer::kTail,         StepLayer::Type::TAIL         },
       { StepLayer::kGroupSplit,   StepLayer::Type::GROUP_SPLIT  },
@@ -196,6 +204,9 @@ const char* RuleLayer::kJson          = "JSON";
 const char* RuleLayer::kXml           = "XML";
 const char* RuleLayer::kF0            = "F0";
 const char* RuleLayer::kF1            = "F1";
+const char* RuleLayer::kPb            = "PB";
+const char* RuleLayer::kMsgPack       = "MSGPACK";
+const char* RuleLayer::kThrift        = "THRIFT";
 // }
 const char* RuleLayer::kDataSource    = "DataSource";
 const char* RuleLayer::kIsEffect      = "IsEffect";
@@ -209,6 +220,8 @@ const char* RuleLayer::kConfidence    = "Confidence";
 const char* RuleLayer::kGroup         = "Group";
 const char* RuleLayer::kCoordinate    = "Coordinate";
 const char* RuleLayer::kOrigin        = "Origin";
+const char* RuleLayer::kLateDecode    = "LateDecode";
+const char* RuleLayer::kHeader        = "Header";
 
 RuleLayer::Type RuleLayer::Mapped(const std::string& s) {
   static const std::unordered_map<std::string, RuleLayer::Type> map{
@@ -216,6 +229,9 @@ RuleLayer::Type RuleLayer::Mapped(const std::string& s) {
       { RuleLayer::kXml,   RuleLayer::Type::XML  },
       { RuleLayer::kF0,    RuleLayer::Type::F0   },
       { RuleLayer::kF1,    RuleLayer::Type::F1   },
+      { RuleLayer::kPb,      RuleLayer::Type::PB      },
+      { RuleLayer::kMsgPack, RuleLayer::Type::MSGPACK },
+      { RuleLayer::kThrift,  RuleLayer::Type::THRIFT  },
   };
   MAKE_MAPPED_OPS(map, s)
 }
@@ -261,6 +277,7 @@ const char* BinaryAttributes::kProtocolAction = "ProtocolAction";
 const char* BinaryAttributes::kAppName        = "AppName";
 const char* BinaryAttributes::kAction         = "Action";
 const char* BinaryAttributes::kKeyword        = "Keyword";
+const char* BinaryAttributes::kSignature      = "Signature";
 // Message compression position
 const char* BinaryAttributes::kReqCntCompress = "ReqCntCompress";
 const char* BinaryAttributes::kResCntCompress = "ResCntCompress";
@@ -155,6 +155,7 @@ struct StepLayer {
     RSKIP,
     LEN_LENGTH,
     SPLIT,
+    PARAM,
 
     // below attributes
     VALUE_ENCODE,
@@ -171,6 +172,9 @@ struct StepLayer {
     XML,
     XML_HEAD,
     XML_END,
+    PB,
+    MSGPACK,
+    THRIFT,
     HEAD,
     TAIL,
     GROUP_SPLIT,
@@ -195,8 +199,11 @@ struct StepLayer {
   static const char* kType;
   static const char* kSplit;
   static const char* kFormat;
+  // The value of a query, form body or cookie parameter by name, it's
+  // the first operator of a rule if any.
+  static const char* kParam;
 
-  // For Json/Xml/F0/F1-rule
+  // For Json/Xml/F0/F1/Pb/MsgPack/Thrift-rule
   static const char* kKey;
 
   // For Json-rule
@@ -208,6 +215,15 @@ struct StepLayer {
   static const char* kXmlHead;
   static const char* kXmlEnd;
 
+  // For PB-rule
+  static const char* kPb;
+
+  // For MSGPACK-rule
+  static const char* kMsgPack;
+
+  // For THRIFT-rule
+  static const char* kThrift;
+
   // For F0/F1-rule
   static const char* kHead;       // For F0/F1-rule
   static const char* kTail;       // For F0/F1-rule
@@ -225,6 +241,9 @@ struct RuleLayer {
     XML,
     F0,
     F1,
+    PB,
+    MSGPACK,
+    THRIFT,
     UNKNOWN,
   };
 
@@ -235,6 +254,9 @@ struct RuleLayer {
   static const char* kXml;
   static const char* kF0;
   static const char* kF1;
+  static const char* kPb;
+  static const char* kMsgPack;
+  static const char* kThrift;
   // }
   static const char* kDataSource;
 
@@ -261,6 +283,16 @@ struct RuleLayer {
   static const char* kCoordinate;
   static const char* kOrigin;
 
+  // `1' to extract the field from the raw slice and to decode only the
+  // extracted value with the URL codec of the slice. It's taken only if
+  // the steps are PREFIX/SUFFIX whose patterns are ASCII and have no
+  // `%', `+' or space, which decoding can't make up.
+  static const char* kLateDecode;
+
+  // The name of the header that the REQUESTHEAD/RESPONSEHEAD rule is
+  // extracted from instead of the whole head, it's case-insensitive.
+  static const char* kHeader;
+
   static Type Mapped(const std::string& s);
 };
 
@@ -327,6 +359,7 @@ struct BinaryAttributes {
   // AppName         - optional
   // Action          - optional
   // Keyword         - optional
+  // Signature       - optional
   // Compress        - optional
   // Encode          - optional
 
@@ -336,6 +369,11 @@ struct BinaryAttributes {
   static const char* kAction;
   static const char* kKeyword;
 
+  // Fixed-offset opcode or magic of the request payload, layouts:
+  // `Offset:Value' or `Offset:Mask:Value', Mask and Value are hex
+  // strings with the same length, e.g. "4:FFF0:0120".
+  static const char* kSignature;
+
   /* Message compression position */
   static const char* kReqCntCompress;
   static const char* kResCntCompress;
@@ -3,12 +3,18 @@
 #include "extractor/rule_ops.h"
 
 #include <cassert>
+#include <cctype>
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 
 #include "extractor/rule.h"
 #include "extractor/filter.h"
 #include "extractor/trivial.h"
+#include "extractor/xml_scanner.h"
+#include "extractor/pb_scanner.h"
+#include "extractor/msgpack_scanner.h"
+#include "extractor/thrift_scanner.h"
 
 namespace ext {
 namespace {
@@ -36,6 +42,22 @@ std::string hex_to_string(const char* s, size_t n) {
   return res;
 }
 
+inline bool ascii_isxdigit(unsigned char c) {
+  return (c >= '0' && c <= '9') ||
+         (c >= 'a' && c <= 'f') ||
+         (c >= 'A' && c <= 'F');
+}
+
+bool is_hex_string(const std::string& s) {
+  if (s.empty() || s.size() % 2 != 0)
+    return false;
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (!ascii_isxdigit(s[i]))
+      return false;
+  }
+  return true;
+}
+
 inline std::string safe_string(const char* s, size_t n) {
   static const std::string empty_str;
   return n != 0 ? std::string(s, n) : empty_str;
@@ -56,19 +78,184 @@ inline std::string PieHexToString(const std::string& s) {
   return PieHexToString(s.data(), s.size());
 }
 
-bool GetCodec(const std::string& s, std::vector<Codec::Type>* out) {
+bool GetCodec(const std::string& s, CodecChain* out) {
   std::vector<std::string> vec;
   split(s.data(), s.size(), ",", &vec, true);
 
+  std::vector<Codec::Type> types;
   for (size_t i = 0; i < vec.size(); ++i) {
     Codec::Type type = Codec::Mapped(vec[i]);
     if (type == Codec::Type::UNKNOWN)
       return false;
-    out->push_back(type);
+    types.push_back(type);
+  }
+  *out = CodecChain(types);
+  return true;
+}
+
+// Returns how many leading bytes of the content the rule can reach, it's
+// bounded only when the content is cut by END_POS at a fixed position,
+// one more byte is needed to know the content is long enough.
+size_t GetReach(const Rule& rule) {
+  if (rule.type != RuleLayer::Type::UNKNOWN)
+    return std::string::npos;
+  size_t pos = 0;
+  for (size_t i = 0; i < rule.steps.size(); ++i) {
+    const Step& step = rule.steps[i];
+    if (step.type == StepLayer::Type::START_POS && step.s_offset > 0) {
+      pos += step.s_offset;
+    } else if (step.type == StepLayer::Type::END_POS && step.s_offset > 0) {
+      return pos + step.s_offset + 1;
+    } else {
+      break;
+    }
+  }
+  return std::string::npos;
+}
+
+// Returns the codecs of the slice that can be applied to the value that's
+// extracted from the raw slice, or an empty chain if it isn't safe. Only
+// URL decoding keeps the ASCII anchors where they are.
+CodecChain GetLateDecode(const Rule& rule, const Category& cate) {
+  static const CodecChain kUrl(std::vector<Codec::Type>(1, Codec::Type::URL));
+  const CodecChain* chain = &kUrl;
+  if (rule.data_src == DataSource::Type::REQ_CONTENT)
+    chain = &cate.req_codec;
+  else if (rule.data_src == DataSource::Type::RES_CONTENT)
+    chain = &cate.res_codec;
+  if (chain->size() != 1 || chain->types()[0] != Codec::Type::URL)
+    return CodecChain();
+
+  if (rule.type != RuleLayer::Type::UNKNOWN || rule.steps.empty())
+    return CodecChain();
+  for (size_t i = 0; i < rule.steps.size(); ++i) {
+    const Step& step = rule.steps[i];
+    if (step.type != StepLayer::Type::PREFIX &&
+        step.type != StepLayer::Type::SUFFIX &&
+        step.type != StepLayer::Type::PARAM) {
+      return CodecChain();
+    }
+    const std::string& pattern = step.s_pattern;
+    for (size_t j = 0; j < pattern.size(); ++j) {
+      unsigned char c = pattern[j];
+      if (c >= 0x80 || c == '%' || c == '+' || c == ' ')
+        return CodecChain();
+    }
+  }
+  return *chain;
+}
+
+// Whether the content of the data source is made of parameters.
+bool HasParams(DataSource::Type src) {
+  return src == DataSource::Type::URL || src == DataSource::Type::COOKIE ||
+         src == DataSource::Type::REQ_CONTENT;
+}
+
+// Returns the id of the header name, a new one if it's the first rule on
+// the header. Names are case-insensitive.
+int HeaderId(RuleTree* rt, const std::string& name) {
+  std::string lower(name);
+  for (size_t i = 0; i < lower.size(); ++i)
+    lower[i] = std::tolower(static_cast<unsigned char>(lower[i]));
+  auto iter = rt->header_ids.find(lower);
+  if (iter != rt->header_ids.end())
+    return iter->second;
+  int id = rt->header_ids.size();
+  rt->header_ids[lower] = id;
+  return id;
+}
+
+void AddReach(Category* cate, DataSource::Type src, size_t reach) {
+  if (src == DataSource::Type::REQ_CONTENT) {
+    cate->req_reach = std::max(cate->req_reach, reach);
+  } else if (src == DataSource::Type::RES_CONTENT) {
+    cate->res_reach = std::max(cate->res_reach, reach);
+  }
+}
+
+// Makes the JSON/XML rule share its document with the rules of the
+// category that parse the same content the same way.
+void ShareDocument(Category* cate, int index) {
+  Rule& rule = cate->rules[index];
+  if (rule.type != RuleLayer::Type::JSON && rule.type != RuleLayer::Type::XML)
+    return;
+
+  for (int i = 0; i < index; ++i) {
+    Rule& other = cate->rules[i];
+    if (other.type != rule.type || other.data_src != rule.data_src ||
+        other.late_decode.empty() != rule.late_decode.empty() ||
+        other.header != rule.header ||
+        other.head != rule.head || other.tail != rule.tail) {
+      continue;
+    }
+    std::vector<int> doc_rules = other.doc_rules;
+    if (doc_rules.empty())
+      doc_rules.push_back(i);
+    doc_rules.push_back(index);
+    for (size_t j = 0; j < doc_rules.size(); ++j)
+      cate->rules[doc_rules[j]].doc_rules = doc_rules;
+    return;
+  }
+}
+
+// Parses the signature with layouts `Offset:Value' or `Offset:Mask:Value'.
+bool GetSignature(const std::string& s, Signature* sig) {
+  std::vector<std::string> vec;
+  split(s.data(), s.size(), ":", &vec, false);
+  if (vec.size() != 2 && vec.size() != 3)
+    return false;
+
+  // The offsets are bounded well below the limit of stoul, no message is
+  // that long anyway.
+  const std::string& offset = vec[0];
+  if (offset.empty() || offset.size() > 9 ||
+      offset.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  const std::string& value = vec.back();
+  if (!is_hex_string(value))
+    return false;
+
+  sig->offset = std::stoul(offset);
+  sig->value = hex_to_string(value.data(), value.size());
+  if (vec.size() == 3 && !vec[1].empty()) {
+    const std::string& mask = vec[1];
+    if (!is_hex_string(mask) || mask.size() != value.size())
+      return false;
+    sig->mask = hex_to_string(mask.data(), mask.size());
+  } else {
+    sig->mask.assign(sig->value.size(), '\xFF');
   }
+
+  for (size_t i = 0; i < sig->value.size(); ++i)
+    sig->value[i] &= sig->mask[i];
   return true;
 }
 
+// Makes the category can be found by the dispatch table of application.
+void AddDispatch(Application* app, int index) {
+  const Category& cate = app->cates[index];
+  if (!cate.has_signature) {
+    app->unsigned_cates.push_back(index);
+    return;
+  }
+
+  const Signature& sig = cate.signature;
+  auto& dispatch = app->dispatch;
+  size_t i = 0;
+  for (; i < dispatch.size(); ++i) {
+    if (dispatch[i].offset == sig.offset && dispatch[i].mask == sig.mask)
+      break;
+  }
+  if (i == dispatch.size()) {
+    Dispatch d;
+    d.offset = sig.offset;
+    d.mask = sig.mask;
+    dispatch.push_back(d);
+  }
+  dispatch[i].table[sig.value].push_back(index);
+}
+
 // HTTP protocol
 int AppendHttpApp(RuleTree* rt, Attributes& attrs) {
   const std::string& host = attrs[HttpAttributes::kHost];
@@ -159,10 +346,18 @@ int AppendBinaryCate(RuleTree* rt, Attributes& attrs) {
   if (!GetCodec(codec, &cate.res_codec))
     return UNDEFINE_METHOD;
 
+  const std::string& signature = attrs[BinaryAttributes::kSignature];
+  if (!signature.empty()) {
+    if (!GetSignature(signature, &cate.signature))
+      return INVALID_RULE;
+    cate.has_signature = true;
+  }
+
   Application& last_app = rt->apps.back();
   size_t index = last_app.cates.size();
   last_app.cates.push_back(cate);
   last_app.index.insert({action, index});
+  AddDispatch(&last_app, index);
   return SUCCESS;
 }
 
@@ -294,17 +489,29 @@ int AppendRule(RuleTree* rt, Attributes& attrs,
       step.s_split = v[0];
       break;
 
+    case StepLayer::Type::PARAM:
+      // The parameter is looked up in the whole content.
+      if (!steps.empty())
+        return INVALID_STEP;
+      step.s_pattern = PieHexToString(v);
+      rule.params = true;
+      break;
+
     case StepLayer::Type::KEY: {
       Rule::Key key;
       key.key = v;
       key.type = MakeType(v);
       key.filter = FilterFactory(key.type);
+      key.validate = ValidatorFactory(key.type);
       rule.keys.push_back(key);
       continue;
     }
 
     case StepLayer::Type::JSON:
-    case StepLayer::Type::XML: {
+    case StepLayer::Type::XML:
+    case StepLayer::Type::PB:
+    case StepLayer::Type::MSGPACK:
+    case StepLayer::Type::THRIFT: {
       if (rule.keys.empty())
         return INVALID_STEP;
       Rule::Key& last_key = rule.keys.back();
@@ -346,8 +553,7 @@ int AppendRule(RuleTree* rt, Attributes& attrs,
   rule.type = RuleLayer::Mapped(vec[0]);
 
   switch (rule.type) {
-  case RuleLayer::Type::JSON:
-  case RuleLayer::Type::XML: {
+  case RuleLayer::Type::JSON: {
     for (size_t i = 0; i < rule.keys.size(); ++i) {
       if (rule.keys[i].mapped.empty())
         return INVALID_RULE;
@@ -355,6 +561,58 @@ int AppendRule(RuleTree* rt, Attributes& attrs,
     break;
   }
 
+  case RuleLayer::Type::XML: {
+    // Either attribute names or paths alike in anchoring.
+    XmlPath path;
+    for (size_t i = 0; i < rule.keys.size(); ++i) {
+      const auto& mapped = rule.keys[i].mapped;
+      if (mapped.empty())
+        return INVALID_RULE;
+      if (IsXmlPath(mapped) != IsXmlPath(rule.keys[0].mapped))
+        return INVALID_RULE;
+      if (!IsXmlPath(mapped))
+        continue;
+      bool anchored = mapped[0] == '/';
+      if (!ParseXmlPath(mapped, &path) ||
+          anchored != (rule.keys[0].mapped[0] == '/'))
+        return INVALID_RULE;
+    }
+    break;
+  }
+
+  case RuleLayer::Type::PB: {
+    PbPath path;
+    if (rule.keys.size() > kPbMaxKeys)
+      return INVALID_RULE;
+    for (size_t i = 0; i < rule.keys.size(); ++i) {
+      if (!ParsePbPath(rule.keys[i].mapped, &path))
+        return INVALID_RULE;
+    }
+    break;
+  }
+
+  case RuleLayer::Type::MSGPACK: {
+    MsgPackPath path;
+    if (rule.keys.size() > kMsgPackMaxKeys)
+      return INVALID_RULE;
+    for (size_t i = 0; i < rule.keys.size(); ++i) {
+      if (!ParseMsgPackPath(rule.keys[i].mapped, &path))
+        return INVALID_RULE;
+    }
+    break;
+  }
+
+  case RuleLayer::Type::THRIFT: {
+    ThriftPath path;
+    if (rule.keys.size() > kThriftMaxKeys)
+      return INVALID_RULE;
+    for (size_t i = 0; i < rule.keys.size(); ++i) {
+      if (!ParseThriftPath(rule.keys[i].mapped, &path))
+        return INVALID_RULE;
+    }
+    break;
+  }
+
   case RuleLayer::Type::F0: {
     if ((rule.group_split.empty() ||
          rule.word_split.empty())) {
@@ -369,11 +627,13 @@ int AppendRule(RuleTree* rt, Attributes& attrs,
       key.key = "RELATIONSHIP_NAME";
       key.type = MakeType(key.key);
       key.filter = FilterFactory(key.type);
+      key.validate = ValidatorFactory(key.type);
       rule.keys.push_back(key);
 
       key.key = "RELATIONSHIP_MOBILEPHONE";
       key.type = MakeType(key.key);
       key.filter = FilterFactory(key.type);
+      key.validate = ValidatorFactory(key.type);
       rule.keys.push_back(key);
     }
     break;
@@ -384,6 +644,7 @@ int AppendRule(RuleTree* rt, Attributes& attrs,
     key.key = attrs[RuleLayer::kKey];
     key.type = MakeType(key.key);
     key.filter = FilterFactory(key.type);
+    key.validate = ValidatorFactory(key.type);
 
     rule.keys.clear();
     rule.keys.push_back(key);
@@ -406,6 +667,18 @@ int AppendRule(RuleTree* rt, Attributes& attrs,
   rule.data_src = DataSource::Mapped(attrs[RuleLayer::kDataSource]);
   if (rule.data_src == DataSource::Type::UNKNOWN)
     return INVALID_RULE;
+  if (rule.params && (rule.type != RuleLayer::Type::UNKNOWN ||
+                      !HasParams(rule.data_src)))
+    return INVALID_RULE;
+  const std::string& header = attrs[RuleLayer::kHeader];
+  if (!header.empty()) {
+    if (last_app.protocol != Protocol::Type::HTTP ||
+        (rule.data_src != DataSource::Type::REQ_HEAD &&
+         rule.data_src != DataSource::Type::RES_HEAD)) {
+      return INVALID_RULE;
+    }
+    rule.header = HeaderId(rt, header);
+  }
   rule.coordinate = Coordinate::Mapped(attrs[RuleLayer::kCoordinate]);
   if (!attrs[RuleLayer::kConfidence].empty())
     rule.confidence = std::stoul(attrs[RuleLayer::kConfidence]);
@@ -413,11 +686,16 @@ int AppendRule(RuleTree* rt, Attributes& attrs,
     rule.priority = std::stoul(attrs[RuleLayer::kPriority]);
   rule.charset = attrs[RuleLayer::kCharacterSet];
 
+  AddReach(&last_cate, rule.data_src, GetReach(rule));
+  if (attrs[RuleLayer::kLateDecode] == "1")
+    rule.late_decode = GetLateDecode(rule, last_cate);
+
   rule.gid = -1;
   if (!attrs[RuleLayer::kGroup].empty())
     rule.gid = std::stoi(attrs[RuleLayer::kGroup]);
   if (rule.gid < 0) {
     last_cate.rules.push_back(rule);
+    ShareDocument(&last_cate, last_cate.rules.size() - 1);
   } else {
     auto& gids = last_cate.gids;
     auto iter = gids.find(rule.gid);
@@ -425,9 +703,27 @@ int AppendRule(RuleTree* rt, Attributes& attrs,
       // first rule in the groups, make it as head rule.
       gids[rule.gid] = last_cate.rules.size();
       last_cate.rules.push_back(rule);
+      ShareDocument(&last_cate, last_cate.rules.size() - 1);
     } else {
-      // otherwise, make it as sub rule.
-      last_cate.rules[iter->second].sub_rules.push_back(rule);
+      // otherwise, make it as sub rule, it's parsed on the content of
+      // the head rule.
+      Rule& head = last_cate.rules[iter->second];
+      if (rule.params && !HasParams(head.data_src))
+        return INVALID_RULE;
+      // The sub rule is parsed on the header of the head rule, if any.
+      if (rule.header != head.header)
+        return INVALID_RULE;
+      head.params = head.params || rule.params;
+      AddReach(&last_cate, head.data_src, GetReach(rule));
+      // The group is extracted from the raw slice only if all of its
+      // rules can be.
+      if (head.late_decode.empty() || rule.late_decode.empty()) {
+        head.late_decode = CodecChain();
+        for (size_t i = 0; i < head.sub_rules.size(); ++i)
+          head.sub_rules[i].late_decode = CodecChain();
+        rule.late_decode = CodecChain();
+      }
+      head.sub_rules.push_back(rule);
     }
   }
   return SUCCESS;
@@ -5,6 +5,7 @@
 #include <cassert>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
 
 #include "extractor/trivial.h"
 #include "extractor/rule.h"
@@ -125,6 +126,110 @@ static const char* valid_rule =
     ""
     "</pIE_RULES>";
 
+static const char* signature_rule =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+    "<pIE_RULES>"
+    "  <HOST HostId=\"20000007930\"  Protocol=\"TCP\"  \n"
+    "        Ip=\"10.0.0.1\"  Port=\"8000\"  PlaintextFeature=\"PK\"  >"
+    "    <URL UrlId=\"2000000793000000\"  Action=\"LOGIN\"  \n"
+    "          Signature=\"4:0101\"  >"
+    "    </URL>"
+    "    <URL UrlId=\"2000000793000001\"  Action=\"LOGOUT\"  \n"
+    "          Signature=\"4:FFF0:0102\"  >"
+    "    </URL>"
+    "    <URL UrlId=\"2000000793000002\"  Action=\"HEARTBEAT\"  \n"
+    "          Signature=\"4:0103\"  >"
+    "    </URL>"
+    "    <URL UrlId=\"2000000793000003\"  Action=\"OTHERS\"  >"
+    "    </URL>"
+    "  </HOST>"
+    "</pIE_RULES>";
+
+static const char* reach_rule =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+    "<pIE_RULES>"
+    "  <HOST HostId=\"20000007931\"  Host=\"reach.example.com\"  >"
+    "    <URL UrlId=\"2000000793100000\"  Url=\"/reach\"  \n"
+    "          ResCntCompress=\"GZIP\"  >"
+    "      <RULE RuleId=\"1000000793100000000\"  Key=\"IMSI\"  \n"
+    "            DataSource=\"REQUESTCONTENT\"  >"
+    "        <STEP StartPos=\"4\"  />"
+    "        <STEP EndPos=\"15\"  />"
+    "      </RULE>"
+    "      <RULE RuleId=\"1000000793100000001\"  Key=\"IMEI\"  \n"
+    "            DataSource=\"REQUESTCONTENT\"  >"
+    "        <STEP EndPos=\"8\"  />"
+    "      </RULE>"
+    "      <RULE RuleId=\"1000000793100000002\"  Key=\"PHONENUM\"  \n"
+    "            DataSource=\"RESPONSECONTENT\"  >"
+    "        <STEP Prefix=\"1-phone=\"  />"
+    "        <STEP EndPos=\"11\"  />"
+    "      </RULE>"
+    "    </URL>"
+    "  </HOST>"
+    "</pIE_RULES>";
+
+static const char* late_decode_rule =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+    "<pIE_RULES>"
+    "  <HOST HostId=\"20000007932\"  Host=\"late.example.com\"  >"
+    "    <URL UrlId=\"2000000793200000\"  Url=\"/late\"  \n"
+    "          ReqCntEncode=\"URL\"  ResCntCompress=\"GZIP\"  >"
+    "      <RULE RuleId=\"1000000793200000000\"  Key=\"NICKNAME\"  \n"
+    "            DataSource=\"URI\"  LateDecode=\"1\"  >"
+    "        <STEP Prefix=\"1-nick=\"  />"
+    "        <STEP Suffix=\"1-&amp;\"  />"
+    "      </RULE>"
+    "      <RULE RuleId=\"1000000793200000001\"  Key=\"NICKNAME\"  \n"
+    "            DataSource=\"URI\"  LateDecode=\"1\"  >"
+    "        <STEP Prefix=\"1-name%3D\"  />"
+    "      </RULE>"
+    "      <RULE RuleId=\"1000000793200000002\"  Key=\"PHONENUM\"  \n"
+    "            DataSource=\"REQUESTCONTENT\"  LateDecode=\"1\"  >"
+    "        <STEP Prefix=\"1-phone=\"  />"
+    "      </RULE>"
+    "      <RULE RuleId=\"1000000793200000003\"  Key=\"PHONENUM\"  \n"
+    "            DataSource=\"RESPONSECONTENT\"  LateDecode=\"1\"  >"
+    "        <STEP Prefix=\"1-phone=\"  />"
+    "      </RULE>"
+    "    </URL>"
+    "  </HOST>"
+    "</pIE_RULES>";
+
+static const char* share_rule =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+    "<pIE_RULES>"
+    "  <HOST HostId=\"20000007933\"  Host=\"share.example.com\"  >"
+    "    <URL UrlId=\"2000000793300000\"  Url=\"/share\"  >"
+    "      <RULE RuleId=\"1000000793300000000\"  Key=\"JSON-PHONENUM\"  \n"
+    "            DataSource=\"RESPONSECONTENT\"  >"
+    "        <STEP Key=\"PHONENUM\"  /><STEP Json=\"phone\"  />"
+    "      </RULE>"
+    "      <RULE RuleId=\"1000000793300000001\"  Key=\"XML-NICKNAME\"  \n"
+    "            DataSource=\"RESPONSECONTENT\"  >"
+    "        <STEP Key=\"NICKNAME\"  /><STEP Xml=\"nick\"  />"
+    "      </RULE>"
+    "      <RULE RuleId=\"1000000793300000002\"  Key=\"JSON-NICKNAME\"  \n"
+    "            DataSource=\"RESPONSECONTENT\"  >"
+    "        <STEP Key=\"NICKNAME\"  /><STEP Json=\"nick\"  />"
+    "      </RULE>"
+    "      <RULE RuleId=\"1000000793300000003\"  Key=\"JSON-IMEI\"  \n"
+    "            DataSource=\"RESPONSECONTENT\"  >"
+    "        <STEP Key=\"IMEI\"  /><STEP Json=\"imei\"  />"
+    "        <STEP JsonHead=\"{\"  />"
+    "      </RULE>"
+    "      <RULE RuleId=\"1000000793300000004\"  Key=\"JSON-IMSI\"  \n"
+    "            DataSource=\"REQUESTCONTENT\"  >"
+    "        <STEP Key=\"IMSI\"  /><STEP Json=\"imsi\"  />"
+    "      </RULE>"
+    "      <RULE RuleId=\"1000000793300000005\"  Key=\"JSON-IMSI\"  \n"
+    "            DataSource=\"RESPONSECONTENT\"  >"
+    "        <STEP Key=\"IMSI\"  /><STEP Json=\"imsi\"  />"
+    "      </RULE>"
+    "    </URL>"
+    "  </HOST>"
+    "</pIE_RULES>";
+
 void Read(const char* fname, std::string* out) {
   char tmp[4096];
   size_t size = 0;
@@ -138,9 +243,279 @@ static void RuleTreeTestCase(const char* s, size_t n) {
   assert(rt.apps.size() == 2);
 }
 
+static void SignatureTestCase(const char* s, size_t n) {
+  RuleTree rt = MakeRuleTree(s, n);
+  assert(rt.apps.size() == 1);
+  const Application& app = rt.apps[0];
+  assert(app.cates.size() == 4);
+  assert(app.unsigned_cates.size() == 1 && app.unsigned_cates[0] == 3);
+  // `4:0101' and `4:0103' are share the same dispatch table.
+  assert(app.dispatch.size() == 2);
+  assert(app.dispatch[0].table.size() == 2);
+  assert(app.dispatch[1].mask == "\xFF\xF0");
+  assert(app.cates[1].signature.value == std::string("\x01\x00", 2));
+}
+
+static void ReachTestCase(const char* s, size_t n) {
+  RuleTree rt = MakeRuleTree(s, n);
+  assert(rt.apps.size() == 1 && rt.apps[0].cates.size() == 1);
+  const Category& cate = rt.apps[0].cates[0];
+  // StartPos=4 and EndPos=15 reach the 20th byte, and one more byte.
+  assert(cate.req_reach == 20);
+  // The prefix may be found anywhere.
+  assert(cate.res_reach == std::string::npos);
+  assert(cate.res_codec.size() == 1);
+}
+
+static void LateDecodeTestCase(const char* s, size_t n) {
+  RuleTree rt = MakeRuleTree(s, n);
+  assert(rt.apps.size() == 1 && rt.apps[0].cates.size() == 1);
+  const std::vector<Rule>& rules = rt.apps[0].cates[0].rules;
+  assert(rules.size() == 4);
+  assert(rules[0].late_decode.size() == 1);
+  // `%' in the anchor could be made up by decoding.
+  assert(rules[1].late_decode.empty());
+  assert(rules[2].late_decode.size() == 1);
+  // The compressed content must be decoded as a whole.
+  assert(rules[3].late_decode.empty());
+}
+
+static void ShareDocumentTestCase(const char* s, size_t n) {
+  RuleTree rt = MakeRuleTree(s, n);
+  assert(rt.apps.size() == 1 && rt.apps[0].cates.size() == 1);
+  const std::vector<Rule>& rules = rt.apps[0].cates[0].rules;
+  assert(rules.size() == 6);
+  // The JSON rules on the response content without a head.
+  const int shared[] = {0, 2, 5};
+  for (size_t i = 0; i < 3; ++i) {
+    const std::vector<int>& doc_rules = rules[shared[i]].doc_rules;
+    assert(doc_rules == std::vector<int>(shared, shared + 3));
+  }
+  // Another type, head or data source.
+  assert(rules[1].doc_rules.empty());
+  assert(rules[3].head == "{" && rules[3].doc_rules.empty());
+  assert(rules[4].doc_rules.empty());
+}
+
+// A rule of a phone number and a nickname mapped to `phone' and `nick'
+// by steps named `step'.
+static std::string KeyRule(const char* type, const char* step,
+                           const char* phone, const char* nick) {
+  std::string s =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+      "<pIE_RULES>"
+      "  <HOST HostId=\"20000007934\"  Host=\"key.example.com\"  >"
+      "    <URL UrlId=\"2000000793400000\"  Url=\"/key\"  >"
+      "      <RULE RuleId=\"1000000793400000000\"  Key=\"";
+  s += type;
+  s += "-PHONENUM\"  \n"
+       "            DataSource=\"RESPONSECONTENT\"  >"
+       "        <STEP Key=\"PHONENUM\"  /><STEP ";
+  s += step;
+  s += "=\"";
+  s += phone;
+  s += "\"  /><STEP Key=\"NICKNAME\"  /><STEP ";
+  s += step;
+  s += "=\"";
+  s += nick;
+  s += "\"  />"
+       "      </RULE>"
+       "    </URL>"
+       "  </HOST>"
+       "</pIE_RULES>";
+  return s;
+}
+
+static bool Rejected(const std::string& s) {
+  try {
+    MakeRuleTree(s.data(), s.size());
+  } catch (const std::invalid_argument&) {
+    return true;
+  }
+  return false;
+}
+
+static void SignatureOffsetTestCase() {
+  std::string s = signature_rule;
+  size_t pos = s.find("4:0101");
+  s.replace(pos, 1, "999999999");
+  RuleTree rt = MakeRuleTree(s.data(), s.size());
+  assert(rt.apps[0].cates[0].signature.offset == 999999999);
+  // Overlong offsets are rejected rather than overflowing.
+  s.replace(pos, 9, "99999999999999999999999");
+  assert(Rejected(s));
+  s.replace(pos, 23, "x");
+  assert(Rejected(s));
+}
+
+static void XmlPathTestCase() {
+  std::string s = KeyRule("XML", "Xml", "user/@phone", "user/name/text()");
+  RuleTree rt = MakeRuleTree(s.data(), s.size());
+  assert(rt.apps.size() == 1 && rt.apps[0].cates.size() == 1);
+  assert(rt.apps[0].cates[0].rules.size() == 1);
+  s = KeyRule("XML", "Xml", "/r/user/@phone", "/r/nick/text()");
+  MakeRuleTree(s.data(), s.size());
+
+  // Malformed paths, and keys mapped unlike each other.
+  const char* const invalid[][2] = {
+    {"user/@phone", "nick"},
+    {"/user/@phone", "user/@nick"},
+    {"user/phone", "user/@nick"},
+    {"@phone", "user/@nick"},
+    {"user//@phone", "user/@nick"},
+    {"user/@", "user/@nick"},
+    {"user/@phone", "user/text"},
+    {"user/@phone", "user/@a b"},
+  };
+  for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+    assert(Rejected(KeyRule("XML", "Xml", invalid[i][0], invalid[i][1])));
+}
+
+static void PbPathTestCase() {
+  std::string s = KeyRule("PB", "Pb", "1.3.2", "1.3.1");
+  RuleTree rt = MakeRuleTree(s.data(), s.size());
+  assert(rt.apps.size() == 1 && rt.apps[0].cates.size() == 1);
+  const Rule& rule = rt.apps[0].cates[0].rules[0];
+  assert(rule.type == RuleLayer::Type::PB && rule.keys.size() == 2);
+  assert(rule.keys[0].mapped == "1.3.2");
+
+  assert(Rejected(KeyRule("PB", "Pb", "1.3.2", "1.x")));
+  assert(Rejected(KeyRule("PB", "Pb", "1.3.2", "1:bool")));
+}
+
+// A rule of a phone number from `src' by `steps'.
+static std::string ParamRule(const char* type, const char* src,
+                             const char* steps) {
+  std::string s =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+      "<pIE_RULES>"
+      "  <HOST HostId=\"20000007935\"  Host=\"param.example.com\"  >"
+      "    <URL UrlId=\"2000000793500000\"  Url=\"/param\"  >"
+      "      <RULE RuleId=\"1000000793500000000\"  Key=\"";
+  s += type;
+  s += "\"  DataSource=\"";
+  s += src;
+  s += "\"  LateDecode=\"1\"  >";
+  s += steps;
+  s += "      </RULE>"
+       "    </URL>"
+       "  </HOST>"
+       "</pIE_RULES>";
+  return s;
+}
+
+static void ParamTestCase() {
+  std::string s = ParamRule("PHONENUM", "URI",
+                            "<STEP Param=\"uid\"  /><STEP Suffix=\"1-#\"  />");
+  RuleTree rt = MakeRuleTree(s.data(), s.size());
+  const Rule& rule = rt.apps[0].cates[0].rules[0];
+  assert(rule.params && rule.steps.size() == 2);
+  assert(rule.steps[0].type == StepLayer::Type::PARAM);
+  assert(rule.steps[0].s_pattern == "uid");
+  assert(!rule.late_decode.empty());
+
+  s = ParamRule("PHONENUM", "COOKIE", "<STEP Param=\"a%20b\"  />");
+  rt = MakeRuleTree(s.data(), s.size());
+  assert(rt.apps[0].cates[0].rules[0].late_decode.empty());
+  s = ParamRule("PHONENUM", "REQUESTCONTENT", "<STEP Param=\"uid\"  />");
+  rt = MakeRuleTree(s.data(), s.size());
+  assert(rt.apps[0].cates[0].rules[0].params);
+
+  // Only first, only on parameters and only in normal rules.
+  assert(Rejected(ParamRule("PHONENUM", "URI",
+      "<STEP Prefix=\"1-?\"  /><STEP Param=\"uid\"  />")));
+  assert(Rejected(ParamRule("PHONENUM", "RESPONSECONTENT",
+      "<STEP Param=\"uid\"  />")));
+  assert(Rejected(ParamRule("JSON-PHONENUM", "URI",
+      "<STEP Key=\"PHONENUM\"  /><STEP Json=\"uid\"  />"
+      "<STEP Param=\"uid\"  />")));
+}
+
+// A rule of a device id from `src', or from the header if it's given.
+static std::string HeaderRule(const char* src, const char* header,
+                              const char* group) {
+  std::string s =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+      "<pIE_RULES>"
+      "  <HOST HostId=\"20000007936\"  Host=\"header.example.com\"  >"
+      "    <URL UrlId=\"2000000793600000\"  Url=\"/header\"  >"
+      "      <RULE RuleId=\"1000000793600000000\"  Key=\"IMEI\"  \n"
+      "            DataSource=\"REQUESTHEAD\"  Header=\"X-Device-Id\"  \n"
+      "            Group=\"1\"  >"
+      "        <STEP Prefix=\"1-imei=\"  />"
+      "      </RULE>"
+      "      <RULE RuleId=\"1000000793600000001\"  Key=\"IMSI\"  \n"
+      "            DataSource=\"";
+  s += src;
+  s += "\"  Header=\"";
+  s += header;
+  s += "\"  Group=\"";
+  s += group;
+  s += "\"  >"
+       "        <STEP Prefix=\"1-imsi=\"  />"
+       "      </RULE>"
+       "    </URL>"
+       "  </HOST>"
+       "</pIE_RULES>";
+  return s;
+}
+
+static void HeaderTestCase() {
+  // Names are case-insensitive and share their ids.
+  std::string s = HeaderRule("RESPONSEHEAD", "x-device-ID", "2");
+  RuleTree rt = MakeRuleTree(s.data(), s.size());
+  const std::vector<Rule>& rules = rt.apps[0].cates[0].rules;
+  assert(rules.size() == 2 && rt.header_ids.size() == 1);
+  assert(rt.header_ids["x-device-id"] == 0);
+  assert(rules[0].header == 0 && rules[1].header == 0);
+
+  s = HeaderRule("REQUESTHEAD", "", "2");
+  rt = MakeRuleTree(s.data(), s.size());
+  assert(rt.apps[0].cates[0].rules[1].header == -1);
+  s = HeaderRule("REQUESTHEAD", "Authorization", "2");
+  rt = MakeRuleTree(s.data(), s.size());
+  assert(rt.header_ids.size() == 2 && rt.header_ids["authorization"] == 1);
+
+  // A sub rule is on the header of its head rule.
+  s = HeaderRule("REQUESTHEAD", "X-DEVICE-ID", "1");
+  rt = MakeRuleTree(s.data(), s.size());
+  assert(rt.apps[0].cates[0].rules[0].sub_rules.size() == 1);
+  assert(Rejected(HeaderRule("REQUESTHEAD", "Authorization", "1")));
+  assert(Rejected(HeaderRule("REQUESTHEAD", "", "1")));
+  // Only heads have headers.
+  assert(Rejected(HeaderRule("URI", "Authorization", "2")));
+  assert(Rejected(HeaderRule("REQUESTCONTENT", "Authorization", "2")));
+}
+
+static void MsgPackThriftPathTestCase() {
+  std::string s = KeyRule("MSGPACK", "MsgPack", "user.phone", "user.nick");
+  RuleTree rt = MakeRuleTree(s.data(), s.size());
+  const Rule& rule = rt.apps[0].cates[0].rules[0];
+  assert(rule.type == RuleLayer::Type::MSGPACK && rule.keys.size() == 2);
+  assert(rule.keys[1].mapped == "user.nick");
+  assert(Rejected(KeyRule("MSGPACK", "MsgPack", "user.phone", "user..nick")));
+
+  s = KeyRule("THRIFT", "Thrift", "0.1.2", "0.1.1");
+  rt = MakeRuleTree(s.data(), s.size());
+  const Rule& thrift = rt.apps[0].cates[0].rules[0];
+  assert(thrift.type == RuleLayer::Type::THRIFT && thrift.keys.size() == 2);
+  assert(thrift.keys[0].mapped == "0.1.2");
+  assert(Rejected(KeyRule("THRIFT", "Thrift", "0.1.2", "32768")));
+}
+
 int main(int argc, char* argv[]) {
   if (argc == 1) {
     RuleTreeTestCase(valid_rule, strlen(valid_rule));
+    SignatureTestCase(signature_rule, strlen(signature_rule));
+    SignatureOffsetTestCase();
+    ReachTestCase(reach_rule, strlen(reach_rule));
+    LateDecodeTestCase(late_decode_rule, strlen(late_decode_rule));
+    ShareDocumentTestCase(share_rule, strlen(share_rule));
+    XmlPathTestCase();
+    PbPathTestCase();
+    MsgPackThriftPathTestCase();
+    ParamTestCase();
+    HeaderTestCase();
   } else {
     const char* rule_file = argv[1];
     std::string buf;
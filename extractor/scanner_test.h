@@ -0,0 +1,96 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#ifndef EXTRACTOR_SCANNER_TEST_H_
+#define EXTRACTOR_SCANNER_TEST_H_
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "extractor/rule.h"
+#include "extractor/parser.h"
+#include "extractor/filter.h"
+
+// What the tests of the XML, PB, MSGPACK and THRIFT scanners share: the
+// keys of a rule, and the records expected of a scan, which the tests
+// work out from the decoded data in the plain way.
+
+namespace ext {
+// Makes keys of (name, mapped) pairs, the pairs end at n or at a NULL
+// name.
+inline std::vector<Rule::Key> MakeKeys(const char* const* names, size_t n) {
+  std::vector<Rule::Key> keys;
+  for (size_t i = 0; i + 1 < n && names[i]; i += 2) {
+    Rule::Key key;
+    key.key = names[i];
+    key.mapped = names[i + 1];
+    key.type = MakeType(key.key);
+    key.filter = FilterFactory(key.type);
+    key.validate = ValidatorFactory(key.type);
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+// A key of the expected records with the last value of it found.
+template<typename Path>
+struct TreeKey {
+  Path path;
+  bool found;
+  std::string value;
+};
+
+// Parses the paths of the keys, returns how many steps they go through
+// in common but their last ones, which is where the records are.
+template<typename Path, typename Step>
+size_t TreePaths(const std::vector<Rule::Key>& keys,
+                 bool (*parse)(const std::string& mapped, Path* path),
+                 const Step* (*steps)(const Path& path),
+                 std::vector<Path>* paths) {
+  paths->resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i)
+    assert(parse(keys[i].mapped, &(*paths)[i]));
+  const Step* head = steps((*paths)[0]);
+  size_t scope = (*paths)[0].size - 1;
+  for (size_t i = 1; i < keys.size(); ++i) {
+    const Step* path = steps((*paths)[i]);
+    size_t j = 0;
+    while (j < scope && j + 1 < (*paths)[i].size && path[j] == head[j])
+      ++j;
+    scope = j;
+  }
+  return scope;
+}
+
+// The keys of a record at the paths, none found yet.
+template<typename Path>
+std::vector<TreeKey<Path> > TreeKeys(const std::vector<Path>& paths) {
+  std::vector<TreeKey<Path> > tree_keys(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    tree_keys[i].path = paths[i];
+    tree_keys[i].found = false;
+  }
+  return tree_keys;
+}
+
+// Pushes the record of the values found if every key has one that
+// passes its filter.
+template<typename Path>
+void TreeRecord(const std::vector<Rule::Key>& keys,
+                const std::vector<TreeKey<Path> >& tree_keys,
+                RecordSet* res) {
+  Record records;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    std::string value = tree_keys[i].value;
+    if (!tree_keys[i].found || value.empty())
+      return;
+    if (!keys[i].filter || keys[i].filter(&value))
+      records[keys[i].key] = value;
+  }
+  if (records.size() == keys.size())
+    res->push_back(records);
+}
+
+} // namespace ext
+
+#endif // EXTRACTOR_SCANNER_TEST_H_
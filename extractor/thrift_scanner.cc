@@ -0,0 +1,349 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include "extractor/thrift_scanner.h"
+
+#include <endian.h>
+#include <cstring>
+#include <string>
+
+#include "extractor/key_scan.h"
+
+namespace ext {
+namespace {
+enum CompactType {
+  STOP       = 0,
+  BOOL_TRUE  = 1,
+  BOOL_FALSE = 2,
+  BYTE       = 3,
+  I16        = 4,
+  I32        = 5,
+  I64        = 6,
+  DOUBLE     = 7,
+  BINARY     = 8,
+  LIST       = 9,
+  SET        = 10,
+  MAP        = 11,
+  STRUCT     = 12,
+  UUID       = 13,
+};
+
+// A scalar value, booleans are BOOL_TRUE with `b' set.
+struct ThriftValue {
+  int type;
+  bool b;
+  int64_t i;
+  double d;
+  string_view bytes;
+};
+
+int64_t zigzag(uint64_t v) {
+  return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+// Reads a scalar of `type', a boolean that's an `element' of a container
+// takes a byte of its own.
+bool read_scalar(const char** p, const char* end, int type, bool element,
+                 ThriftValue* v) {
+  uint64_t n;
+  v->type = type;
+  switch (type) {
+  case BOOL_TRUE: case BOOL_FALSE:
+    v->type = BOOL_TRUE;
+    if (!element) {
+      v->b = type == BOOL_TRUE;
+      return true;
+    }
+    if (*p == end)
+      return false;
+    v->b = *(*p)++ == BOOL_TRUE;
+    return true;
+  case BYTE:
+    if (*p == end)
+      return false;
+    v->i = static_cast<int8_t>(*(*p)++);
+    return true;
+  case I16: case I32: case I64:
+    if (!read_varint(p, end, &n))
+      return false;
+    v->i = zigzag(n);
+    return true;
+  case DOUBLE:
+    if (end - *p < 8)
+      return false;
+    memcpy(&n, *p, 8);
+    n = le64toh(n);
+    memcpy(&v->d, &n, sizeof(v->d));
+    *p += 8;
+    return true;
+  case BINARY:
+    return read_varint(p, end, &n) && read_bytes(p, end, n, &v->bytes);
+  case UUID:
+    return read_bytes(p, end, 16, &v->bytes);
+  default: return false;
+  }
+}
+
+// Reads the head of the next field of a struct, `type' is STOP after the
+// last one.
+bool read_field(const char** p, const char* end, int16_t* last,
+                int16_t* id, int* type) {
+  if (*p == end)
+    return false;
+  uint8_t b = static_cast<uint8_t>(*(*p)++);
+  *type = b & 0x0F;
+  if (*type == STOP)
+    return true;
+  if (b >> 4) {
+    *id = static_cast<int16_t>(*last + (b >> 4));
+  } else {
+    uint64_t v;
+    if (!read_varint(p, end, &v))
+      return false;
+    *id = static_cast<int16_t>(zigzag(v));
+  }
+  *last = *id;
+  return true;
+}
+
+// Reads the head of a list or set. Returns false if it's malformed or
+// holds more elements than there are bytes left, every element taking
+// one at least.
+bool read_list(const char** p, const char* end, int* type, uint64_t* n) {
+  if (*p == end)
+    return false;
+  uint8_t b = static_cast<uint8_t>(*(*p)++);
+  *type = b & 0x0F;
+  *n = b >> 4;
+  if (*n == 15 && !read_varint(p, end, n))
+    return false;
+  return *type != STOP && *n <= static_cast<uint64_t>(end - *p);
+}
+
+bool read_map(const char** p, const char* end, int* key_type,
+              int* value_type, uint64_t* n) {
+  if (!read_varint(p, end, n))
+    return false;
+  if (*n == 0)
+    return true;
+  if (*p == end)
+    return false;
+  uint8_t b = static_cast<uint8_t>(*(*p)++);
+  *key_type = b >> 4;
+  *value_type = b & 0x0F;
+  return *key_type != STOP && *value_type != STOP &&
+         *n <= static_cast<uint64_t>(end - *p) / 2;
+}
+
+bool skip(const char** p, const char* end, int type, bool element,
+          size_t level) {
+  if (type < LIST || type > STRUCT) {
+    ThriftValue v;
+    return read_scalar(p, end, type, element, &v);
+  }
+  if (level == kThriftMaxNesting)
+    return false;
+
+  uint64_t n;
+  int key_type, value_type;
+  switch (type) {
+  case LIST: case SET:
+    if (!read_list(p, end, &value_type, &n))
+      return false;
+    for (uint64_t i = 0; i < n; ++i) {
+      if (!skip(p, end, value_type, true, level + 1))
+        return false;
+    }
+    return true;
+  case MAP:
+    if (!read_map(p, end, &key_type, &value_type, &n))
+      return false;
+    for (uint64_t i = 0; i < n; ++i) {
+      if (!skip(p, end, key_type, true, level + 1) ||
+          !skip(p, end, value_type, true, level + 1))
+        return false;
+    }
+    return true;
+  default: {
+    int16_t last = 0, id;
+    while (true) {
+      if (!read_field(p, end, &last, &id, &type))
+        return false;
+      if (type == STOP)
+        return true;
+      if (!skip(p, end, type, false, level + 1))
+        return false;
+    }
+  }
+  }
+}
+
+typedef KeyScan<ThriftPath, ThriftValue, int16_t> ThriftScan;
+typedef ThriftScan::Key ThriftKey;
+
+const int16_t* path_fields(const ThriftPath& path) {
+  return path.fields;
+}
+
+void format_value(const ThriftKey& key, std::string* out) {
+  const ThriftValue& v = key.value;
+  switch (v.type) {
+  case BOOL_TRUE: *out = v.b ? "true" : "false"; break;
+  case DOUBLE: format_double(v.d, out); break;
+  case BINARY: out->assign(v.bytes.data(), v.bytes.size()); break;
+  default: *out = std::to_string(v.i); break;
+  }
+}
+
+// Reads a value of `type' for the keys in `mask', which are `depth'
+// fields down their paths: the ones that end there take a scalar, the
+// others look into a struct. Only the fields on the paths are entered.
+bool collect(ThriftScan* scan, const char** p, const char* end, int type,
+             bool element, size_t depth, uint64_t mask, size_t level) {
+  if (type == MAP || type == UUID)
+    return skip(p, end, type, element, level);
+  if (type != STRUCT && type != LIST && type != SET) {
+    ThriftValue v;
+    if (!read_scalar(p, end, type, element, &v))
+      return false;
+    scan->Found(mask, depth, v);
+    return true;
+  }
+  if (level == kThriftMaxNesting)
+    return false;
+
+  if (type != STRUCT) {
+    uint64_t n;
+    if (!read_list(p, end, &type, &n))
+      return false;
+    for (uint64_t i = 0; i < n; ++i) {
+      if (!collect(scan, p, end, type, true, depth, mask, level + 1))
+        return false;
+    }
+    return true;
+  }
+
+  int16_t last = 0, id;
+  while (true) {
+    if (!read_field(p, end, &last, &id, &type))
+      return false;
+    if (type == STOP)
+      return true;
+    uint64_t down = 0;
+    for (uint64_t m = mask; m; m &= m - 1) {
+      size_t k = __builtin_ctzll(m);
+      const ThriftPath& path = scan->keys[k].path;
+      if (path.size > depth && path.fields[depth] == id)
+        down |= 1ULL << k;
+    }
+    if (!(down ? collect(scan, p, end, type, false, depth + 1, down,
+                         level + 1)
+               : skip(p, end, type, false, level + 1)))
+      return false;
+  }
+}
+
+bool make_record(ThriftScan* scan, const char** p, const char* end,
+                 size_t level) {
+  if (!collect(scan, p, end, STRUCT, false, scan->scope_size, scan->Begin(),
+               level))
+    return false;
+  scan->MakeRecord(format_value);
+  return true;
+}
+
+// Walks a value of `type' down to the record structs.
+bool find_records(ThriftScan* scan, const char** p, const char* end,
+                  int type, bool element, size_t depth, size_t level) {
+  if (type != STRUCT && type != LIST && type != SET)
+    return skip(p, end, type, element, level);
+  if (level == kThriftMaxNesting)
+    return false;
+  if (type == STRUCT && depth == scan->scope_size)
+    return make_record(scan, p, end, level);
+
+  if (type != STRUCT) {
+    uint64_t n;
+    if (!read_list(p, end, &type, &n))
+      return false;
+    for (uint64_t i = 0; i < n; ++i) {
+      if (!find_records(scan, p, end, type, true, depth, level + 1))
+        return false;
+    }
+    return true;
+  }
+
+  int16_t last = 0, id;
+  while (true) {
+    if (!read_field(p, end, &last, &id, &type))
+      return false;
+    if (type == STOP)
+      return true;
+    if (!(id == scan->scope[depth]
+              ? find_records(scan, p, end, type, false, depth + 1,
+                             level + 1)
+              : skip(p, end, type, false, level + 1)))
+      return false;
+  }
+}
+
+// Skips the head of a message: the protocol id, the version and the
+// type, the sequence id and the method name. A struct can't be told
+// from a message by its first bytes alone, one that starts with a false
+// field 8 and then a true field is taken for a message.
+bool skip_message_head(const char** p, const char* end) {
+  if (end - *p < 2 || static_cast<uint8_t>((*p)[0]) != 0x82)
+    return true;
+  uint8_t b = static_cast<uint8_t>((*p)[1]);
+  if ((b & 0x1F) != 1 || (b >> 5) < 1 || (b >> 5) > 4)
+    return true;
+
+  const char* q = *p + 2;
+  uint64_t n;
+  string_view name;
+  if (!read_varint(&q, end, &n) || !read_varint(&q, end, &n) ||
+      !read_bytes(&q, end, n, &name))
+    return false;
+  *p = q;
+  return true;
+}
+
+} // anonymous namespace
+
+bool ParseThriftPath(const std::string& mapped, ThriftPath* path) {
+  string_view s(mapped);
+  path->size = 0;
+  while (true) {
+    int32_t id = 0;
+    size_t i = 0;
+    for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i) {
+      id = id * 10 + (s[i] - '0');
+      if (id > INT16_MAX)
+        return false;
+    }
+    if (i == 0 || path->size == kThriftMaxDepth)
+      return false;
+    path->fields[path->size++] = static_cast<int16_t>(id);
+    if (i == s.size())
+      return true;
+    if (s[i] != '.')
+      return false;
+    s.remove_prefix(i + 1);
+  }
+}
+
+void ScanThrift(string_view data, const std::vector<Rule::Key>& keys,
+                RecordSet* res) {
+  ThriftScan scan;
+  if (!scan.Init(keys, kThriftMaxKeys, ParseThriftPath, path_fields, res))
+    return;
+
+  const char* p = data.begin();
+  const char* end = data.end();
+  while (p != end) {
+    if (!skip_message_head(&p, end) ||
+        !find_records(&scan, &p, end, STRUCT, false, 0, 0))
+      return;
+  }
+}
+
+} // namespace ext
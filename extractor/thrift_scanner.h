@@ -0,0 +1,51 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#ifndef EXTRACTOR_THRIFT_SCANNER_H_
+#define EXTRACTOR_THRIFT_SCANNER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "extractor/rule.h"
+#include "extractor/parser.h"
+#include "extractor/third_party/string_view.h"
+
+namespace ext {
+// The longest path of a THRIFT key.
+const size_t kThriftMaxDepth = 16;
+// The most keys a THRIFT rule may have.
+const size_t kThriftMaxKeys = 64;
+// Structs and containers nested deeper than this make the data
+// malformed.
+const size_t kThriftMaxNesting = 64;
+
+// A THRIFT key is mapped to a path of field ids, `1.3.2' is the field 2
+// of the struct in the field 3 of the struct in the field 1. Ids run
+// from 0, the one of the success of a reply, to 32767.
+struct ThriftPath {
+  int16_t fields[kThriftMaxDepth];
+  size_t size;
+};
+
+// Parses the path of a THRIFT key. Returns false if it's malformed.
+bool ParseThriftPath(const std::string& mapped, ThriftPath* path);
+
+// Extracts the records of the keys from structs in the Thrift compact
+// protocol, which are walked once without their IDL. A struct may be
+// led by the head of the message it's the arguments or the result of.
+//
+// Lists and sets are looked through, every element of one is where the
+// list is, maps are skipped. A record is made of every struct at the
+// fields the paths of the keys go through in common, or of every top
+// struct if there are none. It takes the last scalar value of each key
+// inside it and needs every key: integers and doubles read as decimals,
+// booleans as `true' or `false', binaries as their bytes. Fields off the
+// paths are skipped where they are. Malformed data yields no record
+// from the structs that hold the error, nothing after it is read.
+void ScanThrift(string_view data, const std::vector<Rule::Key>& keys,
+                RecordSet* res);
+
+} // namespace ext
+
+#endif // EXTRACTOR_THRIFT_SCANNER_H_
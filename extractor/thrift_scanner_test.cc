@@ -0,0 +1,499 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "extractor/thrift_scanner.h"
+#include "extractor/filter.h"
+#include "extractor/scanner_test.h"
+
+using namespace ext;
+
+enum {
+  T_STOP, T_TRUE, T_FALSE, T_BYTE, T_I16, T_I32, T_I64, T_DOUBLE, T_BINARY,
+  T_LIST, T_SET, T_MAP, T_STRUCT, T_UUID,
+};
+
+void Varint(std::string* s, uint64_t v) {
+  while (v >= 0x80) {
+    s->push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  s->push_back(static_cast<char>(v));
+}
+
+void Zigzag(std::string* s, int64_t v) {
+  Varint(s, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+}
+
+void Binary(std::string* s, const std::string& v) {
+  Varint(s, v.size());
+  s->append(v);
+}
+
+// Writes the head of a field, the short form when it can.
+void Field(std::string* s, int16_t* last, int16_t id, int type) {
+  int delta = id - *last;
+  if (delta > 0 && delta <= 15) {
+    s->push_back(static_cast<char>(delta << 4 | type));
+  } else {
+    s->push_back(static_cast<char>(type));
+    Zigzag(s, id);
+  }
+  *last = id;
+}
+
+void List(std::string* s, int type, uint64_t n) {
+  if (n < 15) {
+    s->push_back(static_cast<char>(n << 4 | type));
+  } else {
+    s->push_back(static_cast<char>(0xF0 | type));
+    Varint(s, n);
+  }
+}
+
+void TestCaseThriftPath() {
+  ThriftPath path;
+  assert(ParseThriftPath("1.3.2", &path));
+  assert(path.size == 3 && path.fields[0] == 1 && path.fields[1] == 3 &&
+         path.fields[2] == 2);
+  assert(ParseThriftPath("0.32767", &path));
+  assert(path.size == 2 && path.fields[0] == 0 && path.fields[1] == 32767);
+  assert(ParseThriftPath("1.1.1.1.1.1.1.1.1.1.1.1.1.1.1.1", &path));
+
+  const char* invalid[] = {
+    "", "1.", ".1", "1..2", "1.a", "32768", "-1", "1:int",
+    "1.1.1.1.1.1.1.1.1.1.1.1.1.1.1.1.1",
+  };
+  for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+    assert(!ParseThriftPath(invalid[i], &path));
+}
+
+void TestCaseScanThrift() {
+  static const char* const names[] = {
+    "PHONENUM", "1.3.2", "NICKNAME", "1.3.1",
+  };
+  auto keys = MakeKeys(names, 4);
+
+  // {1: {7: 12, 2: "x", 3: [{1: "a", 2: "13812345678"},
+  //   {2: "13912345678"}, {1: "b", 2: "13712345678", 1: "c"}]}}
+  std::string data;
+  int16_t last = 0, user = 0, inner = 0;
+  Field(&data, &last, 1, T_STRUCT);
+  Field(&data, &user, 7, T_I32);
+  Zigzag(&data, 12);
+  Field(&data, &user, 2, T_BINARY);
+  Binary(&data, "x");
+  Field(&data, &user, 3, T_LIST);
+  List(&data, T_STRUCT, 3);
+  Field(&data, &inner, 1, T_BINARY);
+  Binary(&data, "a");
+  Field(&data, &inner, 2, T_BINARY);
+  Binary(&data, "13812345678");
+  data.push_back(T_STOP);
+  inner = 0;
+  Field(&data, &inner, 2, T_BINARY);
+  Binary(&data, "13912345678");
+  data.push_back(T_STOP);
+  inner = 0;
+  Field(&data, &inner, 1, T_BINARY);
+  Binary(&data, "b");
+  Field(&data, &inner, 2, T_BINARY);
+  Binary(&data, "13712345678");
+  Field(&data, &inner, 1, T_BINARY);
+  Binary(&data, "c");
+  data.push_back(T_STOP);
+  data.push_back(T_STOP);
+  data.push_back(T_STOP);
+
+  RecordSet res;
+  ScanThrift(data, keys, &res);
+  assert(res.size() == 2);
+  assert(res[0]["PHONENUM"] == "13812345678" && res[0]["NICKNAME"] == "a");
+  assert(res[1]["PHONENUM"] == "13712345678" && res[1]["NICKNAME"] == "c");
+
+  // Truncated data yields nothing from the structs holding the error.
+  res.clear();
+  ScanThrift(data.substr(0, data.size() - 3), keys, &res);
+  assert(res.size() == 1);
+
+  // The struct of a call or a reply.
+  std::string message("\x82\x21", 2);
+  Varint(&message, 9);
+  Binary(&message, "getUser");
+  res.clear();
+  ScanThrift(message + data + message + data, keys, &res);
+  assert(res.size() == 4);
+  static const char* const success[] = {
+    "PHONENUM", "0.1.3.2", "NICKNAME", "0.1.3.1",
+  };
+  keys = MakeKeys(success, 4);
+  message[1] = '\x41';
+  last = 0;
+  Field(&message, &last, 0, T_STRUCT);
+  res.clear();
+  ScanThrift(message + data + std::string(1, T_STOP), keys, &res);
+  assert(res.size() == 2);
+
+  // Every kind of scalar, ids in the long form and fields off the paths
+  // of any kind.
+  static const char* const kinds[] = {
+    "A", "1", "B", "2", "C", "3", "D", "4", "E", "5", "F", "6",
+    "G", "300", "H", "8", "I", "9", "J", "10",
+  };
+  keys = MakeKeys(kinds, 20);
+  double lat = 39.9042;
+  uint64_t lat_bits;
+  memcpy(&lat_bits, &lat, 8);
+  data.clear();
+  last = 0;
+  Field(&data, &last, 300, T_I64);
+  Zigzag(&data, -9000000000LL);
+  Field(&data, &last, 1, T_TRUE);
+  Field(&data, &last, 2, T_FALSE);
+  Field(&data, &last, 3, T_BYTE);
+  data.push_back('\xFB');
+  Field(&data, &last, 4, T_I16);
+  Zigzag(&data, -300);
+  Field(&data, &last, 5, T_I32);
+  Zigzag(&data, 2147483647);
+  Field(&data, &last, 6, T_DOUBLE);
+  for (int i = 0; i < 8; ++i)
+    data.push_back(static_cast<char>(lat_bits >> (8 * i)));
+  Field(&data, &last, 7, T_MAP);
+  Varint(&data, 2);
+  data.push_back(T_BINARY << 4 | T_LIST);
+  Binary(&data, "k");
+  List(&data, T_I32, 0);
+  Binary(&data, "l");
+  List(&data, T_STRUCT, 1);
+  data.push_back(T_STOP);
+  Field(&data, &last, 8, T_UUID);
+  data.append(16, 'u');
+  Field(&data, &last, 8, T_BINARY);
+  Binary(&data, "uuid");
+  // a list of booleans, the last one wins
+  Field(&data, &last, 9, T_SET);
+  List(&data, T_TRUE, 2);
+  data.push_back(T_TRUE);
+  data.push_back(T_FALSE);
+  Field(&data, &last, 10, T_LIST);
+  List(&data, T_BINARY, 20);
+  for (int i = 0; i < 20; ++i)
+    Binary(&data, std::to_string(i));
+  Field(&data, &last, 11, T_STRUCT);
+  for (int i = 0; i < 20; ++i) {
+    int16_t nested = 0;
+    Field(&data, &nested, 1, T_STRUCT);
+  }
+  data.append(22, T_STOP);
+  res.clear();
+  ScanThrift(data, keys, &res);
+  assert(res.size() == 1);
+  assert(res[0]["A"] == "true");
+  assert(res[0]["B"] == "false");
+  assert(res[0]["C"] == "-5");
+  assert(res[0]["D"] == "-300");
+  assert(res[0]["E"] == "2147483647");
+  assert(res[0]["F"] == "39.9042");
+  assert(res[0]["G"] == "-9000000000");
+  assert(res[0]["H"] == "uuid");
+  assert(res[0]["I"] == "false");
+  assert(res[0]["J"] == "19");
+
+  // Doubles with the fewest digits that read back to them.
+  static const char* const doubles[] = { "F", "6", "G", "7" };
+  keys = MakeKeys(doubles, 4);
+  const double values[] = { 1e-7, 1e300 };
+  data.clear();
+  last = 0;
+  for (int16_t id = 6; id <= 7; ++id) {
+    memcpy(&lat_bits, &values[id - 6], 8);
+    Field(&data, &last, id, T_DOUBLE);
+    for (int i = 0; i < 8; ++i)
+      data.push_back(static_cast<char>(lat_bits >> (8 * i)));
+  }
+  data.push_back(T_STOP);
+  res.clear();
+  ScanThrift(data, keys, &res);
+  assert(res.size() == 1);
+  assert(res[0]["F"] == "1e-07" && res[0]["G"] == "1e+300");
+
+  // Nesting too deep is malformed even off the paths, so is a count
+  // larger than the data.
+  keys = MakeKeys(kinds, 2);
+  for (size_t n = kThriftMaxNesting - 1; n <= kThriftMaxNesting; ++n) {
+    data.clear();
+    last = 0;
+    Field(&data, &last, 1, T_TRUE);
+    for (size_t i = 0; i < n; ++i) {
+      int16_t nested = 0;
+      Field(&data, &nested, 2, T_STRUCT);
+    }
+    data.append(n + 1, T_STOP);
+    res.clear();
+    ScanThrift(data, keys, &res);
+    assert(res.size() == (n < kThriftMaxNesting ? 1U : 0U));
+  }
+  data.clear();
+  last = 0;
+  Field(&data, &last, 1, T_TRUE);
+  Field(&data, &last, 2, T_LIST);
+  List(&data, T_STRUCT, 1000);
+  data.push_back(T_STOP);
+  res.clear();
+  ScanThrift(data, keys, &res);
+  assert(res.empty());
+}
+
+// A value as a tree, the way the scanner has to see it.
+struct TestValue {
+  int type;
+  int16_t id;    // of a field
+  int element;   // the type of the elements of a list
+  int64_t i;     // of an integer or a boolean
+  std::string bytes;
+  std::vector<TestValue> children;  // fields of a struct, elements of a
+                                    // list, pairs of a map
+};
+
+void Encode(const TestValue& v, bool element, std::string* s) {
+  switch (v.type) {
+  case T_TRUE:
+    if (element)
+      s->push_back(v.i ? T_TRUE : T_FALSE);
+    break;
+  case T_I64: Zigzag(s, v.i); break;
+  case T_BINARY: Binary(s, v.bytes); break;
+  case T_LIST:
+    List(s, v.element, v.children.size());
+    for (size_t i = 0; i < v.children.size(); ++i)
+      Encode(v.children[i], true, s);
+    break;
+  case T_MAP:
+    Varint(s, v.children.size() / 2);
+    if (!v.children.empty())
+      s->push_back(T_BINARY << 4 | T_I64);
+    for (size_t i = 0; i < v.children.size(); ++i)
+      Encode(v.children[i], true, s);
+    break;
+  default: {
+    int16_t last = 0;
+    for (size_t i = 0; i < v.children.size(); ++i) {
+      const TestValue& f = v.children[i];
+      int type = f.type == T_TRUE && !f.i ? T_FALSE : f.type;
+      Field(s, &last, f.id, type);
+      Encode(f, false, s);
+    }
+    s->push_back(T_STOP);
+    break;
+  }
+  }
+}
+
+const char* const kRandomValues[] = {
+  "13812345678", "+8613912345678", "x", "", "1",
+};
+
+TestValue Scalar(int type) {
+  TestValue v;
+  v.type = type;
+  v.id = 0;
+  v.element = 0;
+  v.i = 0;
+  if (type == T_BINARY)
+    v.bytes = kRandomValues[rand() % 5];
+  else if (type == T_TRUE)
+    v.i = rand() % 2;
+  else
+    v.i = rand() % 3 == 0 ? -rand() : rand();
+  return v;
+}
+
+// Strings go to the fields 1 and 2, structs to 3 and 4, so that a path
+// never runs into a string.
+void RandomStruct(TestValue* v, int depth) {
+  v->type = T_STRUCT;
+  v->element = 0;
+  v->i = 0;
+  int n = rand() % 6;
+  for (int i = 0; i < n; ++i) {
+    TestValue f;
+    int kind = depth > 4 ? rand() % 2 : rand() % 9;
+    switch (kind) {
+    case 0:
+      f = Scalar(T_I64);
+      f.id = rand() % 2 ? 5 : 300;
+      break;
+    case 1:
+      f = Scalar(T_BINARY);
+      f.id = 1 + rand() % 2;
+      break;
+    case 2:
+    case 3:
+      RandomStruct(&f, depth + 1);
+      f.id = 3 + rand() % 2;
+      break;
+    case 4:
+      f = Scalar(T_LIST);
+      f.type = T_LIST;
+      f.element = T_STRUCT;
+      f.children.resize(rand() % 4);
+      for (size_t j = 0; j < f.children.size(); ++j)
+        RandomStruct(&f.children[j], depth + 1);
+      f.id = 3 + rand() % 2;
+      break;
+    case 5:
+      f = Scalar(T_LIST);
+      f.type = T_LIST;
+      f.element = T_BINARY;
+      for (int j = rand() % 4; j > 0; --j)
+        f.children.push_back(Scalar(T_BINARY));
+      f.id = 1 + rand() % 2;
+      break;
+    case 6:
+      f = Scalar(T_MAP);
+      f.type = T_MAP;
+      for (int j = rand() % 3; j > 0; --j) {
+        f.children.push_back(Scalar(T_BINARY));
+        f.children.push_back(Scalar(T_I64));
+      }
+      f.id = 3 + rand() % 2;
+      break;
+    default:
+      f = Scalar(T_TRUE);
+      f.id = 6;
+      break;
+    }
+    v->children.push_back(f);
+  }
+}
+
+typedef TreeKey<ThriftPath> PathKey;
+
+const int16_t* Steps(const ThriftPath& path) {
+  return path.fields;
+}
+
+void TreeCollect(const TestValue& v, size_t depth,
+                 const std::vector<size_t>& active,
+                 std::vector<PathKey>* keys) {
+  if (v.type == T_MAP)
+    return;
+  if (v.type == T_LIST) {
+    for (size_t i = 0; i < v.children.size(); ++i)
+      TreeCollect(v.children[i], depth, active, keys);
+    return;
+  }
+  if (v.type == T_STRUCT) {
+    for (size_t i = 0; i < v.children.size(); ++i) {
+      std::vector<size_t> down;
+      for (size_t k = 0; k < active.size(); ++k) {
+        const ThriftPath& path = (*keys)[active[k]].path;
+        if (path.size > depth && path.fields[depth] == v.children[i].id)
+          down.push_back(active[k]);
+      }
+      if (!down.empty())
+        TreeCollect(v.children[i], depth + 1, down, keys);
+    }
+    return;
+  }
+
+  for (size_t k = 0; k < active.size(); ++k) {
+    PathKey& key = (*keys)[active[k]];
+    if (key.path.size != depth)
+      continue;
+    key.found = true;
+    if (v.type == T_BINARY)
+      key.value = v.bytes;
+    else if (v.type == T_TRUE)
+      key.value = v.i ? "true" : "false";
+    else
+      key.value = std::to_string(v.i);
+  }
+}
+
+void TreeRecords(const TestValue& v, size_t depth,
+                 const std::vector<Rule::Key>& keys,
+                 const std::vector<ThriftPath>& paths, size_t scope,
+                 RecordSet* res) {
+  if (v.type == T_LIST) {
+    for (size_t i = 0; i < v.children.size(); ++i)
+      TreeRecords(v.children[i], depth, keys, paths, scope, res);
+    return;
+  }
+  if (v.type != T_STRUCT)
+    return;
+  if (depth < scope) {
+    for (size_t i = 0; i < v.children.size(); ++i) {
+      if (v.children[i].id == paths[0].fields[depth])
+        TreeRecords(v.children[i], depth + 1, keys, paths, scope, res);
+    }
+    return;
+  }
+
+  std::vector<PathKey> tree_keys = TreeKeys(paths);
+  std::vector<size_t> active;
+  for (size_t i = 0; i < keys.size(); ++i)
+    active.push_back(i);
+  TreeCollect(v, depth, active, &tree_keys);
+  TreeRecord(keys, tree_keys, res);
+}
+
+RecordSet ExpectedRecords(const TestValue& v,
+                          const std::vector<Rule::Key>& keys) {
+  std::vector<ThriftPath> paths;
+  size_t scope = TreePaths(keys, ParseThriftPath, Steps, &paths);
+  RecordSet res;
+  TreeRecords(v, 0, keys, paths, scope, &res);
+  return res;
+}
+
+void TestCaseScanThriftRandom() {
+  static const char* const names[][4] = {
+    {"PHONENUM", "3.1", "NICKNAME", "3.2"},
+    {"PHONENUM", "3.4.1", NULL, NULL},
+    {"NICKNAME", "2", "APP_NAME", "300"},
+    {"NICKNAME", "4.2", "PHONENUM", "3.3.1"},
+    {"APP_NAME", "3.6", "NICKNAME", "3.4.2"},
+  };
+  const size_t n = sizeof(names) / sizeof(names[0]);
+  std::vector<std::vector<Rule::Key> > keys;
+  for (size_t i = 0; i < n; ++i)
+    keys.push_back(MakeKeys(names[i], 4));
+
+  srand(1);
+  size_t records = 0;
+  for (int i = 0; i < 20000; ++i) {
+    TestValue v;
+    RandomStruct(&v, 0);
+    std::string data;
+    Encode(v, false, &data);
+    for (size_t j = 0; j < n; ++j) {
+      RecordSet res;
+      ScanThrift(data, keys[j], &res);
+      assert(res == ExpectedRecords(v, keys[j]));
+      records += res.size();
+    }
+
+    // broken data is read safely
+    data[rand() % data.size()] = static_cast<char>(rand());
+    data.resize(rand() % (data.size() + 1));
+    for (size_t j = 0; j < n; ++j) {
+      RecordSet res;
+      ScanThrift(data, keys[j], &res);
+    }
+  }
+  assert(records > 0);
+}
+
+int main() {
+  TestCaseThriftPath();
+  TestCaseScanThrift();
+  TestCaseScanThriftRandom();
+  return 0;
+}
@@ -0,0 +1,493 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include "extractor/xml_scanner.h"
+
+#include <expat.h>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <new>
+#include <string>
+
+namespace ext {
+namespace {
+// The expat parser of a thread, it's reset rather than recreated for
+// every document.
+struct XmlParser {
+  XML_Parser parser;
+
+  XmlParser(): parser(NULL) {}
+
+  ~XmlParser() {
+    if (parser)
+      XML_ParserFree(parser);
+  }
+};
+
+XML_Parser acquire_parser() {
+  static thread_local XmlParser xp;
+  if (!xp.parser || XML_ParserReset(xp.parser, "utf-8") != XML_TRUE) {
+    if (xp.parser)
+      XML_ParserFree(xp.parser);
+    xp.parser = XML_ParserCreate("utf-8");
+    if (!xp.parser)
+      throw std::bad_alloc();
+  }
+  return xp.parser;
+}
+
+// An attribute name that some keys map to, and the value of it gathered
+// since the last element end.
+struct XmlSlot {
+  const std::string* name;
+  std::string value;
+  std::string scratch;  // the value filtered for one key set
+  bool seen;
+
+  XmlSlot(): name(NULL), seen(false) {}
+};
+
+enum PathState { kNone, kText, kDone };
+
+// A key mapped to a path, and its value in the current record element.
+struct PathKey {
+  const Rule::Key* key;
+  XmlPath path;
+  size_t first;           // path.elements[first, ...) are below the
+                          // record element
+  std::vector<int> fail;  // of the elements below
+  std::string value;
+  PathState state;
+  int depth;              // of the element whose text is read
+};
+
+// A key set mapped to paths.
+struct PathSet {
+  size_t set;
+  bool anchored;
+  std::vector<string_view> scope;  // the path of the record element
+  std::vector<int> fail;
+  std::vector<PathKey> keys;
+  int depth;                       // of the record element, -1 outside
+  size_t column;                   // of its match states in a frame
+};
+
+// The failure function of a path, as in Knuth-Morris-Pratt: fail[i] is
+// the length of the longest proper prefix of x[0, i] that ends it.
+void make_fail(const string_view* x, size_t n, std::vector<int>* fail) {
+  fail->assign(n, 0);
+  int k = 0;
+  for (size_t i = 1; i < n; ++i) {
+    while (k > 0 && x[i] != x[k])
+      k = (*fail)[k - 1];
+    if (x[i] == x[k])
+      ++k;
+    (*fail)[i] = k;
+  }
+}
+
+// The match state of a path in an element, from the state `j' in its
+// parent, which is `depth' elements below where the path starts: how
+// many elements of the path end at the element, -1 for none if it's
+// anchored, as then they have to start where the path does.
+int advance(const string_view* x, size_t n, const int* fail, int j,
+            string_view name, bool anchored, int depth) {
+  if (n == 0)
+    return -1;
+  if (anchored) {
+    if (j != depth || static_cast<size_t>(j) == n || x[j] != name)
+      return -1;
+    return j + 1;
+  }
+  if (static_cast<size_t>(j) == n)
+    j = fail[n - 1];
+  while (j > 0 && x[j] != name)
+    j = fail[j - 1];
+  if (x[j] == name)
+    ++j;
+  return j;
+}
+
+bool path_name(string_view name) {
+  return !name.empty() && name.find_first_of("@()[]*= \t\r\n") ==
+      string_view::npos;
+}
+
+void trim(std::string* s) {
+  static const char kSpaces[] = " \t\r\n";
+  size_t end = s->find_last_not_of(kSpaces);
+  if (end == std::string::npos) {
+    s->clear();
+    return;
+  }
+  s->erase(end + 1);
+  s->erase(0, s->find_first_not_of(kSpaces));
+}
+
+// The state of the element handlers, it's kept by the thread so that the
+// buffers are reused, nothing is allocated unless a record is made.
+struct XmlCapture {
+  const std::vector<Rule::Key>* const* key_sets;
+  RecordSet* const* outs;
+  size_t sets;
+  std::vector<XmlSlot> slots;     // [0, used) are in use
+  size_t used;
+  std::vector<size_t> slot_sets;  // the key sets mapped to attributes
+  std::vector<size_t> key_slots;  // the slot of every key, set by set
+  bool captured;                  // whether any slot is seen
+
+  std::vector<PathSet> path_sets;
+  std::vector<int> frames;        // the match states of every path set
+                                  // and key, a frame per open element
+  size_t width;                   // of a frame
+  int depth;
+  bool texts;                     // whether any key reads a text
+
+  XmlCapture(): key_sets(NULL), outs(NULL), sets(0), used(0),
+                captured(false), width(0), depth(0), texts(false) {}
+
+  void Reset(const std::vector<Rule::Key>* const* k, RecordSet* const* o,
+             size_t n) {
+    key_sets = k;
+    outs = o;
+    sets = n;
+    used = 0;
+    captured = false;
+    slot_sets.clear();
+    key_slots.clear();
+    path_sets.clear();
+    width = 0;
+    depth = 0;
+    texts = false;
+    for (size_t i = 0; i < sets; ++i) {
+      const auto& keys = *key_sets[i];
+      if (!keys.empty() && IsXmlPath(keys[0].mapped)) {
+        AddPathSet(i);
+        continue;
+      }
+      slot_sets.push_back(i);
+      for (size_t j = 0; j < keys.size(); ++j)
+        key_slots.push_back(FindSlot(keys[j].mapped));
+    }
+    frames.assign(width, 0);
+  }
+
+  void AddPathSet(size_t set) {
+    const auto& keys = *key_sets[set];
+    PathSet ps;
+    ps.set = set;
+    ps.keys.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      PathKey& pk = ps.keys[i];
+      pk.key = &keys[i];
+      pk.state = kNone;
+      pk.depth = 0;
+      // The rules are checked when they're loaded.
+      if (!ParseXmlPath(keys[i].mapped, &pk.path))
+        return;
+      if (pk.path.attr.empty())
+        texts = true;
+    }
+
+    // The record element is where the paths part.
+    const auto& head = ps.keys[0].path;
+    ps.anchored = head.anchored;
+    size_t n = head.elements.size();
+    for (size_t i = 1; i < ps.keys.size(); ++i) {
+      const auto& elements = ps.keys[i].path.elements;
+      size_t j = 0;
+      while (j < n && j < elements.size() && elements[j] == head.elements[j])
+        ++j;
+      n = j;
+    }
+    ps.scope.assign(head.elements.begin(), head.elements.begin() + n);
+    make_fail(ps.scope.data(), ps.scope.size(), &ps.fail);
+    for (size_t i = 0; i < ps.keys.size(); ++i) {
+      PathKey& pk = ps.keys[i];
+      pk.first = n;
+      make_fail(pk.path.elements.data() + n, pk.path.elements.size() - n,
+                &pk.fail);
+    }
+    ps.depth = ps.scope.empty() ? 0 : -1;
+    ps.column = width;
+    width += 1 + ps.keys.size();
+    path_sets.push_back(ps);
+  }
+
+  size_t FindSlot(const std::string& name) {
+    for (size_t i = 0; i < used; ++i) {
+      if (*slots[i].name == name)
+        return i;
+    }
+    if (used == slots.size())
+      slots.push_back(XmlSlot());
+    slots[used].name = &name;
+    slots[used].seen = false;
+    return used++;
+  }
+};
+
+// Follows the paths into an element.
+void path_begin(XmlCapture* cap, const char* elem, const char** array) {
+  int d = ++cap->depth;
+  size_t w = cap->width;
+  cap->frames.resize((d + 1) * w);
+  const int* parent = &cap->frames[(d - 1) * w];
+  int* frame = &cap->frames[d * w];
+  string_view name(elem);
+
+  for (size_t i = 0; i < cap->path_sets.size(); ++i) {
+    PathSet& ps = cap->path_sets[i];
+    size_t c = ps.column;
+    size_t n = ps.scope.size();
+    frame[c] = n == 0 ? 0 : advance(ps.scope.data(), n, ps.fail.data(),
+                                    parent[c], name, ps.anchored, d - 1);
+    bool entering = ps.depth < 0 && frame[c] == static_cast<int>(n);
+    if (entering)
+      ps.depth = d;
+    if (ps.depth < 0)
+      continue;
+
+    for (size_t j = 0; j < ps.keys.size(); ++j) {
+      PathKey& pk = ps.keys[j];
+      size_t rn = pk.path.elements.size() - pk.first;
+      int& st = frame[c + 1 + j];
+      st = entering ? 0 : advance(pk.path.elements.data() + pk.first, rn,
+                                  pk.fail.data(), parent[c + 1 + j], name,
+                                  ps.anchored, d - 1 - ps.depth);
+      if (st != static_cast<int>(rn) || pk.state != kNone)
+        continue;
+      if (pk.path.attr.empty()) {
+        pk.state = kText;
+        pk.depth = d;
+        pk.value.clear();
+        continue;
+      }
+      for (int k = 0; array[k]; k += 2) {
+        if (pk.path.attr == array[k] && array[k + 1]) {
+          pk.value.assign(array[k + 1]);
+          pk.state = kDone;
+          break;
+        }
+      }
+    }
+  }
+}
+
+// Makes the record of a key set mapped to paths, which needs every key,
+// and starts over.
+void make_path_record(XmlCapture* cap, PathSet* ps) {
+  bool complete = true;
+  for (size_t i = 0; i < ps->keys.size(); ++i) {
+    const PathKey& pk = ps->keys[i];
+    if (pk.state != kDone || pk.value.empty())
+      complete = false;
+  }
+
+  if (complete) {
+    Record records;
+    for (size_t i = 0; i < ps->keys.size(); ++i) {
+      PathKey& pk = ps->keys[i];
+      const auto& key = *pk.key;
+      if (!key.filter || key.filter(&pk.value))
+        records[key.key] = pk.value;
+    }
+    if (records.size() == ps->keys.size())
+      cap->outs[ps->set]->push_back(records);
+  }
+
+  for (size_t i = 0; i < ps->keys.size(); ++i)
+    ps->keys[i].state = kNone;
+}
+
+// Follows the paths out of an element.
+void path_end(XmlCapture* cap) {
+  int d = cap->depth--;
+  for (size_t i = 0; i < cap->path_sets.size(); ++i) {
+    PathSet& ps = cap->path_sets[i];
+    if (ps.depth < 0)
+      continue;
+    for (size_t j = 0; j < ps.keys.size(); ++j) {
+      PathKey& pk = ps.keys[j];
+      if (pk.state == kText && pk.depth == d) {
+        trim(&pk.value);
+        pk.state = kDone;
+      }
+    }
+    if (ps.depth == d) {
+      make_path_record(cap, &ps);
+      ps.depth = -1;
+    }
+  }
+}
+
+void text_data(void* data, const char* s, int len) {
+  XmlCapture* cap = reinterpret_cast<XmlCapture*>(data);
+  for (size_t i = 0; i < cap->path_sets.size(); ++i) {
+    PathSet& ps = cap->path_sets[i];
+    if (ps.depth < 0)
+      continue;
+    for (size_t j = 0; j < ps.keys.size(); ++j) {
+      PathKey& pk = ps.keys[j];
+      if (pk.state == kText && pk.depth == cap->depth)
+        pk.value.append(s, len);
+    }
+  }
+}
+
+void elem_begin(void* data, const char* elem, const char** array) {
+  XmlCapture* cap = reinterpret_cast<XmlCapture*>(data);
+  if (!cap->path_sets.empty())
+    path_begin(cap, elem, array);
+
+  // The first value of a name is kept until the element end.
+  for (int i = 0; array[i]; i += 2) {
+    const char* key = array[i];
+    const char* value = array[i + 1];
+    if (!key || !value)
+      continue;
+    for (size_t j = 0; j < cap->used; ++j) {
+      XmlSlot& slot = cap->slots[j];
+      if (slot.name->compare(key) != 0)
+        continue;
+      if (!slot.seen) {
+        slot.value.assign(value);
+        slot.seen = true;
+        cap->captured = true;
+      }
+      break;
+    }
+  }
+}
+
+// Makes the record of the key set from the slots, which needs every key.
+void make_record(XmlCapture* cap, size_t set, size_t first) {
+  const auto& keys = *cap->key_sets[set];
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const XmlSlot& slot = cap->slots[cap->key_slots[first + i]];
+    if (!slot.seen || slot.value.empty())
+      return;
+  }
+
+  // The filters may change the values, a key set sees the changes of
+  // its own keys only.
+  bool shared = cap->sets > 1;
+  if (shared) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      XmlSlot& slot = cap->slots[cap->key_slots[first + i]];
+      slot.scratch.assign(slot.value);
+    }
+  }
+
+  Record records;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    XmlSlot& slot = cap->slots[cap->key_slots[first + i]];
+    std::string* value = shared ? &slot.scratch : &slot.value;
+    const auto& key = keys[i];
+    if (!key.filter || key.filter(value))
+      records[key.key] = *value;
+  }
+
+  if (records.size() == keys.size())
+    cap->outs[set]->push_back(records);
+}
+
+void elem_end(void* data, const char*) {
+  XmlCapture* cap = reinterpret_cast<XmlCapture*>(data);
+  if (!cap->path_sets.empty())
+    path_end(cap);
+  if (!cap->captured)
+    return;
+
+  size_t first = 0;
+  for (size_t i = 0; i < cap->slot_sets.size(); ++i) {
+    size_t set = cap->slot_sets[i];
+    make_record(cap, set, first);
+    first += cap->key_sets[set]->size();
+  }
+  for (size_t i = 0; i < cap->used; ++i)
+    cap->slots[i].seen = false;
+  cap->captured = false;
+}
+
+// Parses the document for the key sets, set i pushes its records to
+// outs[i].
+void parse_document(string_view doc,
+                    const std::vector<Rule::Key>* const* key_sets,
+                    RecordSet* const* outs, size_t sets) {
+  static thread_local XmlCapture cap;
+  cap.Reset(key_sets, outs, sets);
+
+  XML_Parser parser = acquire_parser();
+  XML_SetElementHandler(parser, elem_begin, elem_end);
+  XML_SetCharacterDataHandler(parser, cap.texts ? text_data : NULL);
+  XML_SetUserData(parser, &cap);
+  XML_Status ret = XML_Parse(parser, doc.data(), doc.size(), XML_TRUE);
+  if (ret != XML_STATUS_OK) {
+    // broken xml, what's been read is kept
+  }
+
+  // The records of the whole document.
+  for (size_t i = 0; i < cap.path_sets.size(); ++i) {
+    PathSet& ps = cap.path_sets[i];
+    if (ps.scope.empty())
+      make_path_record(&cap, &ps);
+  }
+}
+
+} // anonymous namespace
+
+bool ParseXmlPath(const std::string& mapped, XmlPath* path) {
+  string_view s(mapped);
+  path->anchored = !s.empty() && s[0] == '/';
+  if (path->anchored)
+    s.remove_prefix(1);
+  path->elements.clear();
+  size_t pos;
+  while ((pos = s.find('/')) != string_view::npos) {
+    string_view elem = s.substr(0, pos);
+    if (!path_name(elem))
+      return false;
+    path->elements.push_back(elem);
+    s.remove_prefix(pos + 1);
+  }
+  if (path->elements.empty())
+    return false;
+
+  if (s == "text()") {
+    path->attr = string_view();
+    return true;
+  }
+  if (s.empty() || s[0] != '@' || !path_name(s.substr(1)))
+    return false;
+  path->attr = s.substr(1);
+  return true;
+}
+
+XmlDocument::XmlDocument(string_view doc, const KeySets& key_sets)
+  : key_sets_(key_sets), records_(key_sets.size()) {
+  std::vector<RecordSet*> outs(records_.size());
+  for (size_t i = 0; i < records_.size(); ++i)
+    outs[i] = &records_[i];
+  parse_document(doc, key_sets_.data(), outs.data(), key_sets_.size());
+}
+
+bool XmlDocument::FindKeySet(const std::vector<Rule::Key>& keys,
+                             size_t* set) const {
+  auto iter = std::find(key_sets_.begin(), key_sets_.end(), &keys);
+  *set = iter - key_sets_.begin();
+  return iter != key_sets_.end();
+}
+
+void XmlDocument::Extract(size_t set, RecordSet* res) const {
+  assert(set < records_.size());
+  res->insert(res->end(), records_[set].begin(), records_[set].end());
+}
+
+void ScanXml(string_view doc, const std::vector<Rule::Key>& keys,
+             RecordSet* res) {
+  const std::vector<Rule::Key>* key_sets = &keys;
+  parse_document(doc, &key_sets, &res, 1);
+}
+
+} // namespace ext
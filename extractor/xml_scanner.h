@@ -0,0 +1,74 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#ifndef EXTRACTOR_XML_SCANNER_H_
+#define EXTRACTOR_XML_SCANNER_H_
+
+#include <string>
+#include <vector>
+
+#include "extractor/rule.h"
+#include "extractor/parser.h"
+#include "extractor/trivial.h"
+#include "extractor/third_party/string_view.h"
+
+namespace ext {
+// An XML key mapped to an element path rather than an attribute name:
+// `a/b/@attr' is an attribute of the element b in a, `a/b/text()' the
+// text directly inside b. A path is matched against the innermost
+// elements, or from the root element if it starts with '/'.
+struct XmlPath {
+  bool anchored;
+  std::vector<string_view> elements;
+  string_view attr;  // empty for text()
+};
+
+// Whether an XML key is mapped to a path.
+inline bool IsXmlPath(const std::string& mapped) {
+  return mapped.find('/') != std::string::npos;
+}
+
+// Parses the path of an XML key, which points into `mapped'. Returns
+// false if it's malformed.
+bool ParseXmlPath(const std::string& mapped, XmlPath* path);
+
+// The records of several key sets in an XML document, which is parsed
+// once for all of them.
+//
+// The attributes of the elements are gathered until an element ends, the
+// first one of a name is kept. A key set yields a record there if each
+// of its keys names a gathered attribute, which isn't empty and passes
+// the key's filter, then the gathered attributes are dropped.
+//
+// A key set mapped to paths yields a record at the end of each element
+// of the paths' common leading elements, its record element (the root
+// document if they have none in common). The keys are the first values
+// of their paths inside it, matched below it the way the record element
+// is matched in the document, texts are trimmed of whitespaces. The
+// paths are followed in the same pass, elements off them cost a few
+// comparisons and nothing is allocated for them.
+class XmlDocument {
+public:
+  typedef std::vector<const std::vector<Rule::Key>*> KeySets;
+
+  // The key sets must outlive the document, `doc' needn't.
+  XmlDocument(string_view doc, const KeySets& key_sets);
+
+  // Finds out which of the key sets `keys' is.
+  bool FindKeySet(const std::vector<Rule::Key>& keys, size_t* set) const;
+
+  // Adds the records of the key set to `res'.
+  void Extract(size_t set, RecordSet* res) const;
+
+private:
+  KeySets key_sets_;
+  std::vector<RecordSet> records_;
+  DISALLOW_COPY_AND_ASSIGN(XmlDocument);
+};
+
+// Extracts the records of the keys from an XML document, see XmlDocument.
+void ScanXml(string_view doc, const std::vector<Rule::Key>& keys,
+             RecordSet* res);
+
+} // namespace ext
+
+#endif // EXTRACTOR_XML_SCANNER_H_
@@ -0,0 +1,465 @@
+// Author: yuyue/X3130 (yuyue2200@hotmail.com)
+
+#include <expat.h>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "extractor/xml_scanner.h"
+#include "extractor/filter.h"
+#include "extractor/scanner_test.h"
+
+using namespace ext;
+
+size_t g_allocations = 0;
+
+void* operator new(size_t n) {
+  ++g_allocations;
+  void* p = malloc(n ? n : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+// The element handlers ScanXml has to agree with, every attribute is
+// gathered into a map.
+struct XmlOpaque {
+  const std::vector<Rule::Key>* keys;
+  RecordSet* records;
+  Record tmp;
+};
+
+void ElemBegin(void* data, const char*, const char** array) {
+  XmlOpaque* op = reinterpret_cast<XmlOpaque*>(data);
+  for (int i = 0; array[i]; i += 2)
+    op->tmp.insert({array[i], array[i + 1]});
+}
+
+void ElemEnd(void* data, const char*) {
+  XmlOpaque* op = reinterpret_cast<XmlOpaque*>(data);
+  const auto& keys = *op->keys;
+  Record& tmp = op->tmp;
+  Record records;
+  if (tmp.empty())
+    return;
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto iter = tmp.find(keys[i].mapped);
+    if (iter != tmp.end()) {
+      if (iter->second.empty()) {
+        records.clear();
+        break;
+      }
+      auto& value = iter->second;
+      const auto& key = keys[i];
+      if (!key.filter || key.filter(&value))
+        records[key.key] = iter->second;
+    }
+  }
+
+  if (records.size() == keys.size())
+    op->records->push_back(records);
+  tmp.clear();
+}
+
+RecordSet MapRecords(const std::string& doc,
+                     const std::vector<Rule::Key>& keys) {
+  RecordSet res;
+  XML_Parser parser = XML_ParserCreate("utf-8");
+  XML_SetElementHandler(parser, ElemBegin, ElemEnd);
+  XmlOpaque opaque;
+  opaque.keys = &keys;
+  opaque.records = &res;
+  XML_SetUserData(parser, &opaque);
+  XML_Parse(parser, doc.data(), doc.size(), XML_TRUE);
+  XML_ParserFree(parser);
+  return res;
+}
+
+const char* const kRandomNames[] = {
+  "phone", "nick", "a", "b",
+};
+
+const char* const kRandomValues[] = {
+  "13812345678", "+8613812345678", "x", "", "&amp;y",
+};
+
+void RandomElement(std::string* doc, int depth) {
+  *doc += "<e";
+  int attrs = rand() % 4;
+  for (int i = 0; i < attrs; ++i) {
+    *doc += ' ';
+    *doc += kRandomNames[rand() % 4];
+    // a name twice is broken xml
+    *doc += std::to_string(i);
+    *doc += "=\"";
+    *doc += kRandomValues[rand() % 5];
+    *doc += '"';
+  }
+  if (depth > 3 || rand() % 3 == 0) {
+    *doc += "/>";
+    return;
+  }
+  *doc += '>';
+  int children = rand() % 4;
+  for (int i = 0; i < children; ++i)
+    RandomElement(doc, depth + 1);
+  *doc += "</e>";
+}
+
+void TestCaseScanXml() {
+  static const char* const names[][6] = {
+    {"PHONENUM", "phone0", "NICKNAME", "nick1", NULL, NULL},
+    {"NICKNAME", "nick0", NULL, NULL, NULL, NULL},
+    {"APP_NAME", "a0", "PHONENUM", "phone0", "NICKNAME", "phone0"},
+  };
+  std::vector<std::vector<Rule::Key> > keys;
+  XmlDocument::KeySets key_sets;
+  for (size_t i = 0; i < 3; ++i)
+    keys.push_back(MakeKeys(names[i], 6));
+  for (size_t i = 0; i < keys.size(); ++i)
+    key_sets.push_back(&keys[i]);
+
+  RecordSet res;
+  ScanXml("<r><u phone0=\"13812345678\" nick1=\"a\"/><u phone0=\"1\"/>"
+          "<u nick1=\"c\"><v phone0=\"13712345678\"/></u></r>",
+          keys[0], &res);
+  assert(res.size() == 2);
+  assert(res[0]["PHONENUM"] == "13812345678" && res[0]["NICKNAME"] == "a");
+  assert(res[1]["PHONENUM"] == "13712345678" && res[1]["NICKNAME"] == "c");
+
+  srand(1);
+  for (int i = 0; i < 20000; ++i) {
+    std::string doc;
+    RandomElement(&doc, 0);
+    if (rand() % 4 == 0)
+      doc.resize(rand() % (doc.size() + 1));
+
+    XmlDocument document(doc, key_sets);
+    for (size_t j = 0; j < keys.size(); ++j) {
+      RecordSet expect = MapRecords(doc, keys[j]);
+      res.clear();
+      ScanXml(doc, keys[j], &res);
+      assert(res == expect);
+
+      size_t set;
+      assert(document.FindKeySet(keys[j], &set) && set == j);
+      res.clear();
+      document.Extract(j, &res);
+      assert(res == expect);
+    }
+  }
+}
+
+// Elements without records cost no allocation once the buffers of the
+// thread are grown.
+void TestCaseScanXmlAllocation() {
+  static const char* const names[] = {
+    "PHONENUM", "phone", "NICKNAME", "nick",
+  };
+  auto keys = MakeKeys(names, 4);
+  std::string doc = "<r>";
+  for (int i = 0; i < 100; ++i)
+    doc += "<u phone=\"13812345678\" x=\"1\"><v y=\"2\" nick=\"\"/></u>";
+  doc += "</r>";
+
+  RecordSet res;
+  ScanXml(doc, keys, &res);
+  size_t allocations = g_allocations;
+  ScanXml(doc, keys, &res);
+  assert(res.empty());
+  assert(g_allocations == allocations);
+}
+
+// The tree the paths are looked up in.
+struct XmlNode {
+  std::string name;
+  std::vector<std::pair<std::string, std::string> > attrs;
+  std::string text;
+  std::vector<XmlNode> children;
+};
+
+struct XmlTree {
+  XmlNode doc;
+  std::vector<XmlNode*> open;
+};
+
+void TreeBegin(void* data, const char* name, const char** array) {
+  XmlTree* tree = reinterpret_cast<XmlTree*>(data);
+  XmlNode* parent = tree->open.back();
+  parent->children.push_back(XmlNode());
+  XmlNode* node = &parent->children.back();
+  node->name = name;
+  for (int i = 0; array[i]; i += 2)
+    node->attrs.push_back({array[i], array[i + 1]});
+  tree->open.push_back(node);
+}
+
+void TreeEnd(void* data, const char*) {
+  reinterpret_cast<XmlTree*>(data)->open.pop_back();
+}
+
+void TreeText(void* data, const char* s, int len) {
+  reinterpret_cast<XmlTree*>(data)->open.back()->text.append(s, len);
+}
+
+// Whether the elements end with, or are if anchored, the path's.
+bool PathMatch(const std::vector<std::string>& names,
+               const std::vector<string_view>& path, size_t first,
+               bool anchored) {
+  size_t n = path.size() - first;
+  if (anchored ? names.size() != n : names.size() < n)
+    return false;
+  for (size_t i = 0; i < n; ++i) {
+    if (path[first + i] != names[names.size() - n + i])
+      return false;
+  }
+  return true;
+}
+
+struct PathRef {
+  const std::vector<Rule::Key>* keys;
+  std::vector<XmlPath> paths;
+  size_t first;  // the number of elements of the record element's path
+  RecordSet* res;
+};
+
+// Finds the first value of a key below the record element, in document
+// order. `names' are the elements below it down to the node.
+bool FindPathValue(const PathRef& ref, const XmlPath& path,
+                   const XmlNode& node, bool top,
+                   std::vector<std::string>* names, std::string* value) {
+  bool match = path.elements.size() == ref.first
+      ? top : !top && PathMatch(*names, path.elements, ref.first,
+                                path.anchored);
+  if (match) {
+    if (path.attr.empty()) {
+      *value = node.text;
+      size_t end = value->find_last_not_of(" \t\r\n");
+      value->erase(end == std::string::npos ? 0 : end + 1);
+      value->erase(0, value->find_first_not_of(" \t\r\n"));
+      return true;
+    }
+    for (size_t i = 0; i < node.attrs.size(); ++i) {
+      if (path.attr == node.attrs[i].first) {
+        *value = node.attrs[i].second;
+        return true;
+      }
+    }
+  }
+  for (size_t i = 0; i < node.children.size(); ++i) {
+    names->push_back(node.children[i].name);
+    bool found = FindPathValue(ref, path, node.children[i], false, names,
+                               value);
+    names->pop_back();
+    if (found)
+      return true;
+  }
+  return false;
+}
+
+void MakePathRecord(const PathRef& ref, const XmlNode& node) {
+  Record records;
+  for (size_t i = 0; i < ref.paths.size(); ++i) {
+    std::vector<std::string> names;
+    std::string value;
+    if (!FindPathValue(ref, ref.paths[i], node, true, &names, &value) ||
+        value.empty())
+      return;
+    const auto& key = (*ref.keys)[i];
+    if (!key.filter || key.filter(&value))
+      records[key.key] = value;
+  }
+  if (records.size() == ref.paths.size())
+    ref.res->push_back(records);
+}
+
+void FindRecordElements(const PathRef& ref, const XmlNode& node,
+                        std::vector<std::string>* names) {
+  for (size_t i = 0; i < node.children.size(); ++i) {
+    const XmlNode& child = node.children[i];
+    names->push_back(child.name);
+    std::vector<string_view> scope(ref.paths[0].elements.begin(),
+                                   ref.paths[0].elements.begin() + ref.first);
+    if (PathMatch(*names, scope, 0, ref.paths[0].anchored))
+      MakePathRecord(ref, child);
+    else
+      FindRecordElements(ref, child, names);
+    names->pop_back();
+  }
+}
+
+// The records of the paths from the tree of a well-formed document.
+RecordSet TreeRecords(const std::string& doc,
+                      const std::vector<Rule::Key>& keys) {
+  XmlTree tree;
+  tree.open.push_back(&tree.doc);
+  XML_Parser parser = XML_ParserCreate("utf-8");
+  XML_SetElementHandler(parser, TreeBegin, TreeEnd);
+  XML_SetCharacterDataHandler(parser, TreeText);
+  XML_SetUserData(parser, &tree);
+  assert(XML_Parse(parser, doc.data(), doc.size(), XML_TRUE) ==
+         XML_STATUS_OK);
+  XML_ParserFree(parser);
+
+  RecordSet res;
+  PathRef ref;
+  ref.keys = &keys;
+  ref.res = &res;
+  ref.paths.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i)
+    assert(ParseXmlPath(keys[i].mapped, &ref.paths[i]));
+  ref.first = ref.paths[0].elements.size();
+  for (size_t i = 1; i < keys.size(); ++i) {
+    size_t j = 0;
+    while (j < ref.first && j < ref.paths[i].elements.size() &&
+           ref.paths[i].elements[j] == ref.paths[0].elements[j])
+      ++j;
+    ref.first = j;
+  }
+
+  std::vector<std::string> names;
+  if (ref.first == 0)
+    MakePathRecord(ref, tree.doc);
+  else
+    FindRecordElements(ref, tree.doc, &names);
+  return res;
+}
+
+void TestCaseScanXmlPath() {
+  static const char* const names[] = {
+    "PHONENUM", "Body/user/@phone", "NICKNAME", "Body/user/name/text()",
+  };
+  auto keys = MakeKeys(names, 4);
+  RecordSet res;
+  ScanXml("<?xml version=\"1.0\"?>"
+          "<Envelope><Header><user phone=\"13912345678\"/></Header><Body>"
+          "<user phone=\"13812345678\"><name> a <b>x</b>b </name></user>"
+          "<user phone=\"13712345678\"><x><name>c</name></x></user>"
+          "<user><name>d</name></user>"
+          "<user phone=\"13612345678\"><name>e</name><name>f</name></user>"
+          "</Body></Envelope>", keys, &res);
+  assert(res.size() == 3);
+  assert(res[0]["PHONENUM"] == "13812345678" && res[0]["NICKNAME"] == "a b");
+  assert(res[1]["PHONENUM"] == "13712345678" && res[1]["NICKNAME"] == "c");
+  assert(res[2]["PHONENUM"] == "13612345678" && res[2]["NICKNAME"] == "e");
+
+  // Anchored paths, and the record of the whole document.
+  static const char* const anchored[] = {
+    "PHONENUM", "/r/u/@phone", "NICKNAME", "/r/n/text()",
+  };
+  keys = MakeKeys(anchored, 4);
+  res.clear();
+  ScanXml("<r><u><u phone=\"13912345678\"/></u><u phone=\"13812345678\"/>"
+          "<x><n>b</n></x><n>a</n></r>", keys, &res);
+  assert(res.size() == 1);
+  assert(res[0]["PHONENUM"] == "13812345678" && res[0]["NICKNAME"] == "a");
+  // the record element has to end
+  res.clear();
+  ScanXml("<r><u phone=\"13812345678\"/><n>a</n><n", keys, &res);
+  assert(res.empty());
+}
+
+const char* const kPathNames[] = {"a", "b", "u"};
+
+void RandomPathElement(std::string* doc, int depth) {
+  std::string name = kPathNames[rand() % 3];
+  *doc += '<' + name;
+  if (rand() % 2) {
+    *doc += " phone=\"";
+    *doc += kRandomValues[rand() % 5];
+    *doc += '"';
+  }
+  if (depth > 4 || rand() % 4 == 0) {
+    *doc += "/>";
+    return;
+  }
+  *doc += '>';
+  int children = rand() % 4;
+  for (int i = 0; i <= children; ++i) {
+    if (rand() % 2)
+      *doc += rand() % 4 ? kRandomValues[rand() % 5] : "\n ";
+    if (i < children)
+      RandomPathElement(doc, depth + 1);
+  }
+  *doc += "</" + name + '>';
+}
+
+void TestCaseScanXmlPathRandom() {
+  static const char* const names[][4] = {
+    {"PHONENUM", "u/@phone", "NICKNAME", "u/b/text()"},
+    {"PHONENUM", "/a/b/@phone", NULL, NULL},
+    {"NICKNAME", "a/text()", "PHONENUM", "b/@phone"},
+    {"PHONENUM", "a/b/a/@phone", "NICKNAME", "a/b/a/b/text()"},
+    {"NICKNAME", "/a/u/text()", "PHONENUM", "/a/b/@phone"},
+    {"NICKNAME", "a/a/text()", "PHONENUM", "a/a/b/@phone"},
+    {"PHONENUM", "phone", NULL, NULL},
+  };
+  const size_t n = sizeof(names) / sizeof(names[0]);
+  std::vector<std::vector<Rule::Key> > keys;
+  XmlDocument::KeySets key_sets;
+  for (size_t i = 0; i < n; ++i)
+    keys.push_back(MakeKeys(names[i], 4));
+  for (size_t i = 0; i < n; ++i)
+    key_sets.push_back(&keys[i]);
+
+  srand(2);
+  for (int i = 0; i < 20000; ++i) {
+    std::string doc;
+    RandomPathElement(&doc, 0);
+    XmlDocument document(doc, key_sets);
+    for (size_t j = 0; j < n; ++j) {
+      RecordSet expect = j + 1 == n ? MapRecords(doc, keys[j])
+                                    : TreeRecords(doc, keys[j]);
+      RecordSet res;
+      ScanXml(doc, keys[j], &res);
+      assert(res == expect);
+      res.clear();
+      document.Extract(j, &res);
+      assert(res == expect);
+    }
+
+    // broken documents don't trip the paths up
+    doc.resize(rand() % (doc.size() + 1));
+    XmlDocument broken(doc, key_sets);
+  }
+}
+
+// Elements off the paths cost no allocation either.
+void TestCaseScanXmlPathAllocation() {
+  static const char* const names[] = {
+    "PHONENUM", "u/@phone", "NICKNAME", "u/v/text()",
+  };
+  auto keys = MakeKeys(names, 4);
+  std::string small = "<r><x/></r>";
+  std::string doc = "<r>";
+  for (int i = 0; i < 100; ++i)
+    doc += "<u phone=\"13812345678\"><w>x</w><v/></u><x><v>y</v></x>";
+  doc += "</r>";
+
+  RecordSet res;
+  ScanXml(doc, keys, &res);
+  size_t allocations = g_allocations;
+  ScanXml(small, keys, &res);
+  size_t per_document = g_allocations - allocations;
+  allocations = g_allocations;
+  ScanXml(doc, keys, &res);
+  assert(res.empty());
+  assert(g_allocations - allocations == per_document);
+}
+
+int main() {
+  TestCaseScanXml();
+  TestCaseScanXmlAllocation();
+  TestCaseScanXmlPath();
+  TestCaseScanXmlPathRandom();
+  TestCaseScanXmlPathAllocation();
+  return 0;
+}